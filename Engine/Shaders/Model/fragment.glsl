@@ -3,6 +3,14 @@
 
 #define NR_POINT_LIGHTS 4
 
+//must match LightClusters.h
+#define NR_LIGHT_CLUSTER_X 16
+#define NR_LIGHT_CLUSTER_Y 9
+#define NR_LIGHT_CLUSTER_Z 24
+#define LIGHT_CLUSTER_NEAR 0.5
+#define LIGHT_CLUSTER_FAR 500.0
+#define NR_LIGHT_CLUSTERS (NR_LIGHT_CLUSTER_X * NR_LIGHT_CLUSTER_Y * NR_LIGHT_CLUSTER_Z)
+
 layout (location = 0) out vec4 diffuseAndSpecularLightedColor;
 layout (location = 1) out vec3 ambientColor;
 layout (location = 2) out vec3 normalOutput;
@@ -60,6 +68,11 @@ uniform sampler2D specularSampler;
 uniform sampler2D opacitySampler;
 uniform sampler2D normalSampler;
 
+//point lights without shadows, 4 texels per light: position and range, color, attenuation, ambient
+uniform samplerBuffer clusteredLights;
+//offset and count per cluster, then light indexes of all clusters
+uniform usamplerBuffer lightClusters;
+
 vec3 pointSampleOffsetDirections[20] = vec3[]
 (
    vec3( 1,  1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1,  1,  1),
@@ -139,6 +152,68 @@ float ShadowCalculationPoint(vec3 fragPos, float bias, float viewDistance, int l
     return shadow;
 }
 
+int getLightCluster(vec3 fragPos) {
+    vec4 clipPosition = playerTransforms.cameraProjection * vec4(fragPos, 1.0);
+    ivec2 tile = ivec2((clipPosition.xy / clipPosition.w * 0.5 + 0.5) * vec2(NR_LIGHT_CLUSTER_X, NR_LIGHT_CLUSTER_Y));
+    tile = clamp(tile, ivec2(0), ivec2(NR_LIGHT_CLUSTER_X - 1, NR_LIGHT_CLUSTER_Y - 1));
+    //w is the view depth
+    int slice = 0;
+    if(clipPosition.w > LIGHT_CLUSTER_NEAR) {
+        slice = int(log(clipPosition.w / LIGHT_CLUSTER_NEAR) * NR_LIGHT_CLUSTER_Z / log(LIGHT_CLUSTER_FAR / LIGHT_CLUSTER_NEAR));
+        slice = min(slice, NR_LIGHT_CLUSTER_Z - 1);
+    }
+    return (slice * NR_LIGHT_CLUSTER_Y + tile.y) * NR_LIGHT_CLUSTER_X + tile.x;
+}
+
+/**
+ * Distance attenuation of point lights, 0 beyond range. Ambient of shadowed and clustered point lights both use it, so
+ * a light doesn't change brightness when it moves between them.
+ */
+float getPointLightAttenuation(vec3 attenuationFactors, float fragDistance, float range) {
+    if(fragDistance > range) {
+        return 0.0;
+    }
+    float attenuation = 1.0 / (attenuationFactors.x +
+                              (attenuationFactors.y * fragDistance) +
+                              (attenuationFactors.z * fragDistance * fragDistance));
+    return clamp(attenuation, 0.0, 1.0);
+}
+
+/**
+ * Adds diffuse, specular and ambient of the point lights in the cluster of the fragment, attenuated by distance.
+ */
+void addClusteredLights(vec3 normal, inout vec3 lightingColorFactor, inout vec3 ambientColor) {
+    int cluster = getLightCluster(from_vs.fragPos);
+    int lightOffset = int(texelFetch(lightClusters, cluster * 2).r);
+    int lightCount = int(texelFetch(lightClusters, cluster * 2 + 1).r);
+    vec3 viewDirectory = normalize(playerTransforms.position - from_vs.fragPos);
+    for(int i = 0; i < lightCount; ++i) {
+        int lightIndex = int(texelFetch(lightClusters, NR_LIGHT_CLUSTERS * 2 + lightOffset + i).r);
+        vec4 positionAndRange = texelFetch(clusteredLights, lightIndex * 4);
+        vec3 fragToLight = positionAndRange.xyz - from_vs.fragPos;
+        float fragDistance = length(fragToLight);
+        if(fragDistance > positionAndRange.w) {
+            continue;
+        }
+        float attenuation = getPointLightAttenuation(texelFetch(clusteredLights, lightIndex * 4 + 2).xyz, fragDistance,
+                                                     positionAndRange.w);
+
+        vec3 lightDirectory = fragToLight / fragDistance;
+        float diffuseRate = max(dot(normal, lightDirectory), 0.0);
+        vec3 reflectDirectory = reflect(-lightDirectory, normal);
+        float specularRate = max(dot(viewDirectory, reflectDirectory), 0.0);
+        if(specularRate != 0 && material.shininess != 0) {
+            specularRate = pow(specularRate, material.shininess);
+        } else {
+            specularRate = 0;
+        }
+        //ambient is attenuated too, otherwise many lights would brighten everything
+        vec3 ambient = attenuation * texelFetch(clusteredLights, lightIndex * 4 + 3).xyz;
+        lightingColorFactor += (attenuation * (diffuseRate + specularRate) * texelFetch(clusteredLights, lightIndex * 4 + 1).xyz) + ambient;
+        ambientColor += ambient;
+    }
+}
+
 vec3 calcViewSpacePos(vec3 screen) {
     vec4 temp = vec4(screen.x, screen.y, screen.z, 1);
     temp *= playerTransforms.inverseProjection;
@@ -209,10 +284,17 @@ void main(void) {
                 } else if (LightSources.lights[i].type == 2){//point light
                     shadow = ShadowCalculationPoint(from_vs.fragPos, bias, viewDistance, i);
                 }
-                lightingColorFactor += ((1.0 - shadow) * (diffuseRate + specularRate) * LightSources.lights[i].color) + LightSources.lights[i].ambient;
-                ambientColor += LightSources.lights[i].ambient;
+                vec3 ambient = LightSources.lights[i].ambient;
+                if(LightSources.lights[i].type == 2) {
+                    ambient *= getPointLightAttenuation(LightSources.lights[i].attenuation,
+                                                        length(LightSources.lights[i].position - from_vs.fragPos),
+                                                        LightSources.lights[i].farPlanePoint);
+                }
+                lightingColorFactor += ((1.0 - shadow) * (diffuseRate + specularRate) * LightSources.lights[i].color) + ambient;
+                ambientColor += ambient;
             }
         }
+        addClusteredLights(normal, lightingColorFactor, ambientColor);
         diffuseAndSpecularLightedColor = vec4(
         min(lightingColorFactor.x, 1.0),
         min(lightingColorFactor.y, 1.0),
@@ -1,7 +1,6 @@
 #version 330
 
 #define NR_POINT_LIGHTS 4
-#define NR_MAX_MODELS 1000
 
 layout (location = 2) in vec4 position;
 layout (location = 3) in vec2 textureCoordinate;
@@ -37,13 +36,16 @@ struct LightSource {
 	vec3 ambient;
 };
 
-layout (std140) uniform ModelInformationBlock {
-    mat4 worldTransform[NR_MAX_MODELS];
-} model;
+uniform samplerBuffer allModelTransforms;
+uniform usamplerBuffer allModelIndexes;
 
-layout (std140) uniform ModelIndexBlock {
-    uvec4 models[NR_MAX_MODELS];
-} instance;
+mat4 getModelTransform() {
+    int transformStart = int(texelFetch(allModelIndexes, gl_InstanceID).r) * 4;
+    return mat4(texelFetch(allModelTransforms, transformStart),
+                texelFetch(allModelTransforms, transformStart + 1),
+                texelFetch(allModelTransforms, transformStart + 2),
+                texelFetch(allModelTransforms, transformStart + 3));
+}
 
 layout (std140) uniform LightSourceBlock
 {
@@ -53,7 +55,7 @@ layout (std140) uniform LightSourceBlock
 void main(void)
 {
     to_fs.textureCoord = textureCoordinate;
-    mat4 currentWorldTransform = model.worldTransform[instance.models[gl_InstanceID].x];
+    mat4 currentWorldTransform = getModelTransform();
     to_fs.normal = normalize(mat3(transpose(inverse(currentWorldTransform))) * normal);
     to_fs.fragPos = vec3(currentWorldTransform * position);
     for(int i = 0; i < NR_POINT_LIGHTS; i++){
@@ -1,7 +1,6 @@
 #version 330
 
 #define NR_POINT_LIGHTS 4
-#define NR_MAX_MODELS 1000
 
 #define NR_BONE 128
 
@@ -41,29 +40,48 @@ struct LightSource {
 	vec3 ambient;
 };
 
-layout (std140) uniform ModelInformationBlock {
-    mat4 worldTransform[NR_MAX_MODELS];
-} model;
+uniform samplerBuffer allModelTransforms;
+uniform usamplerBuffer allModelIndexes;
 
-layout (std140) uniform ModelIndexBlock {
-    uvec4 models[NR_MAX_MODELS];
-} instance;
+mat4 getModelTransform() {
+    int transformStart = int(texelFetch(allModelIndexes, gl_InstanceID).r) * 4;
+    return mat4(texelFetch(allModelTransforms, transformStart),
+                texelFetch(allModelTransforms, transformStart + 1),
+                texelFetch(allModelTransforms, transformStart + 2),
+                texelFetch(allModelTransforms, transformStart + 3));
+}
 
 layout (std140) uniform LightSourceBlock
 {
     LightSource lights[NR_POINT_LIGHTS];
 } LightSources;
 
-uniform mat4 boneTransformArray[NR_BONE];
+uniform samplerBuffer allBonePalettes;
+uniform usamplerBuffer allModelPaletteIndexes;
+
+mat4 getBoneTransform(int paletteStart, uint boneID) {
+    int boneStart = paletteStart + int(boneID) * 4;
+    return mat4(texelFetch(allBonePalettes, boneStart),
+                texelFetch(allBonePalettes, boneStart + 1),
+                texelFetch(allBonePalettes, boneStart + 2),
+                texelFetch(allBonePalettes, boneStart + 3));
+}
+
+mat4 getSkinningTransform() {
+    int modelIndex = int(texelFetch(allModelIndexes, gl_InstanceID).r);
+    int paletteStart = int(texelFetch(allModelPaletteIndexes, modelIndex).r) * NR_BONE * 4;
+    mat4 skinningTransform = getBoneTransform(paletteStart, boneIDs[0]) * boneWeights[0];
+    skinningTransform += getBoneTransform(paletteStart, boneIDs[1]) * boneWeights[1];
+    skinningTransform += getBoneTransform(paletteStart, boneIDs[2]) * boneWeights[2];
+    skinningTransform += getBoneTransform(paletteStart, boneIDs[3]) * boneWeights[3];
+    return skinningTransform;
+}
 
 void main(void) {
-    mat4 BoneTransform = boneTransformArray[boneIDs[0]] * boneWeights[0];
-    BoneTransform += boneTransformArray[boneIDs[1]] * boneWeights[1];
-    BoneTransform += boneTransformArray[boneIDs[2]] * boneWeights[2];
-    BoneTransform += boneTransformArray[boneIDs[3]] * boneWeights[3];
+    mat4 BoneTransform = getSkinningTransform();
 
     to_fs.textureCoord = textureCoordinate;
-    mat4 currentWorldTransform = model.worldTransform[instance.models[gl_InstanceID].x];
+    mat4 currentWorldTransform = getModelTransform();
     to_fs.normal = normalize(mat3(transpose(inverse(currentWorldTransform))) * vec3(BoneTransform * vec4(normal, 0.0)));
         to_fs.fragPos = vec3(currentWorldTransform * (BoneTransform * position));
     for(int i = 0; i < NR_POINT_LIGHTS; i++){
@@ -2,7 +2,6 @@
 
 #define NR_POINT_LIGHTS 4
 #define NR_BONE 128
-#define NR_MAX_MODELS 1000
 
 
 layout (location = 2) in vec4 position;
@@ -20,26 +19,46 @@ layout (std140) uniform PlayerTransformBlock {
     vec2 noiseScale;
 } playerTransforms;
 
-layout (std140) uniform ModelInformationBlock {
-    mat4 worldTransform[NR_MAX_MODELS];
-} model;
+uniform samplerBuffer allModelTransforms;
+uniform usamplerBuffer allModelIndexes;
 
-layout (std140) uniform ModelIndexBlock {
-    uvec4 models[NR_MAX_MODELS];
-} instance;
+mat4 getModelTransform() {
+    int transformStart = int(texelFetch(allModelIndexes, gl_InstanceID).r) * 4;
+    return mat4(texelFetch(allModelTransforms, transformStart),
+                texelFetch(allModelTransforms, transformStart + 1),
+                texelFetch(allModelTransforms, transformStart + 2),
+                texelFetch(allModelTransforms, transformStart + 3));
+}
+
+uniform samplerBuffer allBonePalettes;
+uniform usamplerBuffer allModelPaletteIndexes;
+
+mat4 getBoneTransform(int paletteStart, uint boneID) {
+    int boneStart = paletteStart + int(boneID) * 4;
+    return mat4(texelFetch(allBonePalettes, boneStart),
+                texelFetch(allBonePalettes, boneStart + 1),
+                texelFetch(allBonePalettes, boneStart + 2),
+                texelFetch(allBonePalettes, boneStart + 3));
+}
+
+mat4 getSkinningTransform() {
+    int modelIndex = int(texelFetch(allModelIndexes, gl_InstanceID).r);
+    int paletteStart = int(texelFetch(allModelPaletteIndexes, modelIndex).r) * NR_BONE * 4;
+    mat4 skinningTransform = getBoneTransform(paletteStart, boneIDs[0]) * boneWeights[0];
+    skinningTransform += getBoneTransform(paletteStart, boneIDs[1]) * boneWeights[1];
+    skinningTransform += getBoneTransform(paletteStart, boneIDs[2]) * boneWeights[2];
+    skinningTransform += getBoneTransform(paletteStart, boneIDs[3]) * boneWeights[3];
+    return skinningTransform;
+}
 
-uniform mat4 boneTransformArray[NR_BONE];
 uniform int isAnimated;
 
 void main() {
     if(isAnimated==1) {
         mat4 BoneTransform = mat4(1.0);
-        BoneTransform = boneTransformArray[boneIDs[0]] * boneWeights[0];
-        BoneTransform += boneTransformArray[boneIDs[1]] * boneWeights[1];
-        BoneTransform += boneTransformArray[boneIDs[2]] * boneWeights[2];
-        BoneTransform += boneTransformArray[boneIDs[3]] * boneWeights[3];
-        gl_Position = playerTransforms.cameraProjection * (model.worldTransform[instance.models[gl_InstanceID].x] * (BoneTransform * vec4(vec3(position), 1.0)));
+        BoneTransform = getSkinningTransform();
+        gl_Position = playerTransforms.cameraProjection * (getModelTransform() * (BoneTransform * vec4(vec3(position), 1.0)));
     } else {
-        gl_Position = playerTransforms.cameraProjection * (model.worldTransform[instance.models[gl_InstanceID].x] * position);
+        gl_Position = playerTransforms.cameraProjection * (getModelTransform() * position);
     }
 }
\ No newline at end of file
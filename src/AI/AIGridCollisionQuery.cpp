@@ -0,0 +1,105 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include "AIGridCollisionQuery.h"
+#include "../Utils/GLMConverter.h"
+
+AIGridCollisionQuery::AIGridCollisionQuery(const btCollisionWorld *sourceWorld, float capsuleRadius, float capsuleHeight,
+                                           uint32_t collisionGroup, uint32_t collisionMask)
+        : collisionGroup(collisionGroup), collisionMask(collisionMask) {
+    collisionConfiguration = new btDefaultCollisionConfiguration();
+    dispatcher = new btCollisionDispatcher(collisionConfiguration);
+    broadphase = new btDbvtBroadphase();
+    ghostPairCallback = new btGhostPairCallback();
+    broadphase->getOverlappingPairCache()->setInternalGhostPairCallback(ghostPairCallback);
+    collisionWorld = new btCollisionWorld(dispatcher, broadphase, collisionConfiguration);
+
+    //objects can be in a single world, so create a copy for each, using the same shape
+    const btCollisionObjectArray &sourceObjects = sourceWorld->getCollisionObjectArray();
+    for (int i = 0; i < sourceObjects.size(); ++i) {
+        const btCollisionObject *sourceObject = sourceObjects[i];
+        btCollisionObject *staticObject = new btCollisionObject();
+        staticObject->setCollisionShape(const_cast<btCollisionShape *>(sourceObject->getCollisionShape()));
+        staticObject->setWorldTransform(sourceObject->getWorldTransform());
+        staticObject->setCollisionFlags(sourceObject->getCollisionFlags());
+        staticObject->setUserPointer(sourceObject->getUserPointer());
+        const btBroadphaseProxy *sourceProxy = sourceObject->getBroadphaseHandle();
+        if (sourceProxy != nullptr) {
+            collisionWorld->addCollisionObject(staticObject, sourceProxy->m_collisionFilterGroup, sourceProxy->m_collisionFilterMask);
+        } else {
+            collisionWorld->addCollisionObject(staticObject);
+        }
+        staticObjects.push_back(staticObject);
+    }
+    collisionWorld->updateAabbs();
+
+    capsuleShape = new btCapsuleShape(capsuleRadius, capsuleHeight);
+    capsuleObject = new btPairCachingGhostObject();
+    capsuleObject->setCollisionShape(capsuleShape);
+}
+
+AIGridCollisionQuery::~AIGridCollisionQuery() {
+    for (size_t i = 0; i < staticObjects.size(); ++i) {
+        collisionWorld->removeCollisionObject(staticObjects[i]);
+        delete staticObjects[i];
+    }
+    delete capsuleObject;
+    delete capsuleShape;
+    delete collisionWorld;
+    delete broadphase;
+    delete ghostPairCallback;
+    delete dispatcher;
+    delete collisionConfiguration;
+}
+
+bool AIGridCollisionQuery::setProperHeight(glm::vec3 *position, float floatingHeight, float checkHeight) const {
+    btVector3 rayFrom = GLMConverter::GLMToBlt(*position);
+    btVector3 rayTo;
+    if (checkHeight == 0.0) {
+        rayTo = GLMConverter::GLMToBlt(*position - glm::vec3(0, 9999999, 0));//Normally, we expect world aabb min y here, but it is not passed.
+    } else {
+        rayTo = GLMConverter::GLMToBlt(*position - glm::vec3(0, checkHeight, 0));
+    }
+    btCollisionWorld::ClosestRayResultCallback rayCallback(rayFrom, rayTo);
+    collisionWorld->rayTest(rayFrom, rayTo, rayCallback);
+    if (rayCallback.hasHit()) {
+        if(rayCallback.m_hitPointWorld.getY() > (*position - glm::vec3(0, 1, 0)).y) {
+            return false;
+        }
+        position->y = rayCallback.m_hitPointWorld.getY() + floatingHeight;
+        return true;
+    } else {
+        return false;
+    }
+}
+
+bool AIGridCollisionQuery::isThereCollision(const glm::vec3 &position) {
+    collisionCheckCount++;
+    //ghost is only in the world during the check, so the pairs it collects don't slow down other queries
+    collisionWorld->addCollisionObject(capsuleObject, collisionGroup, collisionMask);
+    capsuleObject->setWorldTransform(btTransform(btQuaternion::getIdentity(), GLMConverter::GLMToBlt(position)));
+    //static objects never move in this world, so only the ghost needs its aabb updated
+    collisionWorld->updateSingleAabb(capsuleObject);
+    dispatcher->dispatchAllCollisionPairs(capsuleObject->getOverlappingPairCache(), collisionWorld->getDispatchInfo(),
+                                          dispatcher);
+    bool isCollided = false;
+    btBroadphasePairArray &pairArray = capsuleObject->getOverlappingPairCache()->getOverlappingPairArray();
+    for (int i = 0; i < pairArray.size() && !isCollided; ++i) {
+        manifoldArray.resize(0);
+        if (pairArray[i].m_algorithm) {
+            pairArray[i].m_algorithm->getAllContactManifolds(manifoldArray);
+        }
+        for (int j = 0; j < manifoldArray.size() && !isCollided; ++j) {
+            const btPersistentManifold *manifold = manifoldArray[j];
+            for (int p = 0; p < manifold->getNumContacts(); ++p) {
+                if (manifold->getContactPoint(p).getDistance() < 0.f) {
+                    isCollided = true;
+                    break;
+                }
+            }
+        }
+    }
+    collisionWorld->removeCollisionObject(capsuleObject);
+    return isCollided;
+}
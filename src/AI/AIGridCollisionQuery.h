@@ -0,0 +1,63 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_AIGRIDCOLLISIONQUERY_H
+#define LIMONENGINE_AIGRIDCOLLISIONQUERY_H
+
+
+#include <glm/vec3.hpp>
+#include <vector>
+#include <btBulletCollisionCommon.h>
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+
+/**
+ * Physics queries AI walk grid generation needs, run on a private copy of the static world.
+ *
+ * The copy shares collision shapes with the source world, but has its own broadphase, dispatcher and query objects.
+ * Because of that, different instances can be used from different threads at the same time. The source world must not
+ * change while any instance is alive. A single instance is not thread safe.
+ *
+ * Collision is checked the same way single threaded generation did, with a ghost object and its contact manifolds, so
+ * generated grids don't change.
+ */
+class AIGridCollisionQuery {
+    btDefaultCollisionConfiguration *collisionConfiguration;
+    btCollisionDispatcher *dispatcher;
+    btDbvtBroadphase *broadphase;
+    btGhostPairCallback *ghostPairCallback;
+    btCollisionWorld *collisionWorld;
+    std::vector<btCollisionObject *> staticObjects;
+
+    btCollisionShape *capsuleShape;
+    btPairCachingGhostObject *capsuleObject;
+    btManifoldArray manifoldArray;
+    uint32_t collisionGroup;
+    uint32_t collisionMask;
+
+    uint32_t collisionCheckCount = 0;//this is only meaningful for debug
+
+public:
+    AIGridCollisionQuery(const btCollisionWorld *sourceWorld, float capsuleRadius, float capsuleHeight,
+                         uint32_t collisionGroup, uint32_t collisionMask);
+
+    ~AIGridCollisionQuery();
+
+    /**
+     * 1) create ray, from position -> to position - 999999 (for 0 check height) or position - check height
+     * 2) if there is a hit, move position height to hit+floating height else return false
+     */
+    bool setProperHeight(glm::vec3 *position, float floatingHeight, float checkHeight) const;
+
+    /**
+     * Checks if the capsule placed at position penetrates anything in the world.
+     */
+    bool isThereCollision(const glm::vec3 &position);
+
+    uint32_t getCollisionCheckCount() const {
+        return collisionCheckCount;
+    }
+};
+
+
+#endif //LIMONENGINE_AIGRIDCOLLISIONQUERY_H
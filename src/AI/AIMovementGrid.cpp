@@ -3,473 +3,320 @@
 //
 
 #include <glm/ext.hpp>
+#include <algorithm>
 #include "AIMovementGrid.h"
+#include "../JobSystem.h"
 
 constexpr float AIMovementGrid::floatingHeight;
 
-//FIXME: this must be the worst way to check for a node in a graph, when you already implemented a*
-AIMovementNode *AIMovementGrid::isAlreadyVisited(const glm::vec3 &position, size_t &indexOf) {
-    if(visited.empty()) {
-        return nullptr;
-    }
-    for (size_t i = visited.size() - 1; i > 0; --i) {
-        if (isPositionCloseEnoughYOnly(position, visited[i]->getPosition())) {
-            indexOf = i;
-            return visited[i];
+uint64_t AIMovementGrid::getVisitedKey(const glm::vec3 &position, int32_t bandOffset) const {
+    int32_t cellX = (int32_t)std::floor(position.x - gridOrigin.x + 0.5f);
+    int32_t cellZ = (int32_t)std::floor(position.z - gridOrigin.z + 0.5f);
+    int32_t band = (int32_t)std::floor(position.y / Y_BAND_HEIGHT) + bandOffset;
+    //21 bits each is more than enough for any map, collisions are still checked by position
+    return (((uint64_t)cellX & 0x1FFFFF) << 42) | (((uint64_t)cellZ & 0x1FFFFF) << 21) | ((uint64_t)band & 0x1FFFFF);
+}
+
+AIMovementGrid::VisitedEntry *AIMovementGrid::findVisited(const glm::vec3 &position) {
+    //old linear search returned the last match in visited, which is the most recently created node. IDs are given in
+    //creation order, so highest ID wins here. Buckets are not ordered because of swap removal, all must be checked
+    VisitedEntry *found = nullptr;
+    for (int32_t bandOffset = -1; bandOffset <= 1; ++bandOffset) {
+        auto bucketIt = visitedHash.find(getVisitedKey(position, bandOffset));
+        if(bucketIt == visitedHash.end()) {
+            continue;
+        }
+        for (size_t i = 0; i < bucketIt->second.size(); ++i) {
+            if (isPositionCloseEnoughYOnly(position, bucketIt->second[i].node->getPosition()) &&
+                (found == nullptr || bucketIt->second[i].node->getID() > found->node->getID())) {
+                found = &bucketIt->second[i];
+            }
         }
     }
-    //because size_t wraps around, i>=0 is always true. Instead, = 0 case is below
-    if (isPositionCloseEnoughYOnly(position, visited[0]->getPosition())) {
-        indexOf = 0;
-        return visited[0];
-    }
-    return nullptr;
+    return found;
 }
 
-const AIMovementNode *
-AIMovementGrid::aStarPath(const AIMovementNode *start, const glm::vec3 &destination, uint32_t maximumNumberOfNodes,
-                          std::vector<glm::vec3> *route) {
-
-    std::priority_queue<AINodeWithPriority, std::vector<AINodeWithPriority>, std::greater<AINodeWithPriority>> frontier;
-    frontier.push(AINodeWithPriority(start, 0));
-
-    std::map<const AIMovementNode *, const AIMovementNode *> from;
-    std::map<const AIMovementNode *, float> totalCost;
-    std::map<const AIMovementNode *, uint32_t> totalNodes;
-    const AIMovementNode *finalNode = nullptr;
-    from[start] = nullptr;
-    totalCost[start] = 0;
-    totalNodes[start] = 0;
-    while (!frontier.empty()) {
-        AINodeWithPriority nodeWithPriority = frontier.top();
-        //std::cout << "testing with a* " << GLMUtils::vectorToString(nodeWithPriority.node->getPosition()) << std::endl;
-        frontier.pop();
-        if (isPositionCloseEnough(destination, nodeWithPriority.node->getPosition())) {
-            finalNode = nodeWithPriority.node;
-            break;
-        }
+void AIMovementGrid::addVisited(AIMovementNode *node) {
+    VisitedEntry entry;
+    entry.node = node;
+    entry.visitedIndex = visited.size();
+    visited.push_back(node);
+    visitedHash[getVisitedKey(node->getPosition(), 0)].push_back(entry);
+}
 
-        if(maximumNumberOfNodes != 0 && (totalNodes.count(nodeWithPriority.node) != 0 && totalNodes[nodeWithPriority.node] >= maximumNumberOfNodes)) {
-            //we searched for this depth, but couldn't found the player no need to keep searching
-            break;
+void AIMovementGrid::removeVisited(AIMovementNode *node) {
+    auto bucketIt = visitedHash.find(getVisitedKey(node->getPosition(), 0));
+    if(bucketIt == visitedHash.end()) {
+        return;
+    }
+    std::vector<VisitedEntry> &bucket = bucketIt->second;
+    for (size_t i = 0; i < bucket.size(); ++i) {
+        if(bucket[i].node != node) {
+            continue;
         }
-
-        for (int i = 0; i < 9; ++i) {
-            AIMovementNode *currentNode = nodeWithPriority.node->getNeighbour(i);
-            if (currentNode == nullptr) {
-                continue;
-            }
-            if (!currentNode->isIsMovable()) {
-                continue;//if not movable, it means we don't need its child
-            }
-            //make going cross a little harder
-            float movementCost = glm::length(currentNode->getPosition() - nodeWithPriority.node->getPosition());
-            float heuristic = glm::length(destination - currentNode->getPosition());
-            float currentCost = totalCost[nodeWithPriority.node] + movementCost + heuristic;
-            float currentNodeCount = totalNodes[nodeWithPriority.node] + 1;
-            if (!totalCost.count(currentNode) || currentCost < totalCost[currentNode]) {
-                //float currentPriority = currentCost + heuristic;
-//                std::cout << "for node " << GLMUtils::vectorToString(currentNode->getPosition()) << " priority is " << currentCost << " with heuristic " << heuristic << std::endl;
-                frontier.push(AINodeWithPriority(currentNode, currentCost));
-                from[currentNode] = nodeWithPriority.node;
-                totalCost[currentNode] = currentCost;
-                totalNodes[currentNode] = currentNodeCount;
+        //move last visited node to the removed position, and update its entry
+        size_t removedIndex = bucket[i].visitedIndex;
+        bucket[i] = bucket.back();
+        bucket.pop_back();
+        if(bucket.empty()) {
+            visitedHash.erase(bucketIt);
+        }
+        if(removedIndex != visited.size() - 1) {
+            AIMovementNode *movedNode = visited.back();
+            visited[removedIndex] = movedNode;
+            std::vector<VisitedEntry> &movedBucket = visitedHash[getVisitedKey(movedNode->getPosition(), 0)];
+            for (size_t j = 0; j < movedBucket.size(); ++j) {
+                if(movedBucket[j].node == movedNode) {
+                    movedBucket[j].visitedIndex = removedIndex;
+                    break;
+                }
             }
         }
+        visited.pop_back();
+        return;
+    }
+}
 
+AIMovementNode *AIMovementGrid::isAlreadyVisited(const glm::vec3 &position) {
+    VisitedEntry *entry = findVisited(position);
+    if(entry == nullptr) {
+        return nullptr;
     }
+    return entry->node;
+}
 
-    if (finalNode == nullptr) {
-        std::cerr << "Path search failed, please check the values: " << GLMUtils::vectorToString(start->getPosition())
-                  << " to " << GLMUtils::vectorToString(destination) << std::endl;
-        return finalNode;
-    } else {
-        if (start == finalNode) {
-            return finalNode;//don't put anything to the route;
-        }
-        route->clear();
-        route->push_back(finalNode->getPosition());
-        //std::cout << GLMUtils::vectorToString(finalNode->getPosition()) << ", " << (finalNode->isIsMovable()? " yes":"no") << std::endl;
-        const AIMovementNode *fromNode = from[finalNode];
-        while (start != fromNode) {
-            route->push_back(fromNode->getPosition());
-            fromNode = from[fromNode];
-            //std::cout << GLMUtils::vectorToString(fromNode->getPosition()) << ", " << (fromNode->isIsMovable()? " yes":"no") << std::endl;
+void AIMovementGrid::runCollisionQueries(JobSystem *jobSystem, size_t queryCount,
+                                         const std::function<void(AIGridCollisionQuery &, size_t, size_t)> &queryRunner) {
+    if(queryCount == 0) {
+        return;
+    }
+    size_t chunkCount = std::min(collisionQueries.size(), (queryCount + MINIMUM_QUERIES_PER_JOB - 1) / MINIMUM_QUERIES_PER_JOB);
+    if(jobSystem == nullptr || chunkCount <= 1) {
+        queryRunner(*collisionQueries[0], 0, queryCount);
+        return;
+    }
+    size_t chunkSize = (queryCount + chunkCount - 1) / chunkCount;
+    std::vector<JobSystem::Future<bool>> chunkJobs;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        size_t begin = i * chunkSize;
+        size_t end = std::min(queryCount, begin + chunkSize);
+        if(begin >= end) {
+            break;
         }
-        return finalNode;
+        AIGridCollisionQuery *collisionQuery = collisionQueries[i];
+        chunkJobs.push_back(jobSystem->submit([collisionQuery, begin, end, &queryRunner]() {
+            queryRunner(*collisionQuery, begin, end);
+            return true;
+        }));
+    }
+    for (size_t i = 0; i < chunkJobs.size(); ++i) {
+        chunkJobs[i].get();
     }
 }
 
 /**
- * Since this Method checks the world, it is perfectly possible ghost object is detected as valid it point. Remove it before calling this method
+ * Walks the grid breadth first, one depth level at a time. Physics queries of a level are independent of each other,
+ * so they are run in parallel, but graph is built on the calling thread in the same order as a serial walk:
  *
- * 1) create ray, from position -> to position - 999999 (for 0 check height) or position - check height
- * 2) if there is a hit, move position height to hit+floating height else return false
+ * 1) ray test for every empty neighbour slot of the level, in parallel
+ * 2) link/create neighbours in BFS order, using the ray test results
+ * 3) collision test for the nodes created in step 2, in parallel
+ * 4) mark movable ones, and they become the next level, in creation order
  *
- * @param position
- * @param floatingHeight
- * @param checkHeight
- * @param staticWorld
- * @return
+ * Only step 1 and 3 depend on the physics world, so the result is the same with a serial walk.
  */
-bool AIMovementGrid::setProperHeight(glm::vec3 *position, float floatingHeight, float checkHeight,
-                                     btDiscreteDynamicsWorld *staticWorld) {
-    rayCallback->m_rayFromWorld = GLMConverter::GLMToBlt(*position);
-    if (checkHeight == 0.0) {
-        rayCallback->m_rayToWorld = GLMConverter::GLMToBlt(
-                *position - glm::vec3(0, 9999999, 0));//Normally, we expect world aabb min y here, but it is not passed.
-    } else {
-        rayCallback->m_rayToWorld = GLMConverter::GLMToBlt(*position - glm::vec3(0, checkHeight, 0));
-    }
-    rayCallback->m_closestHitFraction = 1;
-    rayCallback->m_collisionObject = nullptr;
-    staticWorld->rayTest(rayCallback->m_rayFromWorld, rayCallback->m_rayToWorld, *rayCallback);
-    if (rayCallback->hasHit()) {
-        if(rayCallback->m_hitPointWorld.getY() > (*position - glm::vec3(0, 1, 0)).y) {
-            return false;
-        }
-        position->y = rayCallback->m_hitPointWorld.getY() + floatingHeight;
-        return true;
-    } else {
-        return false;
-    }
-}
-
 AIMovementNode *
-AIMovementGrid::walkMonster(glm::vec3 walkPoint, btDiscreteDynamicsWorld *staticWorld, const glm::vec3 &min,
-                            const glm::vec3 &max, uint32_t collisionGroup, uint32_t collisionMask) {
-    std::queue<AIMovementNode *> frontier;
-    if (!setProperHeight(&walkPoint, floatingHeight, -1 * min.y, staticWorld)) {
+AIMovementGrid::walkMonster(glm::vec3 walkPoint, const glm::vec3 &min, const glm::vec3 &max, JobSystem *jobSystem) {
+    if (!collisionQueries[0]->setProperHeight(&walkPoint, floatingHeight, -1 * min.y)) {
         std::cerr << "Root node has nothing underneath, grid generation failed. " << std::endl;
         return root;
     }
 
     AIMovementNode *root = new AIMovementNode(getNextID(), walkPoint);
-    staticWorld->addCollisionObject(sharedGhostObject, collisionGroup, collisionMask);
-    sharedGhostObject->setWorldTransform(
-            btTransform(btQuaternion::getIdentity(), GLMConverter::GLMToBlt(root->getPosition())));
-    btVector3 minO, maxO;
-    sharedGhostObject->getCollisionShape()->getAabb(sharedGhostObject->getWorldTransform(), minO, maxO);
-    bool isMovable = !isThereCollision(staticWorld);
-    staticWorld->removeCollisionObject(sharedGhostObject);
+    gridOrigin = walkPoint;
+    bool isMovable = !collisionQueries[0]->isThereCollision(root->getPosition());
+    std::vector<AIMovementNode *> currentLevel;
     if (isMovable) {
         root->setIsMovable(isMovable);
-        frontier.push(root);
-        visited.push_back(root);
+        currentLevel.push_back(root);
+        addVisited(root);
 
         std::cerr << "Root node " << GLMUtils::vectorToString(walkPoint) << "is movable, AI walk grid generation starts." << std::endl;
     } else {
         std::cerr << "Root node " << GLMUtils::vectorToString(walkPoint) << "is not movable, AI walk grid generation failed. Please check map." << std::endl;
         return root;
     }
-    size_t indexOfFoundNode;
-    AIMovementNode *current;
-    while (!frontier.empty()) {
-        current = frontier.front();
-        frontier.pop();
-
-        if(doneNodes.size() %10000 == 0) {
-            std::cout << "After "<< SDL_GetTicks() << " current done " << doneNodes.size() << " nodes, partial " << visited.size() << " last node: " << glm::to_string(current->getPosition()) << std::endl;
-        }
 
-        for (int i = -1; i <= 1; ++i) {
-            for (int j = -1; j <= 1; ++j) {
-                if (i == 0 && j == 0) {
-                    continue; //skip the center, it is the self
-                } else {
+    Uint32 generationStartTime = SDL_GetTicks();
+    std::vector<HeightQuery> heightQueries;
+    std::vector<AIMovementNode *> createdNodes;
+    std::vector<uint8_t> createdNodeCollisions;
+    std::vector<AIMovementNode *> nextLevel;
+    while (!currentLevel.empty()) {
+        //1) ray tests. Slots filled during step 2 are not needed, but they are computed anyway, it is cheaper than waiting
+        heightQueries.resize(currentLevel.size() * 9);
+        for (size_t nodeIndex = 0; nodeIndex < currentLevel.size(); ++nodeIndex) {
+            for (int i = -1; i <= 1; ++i) {
+                for (int j = -1; j <= 1; ++j) {
                     int neighbourIndex = (i + 1) * 3 + (j + 1);
-                    if(current->getNeighbour(neighbourIndex) != nullptr) {
-                        continue;//already set
-                    }
-                    isMovable = true;
-                    glm::vec3 neighbourPosition = current->getPosition() + glm::vec3(i, 0, j);
-                    if (!setProperHeight(&neighbourPosition, floatingHeight, floatingHeight + 1.0f, staticWorld)) {
-                        isMovable = false;
-                    }
-
-                    if (neighbourPosition.x < min.x || neighbourPosition.y < min.y || neighbourPosition.z < min.z ||
-                        neighbourPosition.x > max.x || neighbourPosition.y > max.y || neighbourPosition.z > max.z) {
-                        //this means this position is out of whole world AABB, skip
-                        continue;
-                    }
-
-                    AIMovementNode *visitedNode = isAlreadyVisited(neighbourPosition, indexOfFoundNode);
-                    if (visitedNode != nullptr) {
-                        //std::cout << "already visited node at " << GLMUtils::vectorToString(neighbourPosition) << std::endl;
-                        //std::cout << "already visited node position is " << GLMUtils::vectorToString(visitedNode->getPosition()) << std::endl;
-                        current->setNeighbour(neighbourIndex, visitedNode);
-                    } else {
-                        //std::cout << "adding new node with position " << GLMUtils::vectorToString(neighbourPosition) << std::endl;
-                        staticWorld->addCollisionObject(sharedGhostObject, collisionGroup, collisionMask);
-                        sharedGhostObject->setWorldTransform(
-                                btTransform(btQuaternion::getIdentity(), GLMConverter::GLMToBlt(neighbourPosition)));
-                        isMovable = isMovable && !isThereCollision(staticWorld);
-                        staticWorld->removeCollisionObject(sharedGhostObject);
-
-
-                        AIMovementNode *neighbour = new AIMovementNode(getNextID(), neighbourPosition);
-                        neighbour->setIsMovable(isMovable);
-                        current->setNeighbour(neighbourIndex, neighbour);
-                        visited.push_back(neighbour);
-                        if(isMovable) {
-                            frontier.push(neighbour);
-                        }
-                    }
+                    HeightQuery &heightQuery = heightQueries[nodeIndex * 9 + neighbourIndex];
+                    heightQuery.position = currentLevel[nodeIndex]->getPosition() + glm::vec3(i, 0, j);
+                    heightQuery.isNeeded = !(i == 0 && j == 0) && currentLevel[nodeIndex]->getNeighbour(neighbourIndex) == nullptr;
+                    heightQuery.hasGround = false;
                 }
             }
         }
-        if(isAlreadyVisited(current->getPosition(), indexOfFoundNode)) {
-            visited.erase(visited.begin() + indexOfFoundNode);
-        }
-
-        doneNodes.push_back(current);
-        if(current->getPosition().x > this->max.x) { this->max.x = current->getPosition().x;}
-        if(current->getPosition().y > this->max.y) { this->max.y = current->getPosition().y;}
-        if(current->getPosition().z > this->max.z) { this->max.z = current->getPosition().z;}
-
-        if(current->getPosition().x < this->min.x) { this->min.x = current->getPosition().x;}
-        if(current->getPosition().y < this->min.y) { this->min.y = current->getPosition().y;}
-        if(current->getPosition().z < this->min.z) { this->min.z = current->getPosition().z;}
+        runCollisionQueries(jobSystem, heightQueries.size(),
+                            [&heightQueries](AIGridCollisionQuery &collisionQuery, size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                if (heightQueries[k].isNeeded) {
+                    heightQueries[k].hasGround = collisionQuery.setProperHeight(&heightQueries[k].position, floatingHeight, floatingHeight + 1.0f);
+                }
+            }
+        });
+
+        //2) build the graph in BFS order
+        createdNodes.clear();
+        for (size_t nodeIndex = 0; nodeIndex < currentLevel.size(); ++nodeIndex) {
+            AIMovementNode *current = currentLevel[nodeIndex];
+            if(doneNodes.size() %10000 == 0) {
+                std::cout << "After "<< SDL_GetTicks() << " current done " << doneNodes.size() << " nodes, partial " << visited.size() << " last node: " << glm::to_string(current->getPosition()) << std::endl;
+            }
 
-    }
+            for (int neighbourIndex = 0; neighbourIndex < 9; ++neighbourIndex) {
+                if (neighbourIndex == 4) {
+                    continue; //skip the center, it is the self
+                }
+                if(current->getNeighbour(neighbourIndex) != nullptr) {
+                    continue;//already set
+                }
+                const HeightQuery &heightQuery = heightQueries[nodeIndex * 9 + neighbourIndex];
+                const glm::vec3 &neighbourPosition = heightQuery.position;
 
-    std::cout << "Walk grid creation finished with " << doneNodes.size() << " nodes between " << glm::to_string(this->min) << ", " << glm::to_string(this->max) << std::endl;
-    return root;
-}
+                if (neighbourPosition.x < min.x || neighbourPosition.y < min.y || neighbourPosition.z < min.z ||
+                    neighbourPosition.x > max.x || neighbourPosition.y > max.y || neighbourPosition.z > max.z) {
+                    //this means this position is out of whole world AABB, skip
+                    continue;
+                }
 
-bool AIMovementGrid::isThereCollision(btDiscreteDynamicsWorld *staticWorld) {
-    isThereCollisionCounter++;
-    staticWorld->updateAabbs();//this should not be needed, but it is. I have no idea why
-    staticWorld->getDispatcher()->dispatchAllCollisionPairs(sharedGhostObject->getOverlappingPairCache(),
-                                                            staticWorld->getDispatchInfo(),
-                                                            staticWorld->getDispatcher());
-    btBroadphasePairArray &pairArray = sharedGhostObject->getOverlappingPairCache()->getOverlappingPairArray();
-    int numPairs = pairArray.size();
+                AIMovementNode *visitedNode = isAlreadyVisited(neighbourPosition);
+                if (visitedNode != nullptr) {
+                    current->setNeighbour(neighbourIndex, visitedNode);
+                } else {
+                    AIMovementNode *neighbour = new AIMovementNode(getNextID(), neighbourPosition);
+                    neighbour->setIsMovable(heightQuery.hasGround);//collision is checked in step 3
+                    current->setNeighbour(neighbourIndex, neighbour);
+                    addVisited(neighbour);
+                    createdNodes.push_back(neighbour);
+                }
+            }
+            removeVisited(current);
 
-    for (int i = 0; i < numPairs; ++i) {
-        const btBroadphasePair &pair = pairArray[i];
+            doneNodes.push_back(current);
+            if(current->getPosition().x > this->max.x) { this->max.x = current->getPosition().x;}
+            if(current->getPosition().y > this->max.y) { this->max.y = current->getPosition().y;}
+            if(current->getPosition().z > this->max.z) { this->max.z = current->getPosition().z;}
 
-        if (pair.m_algorithm) {
-            pair.m_algorithm->getAllContactManifolds(sharedManifoldArray);
+            if(current->getPosition().x < this->min.x) { this->min.x = current->getPosition().x;}
+            if(current->getPosition().y < this->min.y) { this->min.y = current->getPosition().y;}
+            if(current->getPosition().z < this->min.z) { this->min.z = current->getPosition().z;}
         }
 
-        for (int j = 0; j < sharedManifoldArray.size(); j++) {
-            btPersistentManifold *manifold = sharedManifoldArray[j];
-            for (int p = 0; p < manifold->getNumContacts(); ++p) {
-                const btManifoldPoint &pt = manifold->getContactPoint(p);
-
-                if (pt.getDistance() < 0.f) {
-                    // There is a collision
-                    return true;
+        //3) collision tests for new nodes that have ground
+        createdNodeCollisions.assign(createdNodes.size(), 0);
+        runCollisionQueries(jobSystem, createdNodes.size(),
+                            [&createdNodes, &createdNodeCollisions](AIGridCollisionQuery &collisionQuery, size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                if (createdNodes[k]->isIsMovable()) {
+                    createdNodeCollisions[k] = collisionQuery.isThereCollision(createdNodes[k]->getPosition()) ? 1 : 0;
                 }
             }
+        });
+
+        //4) movable nodes are the next level
+        nextLevel.clear();
+        for (size_t k = 0; k < createdNodes.size(); ++k) {
+            bool isCreatedNodeMovable = createdNodes[k]->isIsMovable() && createdNodeCollisions[k] == 0;
+            createdNodes[k]->setIsMovable(isCreatedNodeMovable);
+            if(isCreatedNodeMovable) {
+                nextLevel.push_back(createdNodes[k]);
+            }
         }
-        sharedManifoldArray.resize(0);
-
+        currentLevel.swap(nextLevel);
     }
-    return false;
-}
-
-AIMovementGrid::AIMovementGrid(glm::vec3 startPoint, btDiscreteDynamicsWorld *staticOnlyPhysicsWorld, glm::vec3 min,
-                               glm::vec3 max, uint32_t collisionGroup, uint32_t collisionMask) {
-    //sharedGhostObject->setCollisionShape(new btBoxShape(btVector3(1.0f,1.0f,1.0f)));
-    //sharedGhostObject->setCollisionShape(new btCapsuleShape(1,1));
-    ghostShape = new btCapsuleShape(capsuleRadius, capsuleHeight);
 
-    sharedGhostObject->setCollisionShape(ghostShape);
-    sharedGhostObject->setCollisionFlags(
-            sharedGhostObject->getCollisionFlags());
-    sharedGhostObject->setWorldTransform(btTransform(btQuaternion::getIdentity(), GLMConverter::GLMToBlt(startPoint)));
-    std::cout << "Start generating AI walk grid" << std::endl;
-    doneNodes.push_back(new AIMovementNode(0, glm::vec3(0,100,0)));//0 index element should be empty
-    root = walkMonster(startPoint, staticOnlyPhysicsWorld, min, max, collisionGroup, collisionMask);
-    std::cout << "Finished generating AI walk grid, created " << visited.size() << " nodes, checked for collision "
-              << isThereCollisionCounter << " times." << std::endl;
-    staticOnlyPhysicsWorld->removeCollisionObject(sharedGhostObject);
+    Uint32 generationTime = SDL_GetTicks() - generationStartTime;
+    std::cout << "Walk grid creation finished with " << doneNodes.size() << " nodes between " << glm::to_string(this->min) << ", " << glm::to_string(this->max)
+              << " in " << generationTime << " ms, " << (doneNodes.size() * 1000) / (generationTime + 1) << " nodes/sec." << std::endl;
+    return root;
 }
 
-bool
-AIMovementGrid::coursePath(const glm::vec3 &from, const glm::vec3 &to, uint32_t actorId, uint32_t maximumNumberOfNodes, std::vector<glm::vec3> *route) {
-
-    //first search for from node.
-    const AIMovementNode *fromAINode = nullptr;
-    if (actorLastNodeMap.find(actorId) != actorLastNodeMap.end()) {
-        //if we already processed this actor before, use the last position of that actor we know
-        fromAINode = actorLastNodeMap[actorId];
-    } else {
-        //if we never processed this actor, use root node for search start.
-        fromAINode = root;
-    }
-    if (fromAINode == nullptr) {
-        std::cerr << "Old from node turned out to be NULL. This shouldn't have happened" << std::endl;
-        return false;
+AIMovementGrid::AIMovementGrid(glm::vec3 startPoint, const btDiscreteDynamicsWorld *staticOnlyPhysicsWorld, glm::vec3 min,
+                               glm::vec3 max, uint32_t collisionGroup, uint32_t collisionMask, JobSystem *jobSystem) {
+    size_t collisionQueryCount = 1;
+    if(jobSystem != nullptr) {
+        collisionQueryCount = jobSystem->getWorkerCount();
     }
-
-    //search where the actor is
-    fromAINode = aStarPath(fromAINode, from, 0, route);//0 means search whole map
-
-    if (fromAINode == nullptr) {
-        std::cerr << "new from node can't be found, this means snap distance is too small." << std::endl;
-        return false;
+    for (size_t i = 0; i < collisionQueryCount; ++i) {
+        collisionQueries.push_back(new AIGridCollisionQuery(staticOnlyPhysicsWorld, capsuleRadius, capsuleHeight, collisionGroup, collisionMask));
     }
+    std::cout << "Start generating AI walk grid" << std::endl;
+    doneNodes.push_back(new AIMovementNode(0, glm::vec3(0,100,0)));//0 index element should be empty
+    root = walkMonster(startPoint, min, max, jobSystem);
 
-    //save actor position to use on later calls
-    actorLastNodeMap[actorId] = fromAINode;
-
-    const AIMovementNode *finalNode = aStarPath(fromAINode, to, maximumNumberOfNodes, route);
-
-    if (finalNode == nullptr) {
-        std::cerr << "Destination can't be reached, most likely player moved to somewhere AI can't." << std::endl;
-        return false;
-    } else {
-        return true;
+    uint32_t collisionCheckCount = 0;
+    for (size_t i = 0; i < collisionQueries.size(); ++i) {
+        collisionCheckCount += collisionQueries[i]->getCollisionCheckCount();
+        delete collisionQueries[i];
     }
+    collisionQueries.clear();
+    std::cout << "Finished generating AI walk grid, created " << visited.size() << " nodes, checked for collision "
+              << collisionCheckCount << " times." << std::endl;
 }
 
-bool AIMovementGrid::coursePath(const glm::vec3 &from, const glm::vec3 &to, uint32_t maximumNumberOfNodes, std::vector<glm::vec3> *route) {
-    //first start by finding the from point. We should  cache these from values at some point, so we don't a* twice all the time
-    const AIMovementNode *fromAINode;
-
-    long start = SDL_GetTicks();
+std::shared_ptr<const AINavigationSnapshot> AIMovementGrid::createNavigationSnapshot() const {
+    std::unordered_map<const AIMovementNode *, uint32_t> nodeIndexes;
 
-    fromAINode = aStarPath(root, from, 0, route);
-    if (fromAINode == nullptr) {
-        return false;
+    uint32_t nextIndex = 1;//0 index element should be empty
+    //root is always the first node, xml export depends on it
+    if(root != nullptr && nodeIndexes.insert(std::make_pair(root, nextIndex)).second) {
+        nextIndex++;
     }
-
-    aStarPath(fromAINode, to, maximumNumberOfNodes, route);
-    long end = SDL_GetTicks();
-    std::cout << "route set " << end - start << std::endl;
-
-
-
-    return true;
-}
-
-void AIMovementGrid::debugDraw(BulletDebugDrawer *debugDrawer) const {
-    glm::vec3 toColor, fromColor;
-    for (size_t i = 1; i < doneNodes.size(); i++) {
-        int neighbourCount = 5; //if not an edge, just draw first 4, the last 4 should be rendered by the neighbours
-        if (doneNodes[i]->isIsMovable()) {
-            fromColor = glm::vec3(1, 1, 1);
-        } else {
-            fromColor = glm::vec3(1, 0, 0);
-            neighbourCount = 9; //if on an edge, neighbours will not be able to draw rest, draw all.
-        }
-        for (int j = 0; j < neighbourCount; ++j) {
-            if (doneNodes[i]->getNeighbour(j) != nullptr) {
-                if (doneNodes[i]->getNeighbour(j)->isIsMovable()) {
-                    toColor = glm::vec3(1, 1, 1);
-                } else {
-                    toColor = glm::vec3(1, 0, 0);
-                }
-                debugDrawer->drawLine(GLMConverter::GLMToBlt(doneNodes[i]->getPosition()),
-                                      GLMConverter::GLMToBlt(doneNodes[i]->getNeighbour(j)->getPosition()),
-                                      GLMConverter::GLMToBlt(fromColor), GLMConverter::GLMToBlt(toColor));
-            }
+    //doneNodes 0 is the empty node, visited has no empty node
+    for (size_t i = 1; i < doneNodes.size(); ++i) {
+        if(nodeIndexes.insert(std::make_pair(doneNodes[i], nextIndex)).second) {
+            nextIndex++;
         }
     }
-    //Same with visited nodes
-    for (size_t i = 1; i < visited.size(); i++) {
-        int neighbourCount = 5; //if not an edge, just draw first 4, the last 4 should be rendered by the neighbours
-        if (visited[i]->isIsMovable()) {
-            fromColor = glm::vec3(1, 1, 1);
-        } else {
-            fromColor = glm::vec3(1, 0, 0);
-            neighbourCount = 9; //if on an edge, neighbours will not be able to draw rest, draw all.
+    for (size_t i = 0; i < visited.size(); ++i) {
+        if(nodeIndexes.insert(std::make_pair(visited[i], nextIndex)).second) {
+            nextIndex++;
         }
-        for (int j = 0; j < neighbourCount; ++j) {
-            if (visited[i]->getNeighbour(j) != nullptr) {
-                if (visited[i]->getNeighbour(j)->isIsMovable()) {
-                    toColor = glm::vec3(1, 1, 1);
-                } else {
-                    toColor = glm::vec3(1, 0, 0);
-                }
-                debugDrawer->drawLine(GLMConverter::GLMToBlt(visited[i]->getPosition()),
-                                      GLMConverter::GLMToBlt(visited[i]->getNeighbour(j)->getPosition()),
-                                      GLMConverter::GLMToBlt(fromColor), GLMConverter::GLMToBlt(toColor));
-            }
-        }
-    }
-}
-
-bool AIMovementGrid::serialize(const std::string &fileName) {
-    tinyxml2::XMLDocument aiGridDocument;
-    tinyxml2::XMLNode * rootNode = aiGridDocument.NewElement("AIWalkGrid");
-    aiGridDocument.InsertFirstChild(rootNode);
-
-    tinyxml2::XMLElement* currentElement = aiGridDocument.NewElement("Name");
-    currentElement->SetText(fileName.c_str());
-    rootNode->InsertEndChild(currentElement);
-
-    currentElement = aiGridDocument.NewElement("MaximumNodeID");
-    currentElement->SetText(nextPossibleIndex);
-    rootNode->InsertEndChild(currentElement);
-
-    tinyxml2::XMLElement * nodesElement = aiGridDocument.NewElement("Nodes");
-
-    for (auto nodeIt = doneNodes.begin(); nodeIt != doneNodes.end(); ++nodeIt) {
-        serializeNode(aiGridDocument, rootNode, *nodeIt);
     }
 
-    for (auto nodeIt = visited.begin(); nodeIt != visited.end(); ++nodeIt) {
-        serializeNode(aiGridDocument, rootNode, *nodeIt);
-    }
-
-    rootNode->InsertEndChild(nodesElement);
-
-
-    tinyxml2::XMLError eResult = aiGridDocument.SaveFile(fileName.c_str());
-    if(eResult != tinyxml2::XML_SUCCESS) {
-        std::cerr  << "ERROR saving AI grid: " << eResult << std::endl;
-        return false;
-    }
-    return true;
-}
-
-void AIMovementGrid::serializeNode(tinyxml2::XMLDocument &aiGridDocument, tinyxml2::XMLNode *rootNode, const AIMovementNode *nodeToSerialize) const {
-    tinyxml2::XMLElement* nodeElement = aiGridDocument.NewElement("Node");
-
-    tinyxml2::XMLElement *currentElement = aiGridDocument.NewElement("ID");
-    currentElement->SetText(std::__cxx11::to_string(nodeToSerialize->getID()).c_str());
-    nodeElement->InsertEndChild(currentElement);
-
-    currentElement = aiGridDocument.NewElement("Mv");
-    currentElement->SetText((nodeToSerialize->isIsMovable() ? "True" : "False"));
-    nodeElement->InsertEndChild(currentElement);
-
-    currentElement = aiGridDocument.NewElement("Ps");
-    {
-            tinyxml2::XMLElement *positionXElement = aiGridDocument.NewElement("X");
-            positionXElement->SetText(std::__cxx11::to_string(nodeToSerialize->getPosition().x).c_str());
-            currentElement->InsertEndChild(positionXElement);
-
-            tinyxml2::XMLElement *positionYElement = aiGridDocument.NewElement("Y");
-            positionYElement->SetText(std::__cxx11::to_string(nodeToSerialize->getPosition().y).c_str());
-            currentElement->InsertEndChild(positionYElement);
-
-            tinyxml2::XMLElement *positionZElement = aiGridDocument.NewElement("Z");
-            positionZElement->SetText(std::__cxx11::to_string(nodeToSerialize->getPosition().z).c_str());
-            currentElement->InsertEndChild(positionZElement);
-
-        }
-    nodeElement->InsertEndChild(currentElement);
-
-
-    for (int i = 0; i < 9; ++i) {
+    AINavigationSnapshot::NodeArrays nodeArrays;
+    nodeArrays.resize(nextIndex);
+    for (auto nodeIt = nodeIndexes.begin(); nodeIt != nodeIndexes.end(); ++nodeIt) {
+        uint32_t index = nodeIt->second;
+        nodeArrays.positions[index] = nodeIt->first->getPosition();
+        nodeArrays.setMovable(index, nodeIt->first->isIsMovable());
+        for (int i = 0; i < 9; ++i) {
             if(i == 4) {
                 continue;//4 is self
             }
-            currentElement = aiGridDocument.NewElement("Nb");//neighbour
-            currentElement->SetAttribute("Ps", std::__cxx11::to_string(i).c_str());//position
-            if(nodeToSerialize->getNeighbour(i) != nullptr) {
-                currentElement->SetText(std::__cxx11::to_string(nodeToSerialize->getNeighbour(i)->getID()).c_str());
-            } else {
-                currentElement->SetText("0");//writing 0 if null
+            auto neighbourIt = nodeIndexes.find(nodeIt->first->getNeighbour(i));
+            if(neighbourIt != nodeIndexes.end()) {
+                nodeArrays.neighbours[index * AINavigationSnapshot::NEIGHBOUR_COUNT + AINavigationSnapshot::getNeighbourSlot(i)] = neighbourIt->second;
             }
-            nodeElement->InsertEndChild(currentElement);
         }
-    rootNode->InsertEndChild(nodeElement);
+    }
+
+    uint32_t rootIndex = AINavigationSnapshot::NO_NODE;
+    auto rootIt = nodeIndexes.find(root);
+    if(rootIt != nodeIndexes.end()) {
+        rootIndex = rootIt->second;
+    }
+    return std::make_shared<const AINavigationSnapshot>(std::move(nodeArrays), rootIndex);
 }
 
 AIMovementGrid *AIMovementGrid::deserialize(const std::string &fileName) {
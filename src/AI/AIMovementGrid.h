@@ -14,31 +14,31 @@
 #include <vector>
 #include <queue>
 #include <unordered_set>
+#include <unordered_map>
 #include <map>
+#include <memory>
+#include <functional>
 
 #include "AIMovementNode.h"
+#include "AINavigationSnapshot.h"
+#include "AIGridCollisionQuery.h"
 #include "../Utils/GLMConverter.h"
 #include "../Utils/GLMUtils.h"
 #include "../BulletDebugDrawer.h"
 
-//bigger than sqrt(3)/2
-//avoiding sqrt
-#define GRID_SNAP_DISTANCE (0.8f * 0.8f)
-
 #define X_Z_DISTANCE 0.1
 #define Y_DISTANCE_SQ 0.25
+#define Y_BAND_HEIGHT 0.5f //sqrt(Y_DISTANCE_SQ), so close enough nodes are in the same or neighbouring band
+#define MINIMUM_QUERIES_PER_JOB 64
 
-class AIMovementGrid {
-
-    struct AINodeWithPriority {
-        const AIMovementNode *node;
-        float priority;
+class JobSystem;
 
-        AINodeWithPriority(const AIMovementNode *node, float priority) : node(node), priority(priority) {}
+class AIMovementGrid {
+    friend class AIMovementGridTest;//checks visited node lookup directly
 
-        bool operator>(const AINodeWithPriority &aiRight) const {
-            return priority > aiRight.priority;
-        }
+    struct VisitedEntry {
+        AIMovementNode *node;
+        size_t visitedIndex;//position in visited vector
     };
 
     bool inline isPositionCloseEnoughYOnly(const glm::vec3 &position1, const glm::vec3 &position2) const {
@@ -47,37 +47,49 @@ class AIMovementGrid {
                 (((position1.y - position2.y) * (position1.y - position2.y)) <= Y_DISTANCE_SQ));
     }
 
-    bool inline isPositionCloseEnough(const glm::vec3 &position1, const glm::vec3 &position2) const {
-        return (glm::length2(position1 - position2) < GRID_SNAP_DISTANCE);
-    }
+    struct HeightQuery {
+        glm::vec3 position;
+        bool isNeeded;
+        bool hasGround;
+    };
 
     AIMovementNode *root = nullptr;
-    btCollisionShape *ghostShape = nullptr;
-    btPairCachingGhostObject *sharedGhostObject = new btPairCachingGhostObject();
-    btCollisionWorld::ClosestRayResultCallback *rayCallback = new btCollisionWorld::ClosestRayResultCallback(
-            btVector3(0, 0, 0), btVector3(0, 0, 0));
-    btManifoldArray sharedManifoldArray;
-    std::map<int, const AIMovementNode *> actorLastNodeMap;
     uint32_t nextPossibleIndex = 1;//this is to be used internal and constructor only. Not thread safe
 
-    int isThereCollisionCounter = 0;//this is only meaningful for debug
     float capsuleHeight = 1.30f + 0.1f;
     float capsuleRadius = 0.35f;//FIXME these should be configurable
-    bool isThereCollision(btDiscreteDynamicsWorld *staticWorld);
+    std::vector<AIGridCollisionQuery *> collisionQueries;//one per job, only alive during generation
 
     glm::vec3 max,min;
     std::vector<AIMovementNode *> visited;
     std::vector<AIMovementNode *> doneNodes;
 
-    AIMovementNode *isAlreadyVisited(const glm::vec3 &position, size_t &indexOf);
+    /**
+     * Index of visited nodes, keyed by x/z cell and y band. Nodes are placed 1 unit apart on x and z starting from
+     * gridOrigin, so a cell holds nodes of one grid column, and only a few of them share a band.
+     */
+    std::unordered_map<uint64_t, std::vector<VisitedEntry>> visitedHash;
+    glm::vec3 gridOrigin;
 
-    AIMovementNode *
-    walkMonster(glm::vec3 walkPoint, btDiscreteDynamicsWorld *staticWorld, const glm::vec3 &min,
-                    const glm::vec3 &max, uint32_t collisionGroup, uint32_t collisionMask);
+    uint64_t getVisitedKey(const glm::vec3 &position, int32_t bandOffset) const;
+
+    VisitedEntry *findVisited(const glm::vec3 &position);
+
+    void addVisited(AIMovementNode *node);
 
-    const AIMovementNode *
-    aStarPath(const AIMovementNode *start, const glm::vec3 &destination, uint32_t maximumNumberOfNodes,
-                  std::vector<glm::vec3> *route);
+    void removeVisited(AIMovementNode *node);
+
+    AIMovementNode *isAlreadyVisited(const glm::vec3 &position);
+
+    /**
+     * Splits [0, queryCount) to chunks, and runs queryRunner for each chunk with a different collision query object.
+     * Returns after all chunks are done. If there is no job system, or too few queries, runs on calling thread.
+     */
+    void runCollisionQueries(JobSystem *jobSystem, size_t queryCount,
+                             const std::function<void(AIGridCollisionQuery &, size_t, size_t)> &queryRunner);
+
+    AIMovementNode *
+    walkMonster(glm::vec3 walkPoint, const glm::vec3 &min, const glm::vec3 &max, JobSystem *jobSystem);
 
     uint32_t getNextID() {
         return nextPossibleIndex++;
@@ -88,13 +100,16 @@ class AIMovementGrid {
 public:
     static constexpr float floatingHeight = 2.0f;
 
-    AIMovementGrid(glm::vec3 startPoint, btDiscreteDynamicsWorld *staticOnlyPhysicsWorld, glm::vec3 min,
-                       glm::vec3 max, uint32_t collisionGroup, uint32_t collisionMask);
+    /**
+     * Generates the grid by walking from start point. Physics queries are run on the job system if it is not null,
+     * the generated grid is the same either way.
+     *
+     * staticOnlyPhysicsWorld is copied for each job, it is not modified.
+     */
+    AIMovementGrid(glm::vec3 startPoint, const btDiscreteDynamicsWorld *staticOnlyPhysicsWorld, glm::vec3 min,
+                       glm::vec3 max, uint32_t collisionGroup, uint32_t collisionMask, JobSystem *jobSystem);
 
     ~AIMovementGrid() {
-        delete rayCallback;
-        delete sharedGhostObject;
-        delete ghostShape;
         for (unsigned int i = 0; i < visited.size(); ++i) {
             delete visited[i];
         }
@@ -105,22 +120,13 @@ public:
 
     }
 
-    bool coursePath(const glm::vec3 &from, const glm::vec3 &to, uint32_t actorId, uint32_t maximumNumberOfNodes,
-                    std::vector<glm::vec3> *route);
-
-    bool coursePath(const glm::vec3 &from, const glm::vec3 &to, uint32_t maximumNumberOfNodes, std::vector<glm::vec3> *route);
-
-    void debugDraw(BulletDebugDrawer *debugDrawer) const;
-
-    bool setProperHeight(glm::vec3 *position, float floatingHeight, float checkHeight,
-                         btDiscreteDynamicsWorld *staticWorld);
-
-    bool serialize(const std::string& fileName);
+    /**
+     * Creates a read only copy of the grid for route queries. The snapshot doesn't reference the grid, so it can
+     * outlive it, and it can be queried from any thread.
+     */
+    std::shared_ptr<const AINavigationSnapshot> createNavigationSnapshot() const;
 
     static AIMovementGrid* deserialize(const std::string& fileName);
-
-    void
-    serializeNode(tinyxml2::XMLDocument &aiGridDocument, tinyxml2::XMLNode *rootNode, const AIMovementNode *nodeToSerialize) const;
 };
 
 
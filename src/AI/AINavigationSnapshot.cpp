@@ -0,0 +1,858 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <tinyxml2.h>
+#include "AINavigationSnapshot.h"
+#include "../Utils/GLMUtils.h"
+#include "../Utils/GLMConverter.h"
+#include "../BulletDebugDrawer.h"
+
+const uint32_t AINavigationSnapshot::NO_NODE;
+const uint32_t AINavigationSnapshot::NEIGHBOUR_COUNT;
+const uint32_t AINavigationSnapshot::BINARY_VERSION;
+const uint32_t AINavigationSnapshot::NOT_IN_HEAP;
+const uint32_t AINavigationSnapshot::NO_ENTRANCE;
+
+AINavigationSnapshot::SearchScratch::SearchScratch(uint32_t nodeCount) :
+        stamps(nodeCount, 0), costs(nodeCount, 0), priorities(nodeCount, 0), from(nodeCount, NO_NODE), depths(nodeCount, 0),
+        heapPositions(nodeCount, NOT_IN_HEAP), heap(nodeCount, NO_NODE) {}
+
+void AINavigationSnapshot::SearchScratch::startSearch() {
+    //heap is emptied by pops, but a search can stop early, so reset what is left
+    for (uint32_t i = 0; i < heapSize; ++i) {
+        heapPositions[heap[i]] = NOT_IN_HEAP;
+    }
+    heapSize = 0;
+    currentStamp++;
+    if (currentStamp == 0) {
+        //wrapped around, old stamps might match now
+        std::fill(stamps.begin(), stamps.end(), 0);
+        currentStamp = 1;
+    }
+}
+
+void AINavigationSnapshot::SearchScratch::reach(uint32_t node, uint32_t fromNode, float cost, float priority, uint32_t depth) {
+    stamps[node] = currentStamp;
+    from[node] = fromNode;
+    costs[node] = cost;
+    priorities[node] = priority;
+    depths[node] = depth;
+}
+
+void AINavigationSnapshot::SearchScratch::pushOrDecrease(uint32_t node) {
+    if (heapPositions[node] == NOT_IN_HEAP) {
+        heap[heapSize] = node;
+        heapPositions[node] = heapSize;
+        heapSize++;
+    }
+    //priority can only decrease, so moving up is enough
+    siftUp(heapPositions[node]);
+}
+
+uint32_t AINavigationSnapshot::SearchScratch::pop() {
+    uint32_t top = heap[0];
+    heapPositions[top] = NOT_IN_HEAP;
+    heapSize--;
+    if (heapSize > 0) {
+        heap[0] = heap[heapSize];
+        heapPositions[heap[0]] = 0;
+        siftDown(0);
+    }
+    return top;
+}
+
+void AINavigationSnapshot::SearchScratch::siftUp(uint32_t heapPosition) {
+    uint32_t node = heap[heapPosition];
+    while (heapPosition > 0) {
+        uint32_t parentPosition = (heapPosition - 1) / 2;
+        uint32_t parent = heap[parentPosition];
+        if (priorities[parent] <= priorities[node]) {
+            break;
+        }
+        heap[heapPosition] = parent;
+        heapPositions[parent] = heapPosition;
+        heapPosition = parentPosition;
+    }
+    heap[heapPosition] = node;
+    heapPositions[node] = heapPosition;
+}
+
+void AINavigationSnapshot::SearchScratch::siftDown(uint32_t heapPosition) {
+    uint32_t node = heap[heapPosition];
+    while (true) {
+        uint32_t childPosition = heapPosition * 2 + 1;
+        if (childPosition >= heapSize) {
+            break;
+        }
+        if (childPosition + 1 < heapSize && priorities[heap[childPosition + 1]] < priorities[heap[childPosition]]) {
+            childPosition++;
+        }
+        uint32_t child = heap[childPosition];
+        if (priorities[node] <= priorities[child]) {
+            break;
+        }
+        heap[heapPosition] = child;
+        heapPositions[child] = heapPosition;
+        heapPosition = childPosition;
+    }
+    heap[heapPosition] = node;
+    heapPositions[node] = heapPosition;
+}
+
+AINavigationSnapshot::AINavigationSnapshot(NodeArrays &&nodeArrays, uint32_t rootNode) : ownedArrays(std::move(nodeArrays)) {
+    nodeCount = (uint32_t)ownedArrays.positions.size();
+    if(nodeCount == 0) {
+        //make sure 0 index is there, even if there is no grid
+        nodeCount = 1;
+    }
+    ownedArrays.resize(nodeCount);
+    positions = ownedArrays.positions.data();
+    movableBits = ownedArrays.movableBits.data();
+    neighbours = ownedArrays.neighbours.data();
+    initialize(rootNode);
+}
+
+AINavigationSnapshot::AINavigationSnapshot(std::unique_ptr<MappedFile> mappedFile, uint32_t nodeCount, uint32_t rootNode)
+        : nodeCount(nodeCount), mappedFile(std::move(mappedFile)) {
+    const uint8_t *positionData = this->mappedFile->getData() + sizeof(BinaryHeader);
+    const uint8_t *movableData = positionData + (size_t)nodeCount * 3 * sizeof(float);
+    const uint8_t *neighbourData = movableData + ((nodeCount + 31) / 32) * sizeof(uint32_t);
+    positions = reinterpret_cast<const glm::vec3 *>(positionData);
+    movableBits = reinterpret_cast<const uint32_t *>(movableData);
+    neighbours = reinterpret_cast<const uint32_t *>(neighbourData);
+    initialize(rootNode);
+}
+
+void AINavigationSnapshot::initialize(uint32_t rootNode) {
+    scratchMutex = SDL_CreateMutex();
+    this->rootNode = rootNode;
+    if(this->rootNode >= nodeCount) {
+        std::cerr << "Navigation snapshot root is not in node list, snapshot will have no route." << std::endl;
+        this->rootNode = NO_NODE;
+    }
+    gridOrigin = positions[this->rootNode];
+
+    //sort nodes by column, so a column is a range of columnNodes
+    std::vector<std::pair<uint64_t, uint32_t>> keyNodePairs;
+    keyNodePairs.reserve(nodeCount);
+    for (uint32_t i = 1; i < nodeCount; ++i) {
+        keyNodePairs.push_back(std::make_pair(getColumnKey(positions[i].x, positions[i].z), i));
+    }
+    std::sort(keyNodePairs.begin(), keyNodePairs.end());
+    columnNodes.reserve(keyNodePairs.size());
+    for (size_t i = 0; i < keyNodePairs.size(); ++i) {
+        if(columnKeys.empty() || columnKeys.back() != keyNodePairs[i].first) {
+            columnKeys.push_back(keyNodePairs[i].first);
+            columnStarts.push_back((uint32_t)columnNodes.size());
+        }
+        columnNodes.push_back(keyNodePairs[i].second);
+    }
+    columnStarts.push_back((uint32_t)columnNodes.size());
+
+    buildHierarchy();
+}
+
+AINavigationSnapshot::~AINavigationSnapshot() {
+    for (size_t i = 0; i < freeScratches.size(); ++i) {
+        delete freeScratches[i];
+    }
+    SDL_DestroyMutex(scratchMutex);
+}
+
+uint64_t AINavigationSnapshot::getColumnKey(float x, float z) const {
+    int32_t cellX = (int32_t)std::floor(x - gridOrigin.x + 0.5f);
+    int32_t cellZ = (int32_t)std::floor(z - gridOrigin.z + 0.5f);
+    return ((uint64_t)(uint32_t)cellX << 32) | (uint64_t)(uint32_t)cellZ;
+}
+
+uint64_t AINavigationSnapshot::getClusterKey(float x, float z) const {
+    int32_t cellX = (int32_t)std::floor(x - gridOrigin.x + 0.5f);
+    int32_t cellZ = (int32_t)std::floor(z - gridOrigin.z + 0.5f);
+    //round towards negative, so cells -1 and 1 are not in the same cluster
+    int32_t clusterX = (cellX >= 0 ? cellX : cellX - NAVIGATION_CLUSTER_SIZE + 1) / NAVIGATION_CLUSTER_SIZE;
+    int32_t clusterZ = (cellZ >= 0 ? cellZ : cellZ - NAVIGATION_CLUSTER_SIZE + 1) / NAVIGATION_CLUSTER_SIZE;
+    return ((uint64_t)(uint32_t)clusterX << 32) | (uint64_t)(uint32_t)clusterZ;
+}
+
+void AINavigationSnapshot::buildHierarchy() {
+    Uint32 buildStartTime = SDL_GetTicks();
+    //clusters are indexed in key order
+    std::vector<uint64_t> nodeClusterKeys(nodeCount, 0);
+    for (uint32_t i = 1; i < nodeCount; ++i) {
+        nodeClusterKeys[i] = getClusterKey(positions[i].x, positions[i].z);
+    }
+    std::vector<uint64_t> clusterKeys(nodeClusterKeys.begin() + 1, nodeClusterKeys.end());
+    std::sort(clusterKeys.begin(), clusterKeys.end());
+    clusterKeys.erase(std::unique(clusterKeys.begin(), clusterKeys.end()), clusterKeys.end());
+    uint32_t clusterCount = (uint32_t)clusterKeys.size();
+    nodeClusters.assign(nodeCount, 0);
+    for (uint32_t i = 1; i < nodeCount; ++i) {
+        nodeClusters[i] = (uint32_t)(std::lower_bound(clusterKeys.begin(), clusterKeys.end(), nodeClusterKeys[i]) - clusterKeys.begin());
+    }
+
+    //edges that cross a cluster border, from the lower cluster to the higher one
+    struct BorderEdge {
+        uint64_t clusterPair;
+        uint32_t node;
+        uint32_t otherNode;
+
+        bool operator<(const BorderEdge &other) const {
+            if (clusterPair != other.clusterPair) {
+                return clusterPair < other.clusterPair;
+            }
+            if (node != other.node) {
+                return node < other.node;
+            }
+            return otherNode < other.otherNode;
+        }
+    };
+    std::vector<BorderEdge> borderEdges;
+    for (uint32_t node = 1; node < nodeCount; ++node) {
+        if (!isMovable(node)) {
+            continue;
+        }
+        for (uint32_t i = 0; i < NEIGHBOUR_COUNT; ++i) {
+            uint32_t neighbour = neighbours[(size_t)node * NEIGHBOUR_COUNT + i];
+            if (neighbour != NO_NODE && isMovable(neighbour) && nodeClusters[node] < nodeClusters[neighbour]) {
+                BorderEdge borderEdge;
+                borderEdge.clusterPair = ((uint64_t)nodeClusters[node] << 32) | nodeClusters[neighbour];
+                borderEdge.node = node;
+                borderEdge.otherNode = neighbour;
+                borderEdges.push_back(borderEdge);
+            }
+        }
+    }
+    std::sort(borderEdges.begin(), borderEdges.end());
+
+    //border nodes that are neighbours of each other form a segment, each segment gets one entrance pair at its middle
+    std::vector<std::pair<uint32_t, uint32_t>> entrancePairs;
+    std::vector<uint32_t> borderNodes;
+    std::vector<uint32_t> segmentParents;
+    std::vector<std::pair<uint32_t, uint32_t>> segmentMembers;//segment root, border node
+    size_t groupBegin = 0;
+    while (groupBegin < borderEdges.size()) {
+        size_t groupEnd = groupBegin;
+        while (groupEnd < borderEdges.size() && borderEdges[groupEnd].clusterPair == borderEdges[groupBegin].clusterPair) {
+            groupEnd++;
+        }
+        //edges are sorted by node, a node can have more than one edge to the other cluster
+        borderNodes.clear();
+        for (size_t i = groupBegin; i < groupEnd; ++i) {
+            if (borderNodes.empty() || borderNodes.back() != borderEdges[i].node) {
+                borderNodes.push_back(borderEdges[i].node);
+            }
+        }
+        segmentParents.resize(borderNodes.size());
+        for (uint32_t i = 0; i < segmentParents.size(); ++i) {
+            segmentParents[i] = i;
+        }
+        auto findSegment = [&segmentParents](uint32_t index) {
+            while (segmentParents[index] != index) {
+                segmentParents[index] = segmentParents[segmentParents[index]];
+                index = segmentParents[index];
+            }
+            return index;
+        };
+        for (uint32_t i = 0; i < borderNodes.size(); ++i) {
+            for (uint32_t j = 0; j < NEIGHBOUR_COUNT; ++j) {
+                uint32_t neighbour = neighbours[(size_t)borderNodes[i] * NEIGHBOUR_COUNT + j];
+                auto neighbourIt = std::lower_bound(borderNodes.begin(), borderNodes.end(), neighbour);
+                if (neighbour != NO_NODE && neighbourIt != borderNodes.end() && *neighbourIt == neighbour) {
+                    segmentParents[findSegment(i)] = findSegment((uint32_t)(neighbourIt - borderNodes.begin()));
+                }
+            }
+        }
+        segmentMembers.clear();
+        for (uint32_t i = 0; i < borderNodes.size(); ++i) {
+            segmentMembers.push_back(std::make_pair(findSegment(i), borderNodes[i]));
+        }
+        //order members of a segment along the border, so the middle one is in the middle of the segment
+        std::sort(segmentMembers.begin(), segmentMembers.end(),
+                  [this](const std::pair<uint32_t, uint32_t> &first, const std::pair<uint32_t, uint32_t> &second) {
+                      if (first.first != second.first) {
+                          return first.first < second.first;
+                      }
+                      const glm::vec3 &firstPosition = positions[first.second];
+                      const glm::vec3 &secondPosition = positions[second.second];
+                      if (firstPosition.x != secondPosition.x) {
+                          return firstPosition.x < secondPosition.x;
+                      }
+                      return firstPosition.z < secondPosition.z;
+                  });
+        size_t segmentBegin = 0;
+        while (segmentBegin < segmentMembers.size()) {
+            size_t segmentEnd = segmentBegin;
+            while (segmentEnd < segmentMembers.size() && segmentMembers[segmentEnd].first == segmentMembers[segmentBegin].first) {
+                segmentEnd++;
+            }
+            uint32_t entranceNode = segmentMembers[segmentBegin + (segmentEnd - segmentBegin) / 2].second;
+            for (size_t i = groupBegin; i < groupEnd; ++i) {
+                if (borderEdges[i].node == entranceNode) {
+                    entrancePairs.push_back(std::make_pair(entranceNode, borderEdges[i].otherNode));
+                    break;
+                }
+            }
+            segmentBegin = segmentEnd;
+        }
+        groupBegin = groupEnd;
+    }
+
+    //entrances are sorted by cluster, so entrances of a cluster are a range
+    std::vector<std::pair<uint32_t, uint32_t>> clusterNodePairs;
+    for (size_t i = 0; i < entrancePairs.size(); ++i) {
+        clusterNodePairs.push_back(std::make_pair(nodeClusters[entrancePairs[i].first], entrancePairs[i].first));
+        clusterNodePairs.push_back(std::make_pair(nodeClusters[entrancePairs[i].second], entrancePairs[i].second));
+    }
+    std::sort(clusterNodePairs.begin(), clusterNodePairs.end());
+    clusterNodePairs.erase(std::unique(clusterNodePairs.begin(), clusterNodePairs.end()), clusterNodePairs.end());
+    nodeEntrances.assign(nodeCount, NO_ENTRANCE);
+    entranceNodes.clear();
+    clusterEntranceStarts.assign(clusterCount + 1, 0);
+    for (size_t i = 0; i < clusterNodePairs.size(); ++i) {
+        nodeEntrances[clusterNodePairs[i].second] = (uint32_t)entranceNodes.size();
+        entranceNodes.push_back(clusterNodePairs[i].second);
+        clusterEntranceStarts[clusterNodePairs[i].first + 1]++;
+    }
+    for (uint32_t i = 0; i < clusterCount; ++i) {
+        clusterEntranceStarts[i + 1] += clusterEntranceStarts[i];
+    }
+
+    //entrance pairs are neighbours, entrances of the same cluster are connected with the cost of the path between them
+    struct EntranceEdge {
+        uint32_t from;
+        uint32_t to;
+        float cost;
+    };
+    std::vector<EntranceEdge> entranceEdges;
+    for (size_t i = 0; i < entrancePairs.size(); ++i) {
+        uint32_t firstEntrance = nodeEntrances[entrancePairs[i].first];
+        uint32_t secondEntrance = nodeEntrances[entrancePairs[i].second];
+        float cost = glm::length(positions[entrancePairs[i].first] - positions[entrancePairs[i].second]);
+        entranceEdges.push_back({firstEntrance, secondEntrance, cost});
+        entranceEdges.push_back({secondEntrance, firstEntrance, cost});
+    }
+    SearchScratch *scratch = acquireScratch();
+    for (uint32_t cluster = 0; cluster < clusterCount; ++cluster) {
+        for (uint32_t entrance = clusterEntranceStarts[cluster]; entrance < clusterEntranceStarts[cluster + 1]; ++entrance) {
+            searchCluster(*scratch, entranceNodes[entrance], NO_NODE, cluster);
+            for (uint32_t other = clusterEntranceStarts[cluster]; other < clusterEntranceStarts[cluster + 1]; ++other) {
+                if (other != entrance && scratch->isReached(entranceNodes[other])) {
+                    entranceEdges.push_back({entrance, other, scratch->costs[entranceNodes[other]]});
+                }
+            }
+        }
+    }
+    releaseScratch(scratch);
+
+    std::sort(entranceEdges.begin(), entranceEdges.end(), [](const EntranceEdge &first, const EntranceEdge &second) {
+        return first.from < second.from;
+    });
+    entranceEdgeStarts.assign(entranceNodes.size() + 1, 0);
+    entranceEdgeTargets.clear();
+    entranceEdgeCosts.clear();
+    for (size_t i = 0; i < entranceEdges.size(); ++i) {
+        entranceEdgeStarts[entranceEdges[i].from + 1]++;
+        entranceEdgeTargets.push_back(entranceEdges[i].to);
+        entranceEdgeCosts.push_back(entranceEdges[i].cost);
+    }
+    for (size_t i = 0; i < entranceNodes.size(); ++i) {
+        entranceEdgeStarts[i + 1] += entranceEdgeStarts[i];
+    }
+    hierarchyBuildTime = SDL_GetTicks() - buildStartTime;
+}
+
+bool AINavigationSnapshot::getColumn(float x, float z, uint32_t &begin, uint32_t &end) const {
+    uint64_t key = getColumnKey(x, z);
+    auto keyIt = std::lower_bound(columnKeys.begin(), columnKeys.end(), key);
+    if(keyIt == columnKeys.end() || *keyIt != key) {
+        return false;
+    }
+    size_t columnIndex = keyIt - columnKeys.begin();
+    begin = columnStarts[columnIndex];
+    end = columnStarts[columnIndex + 1];
+    return true;
+}
+
+AINavigationSnapshot::SearchScratch *AINavigationSnapshot::acquireScratch() const {
+    SearchScratch *scratch = nullptr;
+    SDL_LockMutex(scratchMutex);
+    if(!freeScratches.empty()) {
+        scratch = freeScratches.back();
+        freeScratches.pop_back();
+    }
+    SDL_UnlockMutex(scratchMutex);
+    if(scratch == nullptr) {
+        //each concurrent search creates one once, after that they are reused
+        scratch = new SearchScratch(nodeCount);
+    }
+    return scratch;
+}
+
+void AINavigationSnapshot::releaseScratch(SearchScratch *scratch) const {
+    SDL_LockMutex(scratchMutex);
+    freeScratches.push_back(scratch);
+    SDL_UnlockMutex(scratchMutex);
+}
+
+bool AINavigationSnapshot::setProperHeight(glm::vec3 *position, float floatingHeight) const {
+    uint32_t columnBegin, columnEnd;
+    if(!getColumn(position->x, position->z, columnBegin, columnEnd)) {
+        return false;
+    }
+    //ray test would return the closest ground below the position, find the same from node heights
+    bool found = false;
+    float groundHeight = 0;
+    for (uint32_t i = columnBegin; i < columnEnd; ++i) {
+        float nodeGroundHeight = positions[columnNodes[i]].y - floatingHeight;
+        if(nodeGroundHeight <= position->y && (!found || nodeGroundHeight > groundHeight)) {
+            groundHeight = nodeGroundHeight;
+            found = true;
+        }
+    }
+    if(!found || groundHeight > position->y - 1) {
+        return false;
+    }
+    position->y = groundHeight + floatingHeight;
+    return true;
+}
+
+uint32_t AINavigationSnapshot::aStarPath(SearchScratch &scratch, uint32_t start, const glm::vec3 &destination,
+                                         uint32_t maximumNumberOfNodes, std::vector<glm::vec3> *route,
+                                         bool isFailureLogged) const {
+    scratch.startSearch();
+    scratch.reach(start, NO_NODE, 0, 0, 0);
+    scratch.pushOrDecrease(start);
+
+    uint32_t finalNode = NO_NODE;
+    while (scratch.heapSize > 0) {
+        uint32_t current = scratch.pop();
+        const glm::vec3 &currentPosition = positions[current];
+        if (isPositionCloseEnough(destination, currentPosition)) {
+            finalNode = current;
+            break;
+        }
+
+        if(maximumNumberOfNodes != 0 && scratch.depths[current] >= maximumNumberOfNodes) {
+            //we searched for this depth, but couldn't found the player no need to keep searching
+            break;
+        }
+
+        const uint32_t *currentNeighbours = neighbours + (size_t)current * NEIGHBOUR_COUNT;
+        for (uint32_t i = 0; i < NEIGHBOUR_COUNT; ++i) {
+            uint32_t neighbour = currentNeighbours[i];
+            if (neighbour == NO_NODE || !isMovable(neighbour)) {
+                continue;//if not movable, it means we don't need its child
+            }
+            float movementCost = glm::length(positions[neighbour] - currentPosition);
+            float heuristic = glm::length(destination - positions[neighbour]);
+            float currentCost = scratch.costs[current] + movementCost + heuristic;
+            if (!scratch.isReached(neighbour) || currentCost < scratch.costs[neighbour]) {
+                scratch.reach(neighbour, current, currentCost, currentCost, scratch.depths[current] + 1);
+                scratch.pushOrDecrease(neighbour);
+            }
+        }
+    }
+
+    if (finalNode == NO_NODE) {
+        if (!isFailureLogged) {
+            return finalNode;
+        }
+        std::cerr << "Path search failed, please check the values: " << GLMUtils::vectorToString(positions[start])
+                  << " to " << GLMUtils::vectorToString(destination) << std::endl;
+        return finalNode;
+    }
+    if (route != nullptr && start != finalNode) {
+        route->clear();
+        for (uint32_t routeNode = finalNode; routeNode != start; routeNode = scratch.from[routeNode]) {
+            route->push_back(positions[routeNode]);
+        }
+        std::reverse(route->begin(), route->end());
+    }
+    return finalNode;
+}
+
+bool AINavigationSnapshot::searchCluster(SearchScratch &scratch, uint32_t start, uint32_t goal, uint32_t cluster) const {
+    scratch.startSearch();
+    scratch.reach(start, NO_NODE, 0, 0, 0);
+    scratch.pushOrDecrease(start);
+    while (scratch.heapSize > 0) {
+        uint32_t current = scratch.pop();
+        if (current == goal) {
+            return true;
+        }
+        const glm::vec3 &currentPosition = positions[current];
+        const uint32_t *currentNeighbours = neighbours + (size_t)current * NEIGHBOUR_COUNT;
+        for (uint32_t i = 0; i < NEIGHBOUR_COUNT; ++i) {
+            uint32_t neighbour = currentNeighbours[i];
+            if (neighbour == NO_NODE || !isMovable(neighbour) || nodeClusters[neighbour] != cluster) {
+                continue;
+            }
+            float currentCost = scratch.costs[current] + glm::length(positions[neighbour] - currentPosition);
+            if (!scratch.isReached(neighbour) || currentCost < scratch.costs[neighbour]) {
+                float priority = currentCost;
+                if (goal != NO_NODE) {
+                    priority += glm::length(positions[goal] - positions[neighbour]);
+                }
+                scratch.reach(neighbour, current, currentCost, priority, scratch.depths[current] + 1);
+                scratch.pushOrDecrease(neighbour);
+            }
+        }
+    }
+    return false;
+}
+
+bool AINavigationSnapshot::appendClusterPath(SearchScratch &scratch, uint32_t start, uint32_t goal,
+                                             std::vector<glm::vec3> *route) const {
+    if (!searchCluster(scratch, start, goal, nodeClusters[start])) {
+        return false;
+    }
+    size_t routeBegin = route->size();
+    for (uint32_t routeNode = goal; routeNode != start; routeNode = scratch.from[routeNode]) {
+        route->push_back(positions[routeNode]);
+    }
+    std::reverse(route->begin() + routeBegin, route->end());
+    return true;
+}
+
+bool AINavigationSnapshot::hierarchicalPath(SearchScratch &scratch, uint32_t start, uint32_t goal,
+                                            uint32_t maximumNumberOfNodes, std::vector<glm::vec3> *route) const {
+    uint32_t startCluster = nodeClusters[start];
+    uint32_t goalCluster = nodeClusters[goal];
+
+    //connect start and goal to the entrances of their clusters
+    scratch.startEntranceCosts.clear();
+    searchCluster(scratch, start, NO_NODE, startCluster);
+    for (uint32_t entrance = clusterEntranceStarts[startCluster]; entrance < clusterEntranceStarts[startCluster + 1]; ++entrance) {
+        if (scratch.isReached(entranceNodes[entrance])) {
+            scratch.startEntranceCosts.push_back(std::make_pair(entrance, scratch.costs[entranceNodes[entrance]]));
+        }
+    }
+    scratch.goalEntranceCosts.clear();
+    searchCluster(scratch, goal, NO_NODE, goalCluster);//grid edges are two way, so cost from goal is same with cost to goal
+    for (uint32_t entrance = clusterEntranceStarts[goalCluster]; entrance < clusterEntranceStarts[goalCluster + 1]; ++entrance) {
+        if (scratch.isReached(entranceNodes[entrance])) {
+            scratch.goalEntranceCosts.push_back(std::make_pair(entrance, scratch.costs[entranceNodes[entrance]]));
+        }
+    }
+    if (scratch.startEntranceCosts.empty() || scratch.goalEntranceCosts.empty()) {
+        return false;
+    }
+
+    //search entrance graph, using the same scratch. Start and goal are placed after the entrances
+    const uint32_t abstractStart = (uint32_t)entranceNodes.size();
+    const uint32_t abstractGoal = abstractStart + 1;
+    const glm::vec3 &goalPosition = positions[goal];
+    auto reachEntrance = [&](uint32_t current, uint32_t next, float edgeCost) {
+        float currentCost = scratch.costs[current] + edgeCost;
+        if (!scratch.isReached(next) || currentCost < scratch.costs[next]) {
+            float heuristic = 0;
+            if (next != abstractGoal) {
+                heuristic = glm::length(goalPosition - positions[entranceNodes[next]]);
+            }
+            scratch.reach(next, current, currentCost, currentCost + heuristic, 0);
+            scratch.pushOrDecrease(next);
+        }
+    };
+    scratch.startSearch();
+    scratch.reach(abstractStart, NO_NODE, 0, 0, 0);
+    scratch.pushOrDecrease(abstractStart);
+    bool found = false;
+    while (scratch.heapSize > 0) {
+        uint32_t current = scratch.pop();
+        if (current == abstractGoal) {
+            found = true;
+            break;
+        }
+        if (current == abstractStart) {
+            for (size_t i = 0; i < scratch.startEntranceCosts.size(); ++i) {
+                reachEntrance(current, scratch.startEntranceCosts[i].first, scratch.startEntranceCosts[i].second);
+            }
+            continue;
+        }
+        for (uint32_t edge = entranceEdgeStarts[current]; edge < entranceEdgeStarts[current + 1]; ++edge) {
+            reachEntrance(current, entranceEdgeTargets[edge], entranceEdgeCosts[edge]);
+        }
+        if (nodeClusters[entranceNodes[current]] == goalCluster) {
+            for (size_t i = 0; i < scratch.goalEntranceCosts.size(); ++i) {
+                if (scratch.goalEntranceCosts[i].first == current) {
+                    reachEntrance(current, abstractGoal, scratch.goalEntranceCosts[i].second);
+                }
+            }
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    scratch.abstractPath.clear();
+    for (uint32_t abstractNode = abstractGoal; abstractNode != abstractStart; abstractNode = scratch.from[abstractNode]) {
+        scratch.abstractPath.push_back(abstractNode);
+    }
+    std::reverse(scratch.abstractPath.begin(), scratch.abstractPath.end());
+
+    //refine only the beginning of the plan, rest is refined by the next requests while actor walks
+    route->clear();
+    uint32_t previousNode = start;
+    for (size_t i = 0; i < scratch.abstractPath.size(); ++i) {
+        if (maximumNumberOfNodes != 0 && route->size() >= maximumNumberOfNodes) {
+            break;
+        }
+        uint32_t nextNode = goal;
+        if (scratch.abstractPath[i] != abstractGoal) {
+            nextNode = entranceNodes[scratch.abstractPath[i]];
+        }
+        if (nextNode == previousNode) {
+            continue;//start itself was an entrance
+        }
+        if (nodeClusters[nextNode] != nodeClusters[previousNode]) {
+            //entrances in different clusters are only connected if they are neighbours
+            route->push_back(positions[nextNode]);
+        } else if (!appendClusterPath(scratch, previousNode, nextNode, route)) {
+            std::cerr << "Navigation hierarchy has an entrance cost without a path, route can't be refined." << std::endl;
+            return false;
+        }
+        previousNode = nextNode;
+    }
+    if (maximumNumberOfNodes != 0 && route->size() > maximumNumberOfNodes) {
+        route->resize(maximumNumberOfNodes);
+    }
+    return true;
+}
+
+uint32_t AINavigationSnapshot::findNode(const glm::vec3 &position) const {
+    uint32_t columnBegin, columnEnd;
+    if(getColumn(position.x, position.z, columnBegin, columnEnd)) {
+        for (uint32_t i = columnBegin; i < columnEnd; ++i) {
+            if(isMovable(columnNodes[i]) && isPositionCloseEnough(position, positions[columnNodes[i]])) {
+                return columnNodes[i];
+            }
+        }
+    }
+    return NO_NODE;
+}
+
+AINavigationSnapshot::RouteResult AINavigationSnapshot::coursePath(const RouteRequest &request) const {
+    RouteResult result;
+    if(rootNode == NO_NODE) {
+        return result;
+    }
+
+    //first search for from node. If hint is still valid, no search is needed
+    uint32_t fromNode = NO_NODE;
+    if(request.startNodeHint != NO_NODE && request.startNodeHint < nodeCount &&
+       isPositionCloseEnough(request.from, positions[request.startNodeHint])) {
+        fromNode = request.startNodeHint;
+    } else {
+        fromNode = findNode(request.from);
+    }
+
+    SearchScratch *scratch = acquireScratch();
+    if(fromNode == NO_NODE) {
+        //actor is not on a grid cell, search where the actor is, starting from where it was last
+        uint32_t searchStart = rootNode;
+        if(request.startNodeHint != NO_NODE && request.startNodeHint < nodeCount) {
+            searchStart = request.startNodeHint;
+        }
+        fromNode = aStarPath(*scratch, searchStart, request.from, 0, nullptr);//0 means search whole map
+        if (fromNode == NO_NODE) {
+            std::cerr << "new from node can't be found, this means snap distance is too small." << std::endl;
+            releaseScratch(scratch);
+            return result;
+        }
+    }
+
+    result.lastNode = fromNode;
+
+    //routes to other clusters are planned on entrances, entrance graph search needs 2 more slots in scratch
+    uint32_t toNode = findNode(request.to);
+    bool isRouteFound;
+    if (toNode != NO_NODE && nodeClusters[toNode] != nodeClusters[fromNode] && entranceNodes.size() + 2 <= nodeCount) {
+        //close ends are searched on the grid first, going through entrances would be a detour for them
+        uint32_t flatSearchDepth = NAVIGATION_FLAT_SEARCH_DEPTH;
+        if (request.maximumNumberOfNodes != 0) {
+            flatSearchDepth = std::min(flatSearchDepth, request.maximumNumberOfNodes);
+        }
+        //each step moves one cell on x and z at most, so grid search can't succeed if ends are further apart
+        glm::vec3 distance = glm::abs(positions[toNode] - positions[fromNode]);
+        isRouteFound = std::max(distance.x, distance.z) <= flatSearchDepth &&
+                       aStarPath(*scratch, fromNode, request.to, flatSearchDepth, &result.route, false) != NO_NODE;
+        if (!isRouteFound) {
+            isRouteFound = hierarchicalPath(*scratch, fromNode, toNode, request.maximumNumberOfNodes, &result.route);
+        }
+    } else {
+        isRouteFound = aStarPath(*scratch, fromNode, request.to, request.maximumNumberOfNodes, &result.route) != NO_NODE;
+    }
+    if (!isRouteFound) {
+        std::cerr << "Destination can't be reached, most likely player moved to somewhere AI can't." << std::endl;
+        result.route.clear();
+    } else {
+        result.found = true;
+    }
+    releaseScratch(scratch);
+    return result;
+}
+
+void AINavigationSnapshot::debugDraw(BulletDebugDrawer *debugDrawer) const {
+    glm::vec3 toColor, fromColor;
+    for (uint32_t i = 1; i < nodeCount; i++) {
+        uint32_t neighbourCount = 4; //if not an edge, just draw first 4, the last 4 should be rendered by the neighbours
+        if (isMovable(i)) {
+            fromColor = glm::vec3(1, 1, 1);
+        } else {
+            fromColor = glm::vec3(1, 0, 0);
+            neighbourCount = NEIGHBOUR_COUNT; //if on an edge, neighbours will not be able to draw rest, draw all.
+        }
+        for (uint32_t j = 0; j < neighbourCount; ++j) {
+            uint32_t neighbour = neighbours[i * NEIGHBOUR_COUNT + j];
+            if (neighbour != NO_NODE) {
+                if (isMovable(neighbour)) {
+                    toColor = glm::vec3(1, 1, 1);
+                } else {
+                    toColor = glm::vec3(1, 0, 0);
+                }
+                debugDrawer->drawLine(GLMConverter::GLMToBlt(positions[i]),
+                                      GLMConverter::GLMToBlt(positions[neighbour]),
+                                      GLMConverter::GLMToBlt(fromColor), GLMConverter::GLMToBlt(toColor));
+            }
+        }
+    }
+}
+
+bool AINavigationSnapshot::serialize(const std::string &fileName) const {
+    std::ofstream outputFile(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outputFile.is_open()) {
+        std::cerr << "ERROR saving AI navigation file " << fileName << ", can't open file." << std::endl;
+        return false;
+    }
+    BinaryHeader header;
+    memcpy(header.magic, "LNAV", 4);
+    header.version = BINARY_VERSION;
+    header.nodeCount = nodeCount;
+    header.rootNode = rootNode;
+    outputFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    //arrays are already in file layout
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed for AI navigation file");
+    outputFile.write(reinterpret_cast<const char *>(positions), (size_t)nodeCount * sizeof(glm::vec3));
+    outputFile.write(reinterpret_cast<const char *>(movableBits), ((nodeCount + 31) / 32) * sizeof(uint32_t));
+    outputFile.write(reinterpret_cast<const char *>(neighbours), (size_t)nodeCount * NEIGHBOUR_COUNT * sizeof(uint32_t));
+    if (!outputFile.good()) {
+        std::cerr << "ERROR saving AI navigation file " << fileName << ", write failed." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const AINavigationSnapshot> AINavigationSnapshot::deserialize(const std::string &fileName) {
+    std::unique_ptr<MappedFile> mappedFile(new MappedFile(fileName));
+    if (!mappedFile->isValid()) {
+        return nullptr;
+    }
+    if (mappedFile->getSize() < sizeof(BinaryHeader)) {
+        std::cerr << fileName << " is not a valid AI navigation file." << std::endl;
+        return nullptr;
+    }
+    BinaryHeader header;
+    memcpy(&header, mappedFile->getData(), sizeof(header));
+    if (memcmp(header.magic, "LNAV", 4) != 0 || header.version != BINARY_VERSION) {
+        std::cerr << fileName << " is not a valid AI navigation file, or its version is not supported." << std::endl;
+        return nullptr;
+    }
+    uint32_t nodeCount = header.nodeCount;
+    size_t expectedSize = sizeof(BinaryHeader) + (size_t)nodeCount * 3 * sizeof(float) +
+                          ((nodeCount + 31) / 32) * sizeof(uint32_t) + (size_t)nodeCount * NEIGHBOUR_COUNT * sizeof(uint32_t);
+    if (nodeCount == 0 || mappedFile->getSize() != expectedSize || header.rootNode >= nodeCount) {
+        std::cerr << "AI navigation file " << fileName << " is corrupted, size doesn't match node count." << std::endl;
+        return nullptr;
+    }
+
+    //constructor builds the hierarchy and searches trust the arrays, so validate them before using
+    const uint8_t *positionData = mappedFile->getData() + sizeof(BinaryHeader);
+    const uint8_t *neighbourData = positionData + (size_t)nodeCount * 3 * sizeof(float) + ((nodeCount + 31) / 32) * sizeof(uint32_t);
+    for (size_t i = 0; i < (size_t)nodeCount * 3; ++i) {
+        float value;
+        memcpy(&value, positionData + i * sizeof(float), sizeof(float));
+        if (!std::isfinite(value)) {
+            std::cerr << "AI navigation file " << fileName << " is corrupted, node " << i / 3 << " has invalid position." << std::endl;
+            return nullptr;
+        }
+    }
+    for (size_t i = 0; i < (size_t)nodeCount * NEIGHBOUR_COUNT; ++i) {
+        uint32_t neighbour;
+        memcpy(&neighbour, neighbourData + i * sizeof(uint32_t), sizeof(uint32_t));
+        if (neighbour >= nodeCount) {
+            std::cerr << "AI navigation file " << fileName << " is corrupted, node " << i / NEIGHBOUR_COUNT << " has invalid neighbour." << std::endl;
+            return nullptr;
+        }
+    }
+    return std::shared_ptr<const AINavigationSnapshot>(new AINavigationSnapshot(std::move(mappedFile), nodeCount, header.rootNode));
+}
+
+bool AINavigationSnapshot::serializeXML(const std::string &fileName) const {
+    if (rootNode != 1) {
+        //xml format has no root information, it assumes node with ID 1 is root
+        std::cerr << "AI navigation snapshot root is not the first node, it can't be saved as xml." << std::endl;
+        return false;
+    }
+    tinyxml2::XMLDocument aiGridDocument;
+    tinyxml2::XMLNode * rootElement = aiGridDocument.NewElement("AIWalkGrid");
+    aiGridDocument.InsertFirstChild(rootElement);
+
+    tinyxml2::XMLElement* currentElement = aiGridDocument.NewElement("Name");
+    currentElement->SetText(fileName.c_str());
+    rootElement->InsertEndChild(currentElement);
+
+    currentElement = aiGridDocument.NewElement("MaximumNodeID");
+    currentElement->SetText(nodeCount);
+    rootElement->InsertEndChild(currentElement);
+
+    for (uint32_t i = 0; i < nodeCount; ++i) {
+        tinyxml2::XMLElement* nodeElement = aiGridDocument.NewElement("Node");
+
+        currentElement = aiGridDocument.NewElement("ID");
+        currentElement->SetText(std::to_string(i).c_str());
+        nodeElement->InsertEndChild(currentElement);
+
+        currentElement = aiGridDocument.NewElement("Mv");
+        currentElement->SetText((isMovable(i) ? "True" : "False"));
+        nodeElement->InsertEndChild(currentElement);
+
+        currentElement = aiGridDocument.NewElement("Ps");
+        {
+            tinyxml2::XMLElement *positionXElement = aiGridDocument.NewElement("X");
+            positionXElement->SetText(std::to_string(positions[i].x).c_str());
+            currentElement->InsertEndChild(positionXElement);
+
+            tinyxml2::XMLElement *positionYElement = aiGridDocument.NewElement("Y");
+            positionYElement->SetText(std::to_string(positions[i].y).c_str());
+            currentElement->InsertEndChild(positionYElement);
+
+            tinyxml2::XMLElement *positionZElement = aiGridDocument.NewElement("Z");
+            positionZElement->SetText(std::to_string(positions[i].z).c_str());
+            currentElement->InsertEndChild(positionZElement);
+        }
+        nodeElement->InsertEndChild(currentElement);
+
+        for (int j = 0; j < 9; ++j) {
+            if(j == 4) {
+                continue;//4 is self
+            }
+            currentElement = aiGridDocument.NewElement("Nb");//neighbour
+            currentElement->SetAttribute("Ps", std::to_string(j).c_str());//position
+            currentElement->SetText(std::to_string(neighbours[i * NEIGHBOUR_COUNT + getNeighbourSlot(j)]).c_str());//NO_NODE is 0, same as xml null
+            nodeElement->InsertEndChild(currentElement);
+        }
+        rootElement->InsertEndChild(nodeElement);
+    }
+
+    tinyxml2::XMLError eResult = aiGridDocument.SaveFile(fileName.c_str());
+    if(eResult != tinyxml2::XML_SUCCESS) {
+        std::cerr  << "ERROR saving AI grid: " << eResult << std::endl;
+        return false;
+    }
+    return true;
+}
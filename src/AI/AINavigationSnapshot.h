@@ -0,0 +1,301 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_AINAVIGATIONSNAPSHOT_H
+#define LIMONENGINE_AINAVIGATIONSNAPSHOT_H
+
+
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <SDL2/SDL.h>
+
+#include "../Utils/MappedFile.h"
+
+class BulletDebugDrawer;
+
+//bigger than sqrt(3)/2
+//avoiding sqrt
+#define GRID_SNAP_DISTANCE (0.8f * 0.8f)
+
+#define NAVIGATION_CLUSTER_SIZE 16 //in grid cells, for each of x and z
+#define NAVIGATION_FLAT_SEARCH_DEPTH (2 * NAVIGATION_CLUSTER_SIZE) //routes to other clusters within this many nodes are searched on the grid first
+
+/**
+ * Read only copy of the AI walk grid, that route queries run on.
+ *
+ * Nodes are kept as arrays indexed by node, one array per attribute, and reference neighbours by index. Node heights
+ * are computed while the grid is generated, so queries don't need the physics world. When loaded from binary file, the
+ * arrays point to the mapped file directly.
+ *
+ * Routes between different clusters are planned hierarchically (HPA*). Grid is divided to square clusters, and nodes
+ * that connect neighbouring clusters are entrances. Costs between entrances of the same cluster are computed on
+ * construction, and long routes are planned on the small entrance graph first, then refined on the grid.
+ *
+ * Nothing is changed after construction, so any number of threads can query the same snapshot at the same time. State
+ * that belongs to an actor, like the last node it was found, is passed with the request and returned with the result
+ * instead of kept here.
+ */
+class AINavigationSnapshot {
+public:
+    static const uint32_t NO_NODE = 0;
+    static const uint32_t NEIGHBOUR_COUNT = 8;
+
+    struct RouteRequest {
+        glm::vec3 from;
+        glm::vec3 to;
+        uint32_t maximumNumberOfNodes = 0;//0 means search whole map
+        uint32_t startNodeHint = NO_NODE;//lastNode of the previous result for the same actor, NO_NODE if there is none
+    };
+
+    struct RouteResult {
+        std::vector<glm::vec3> route;//in walking order, starting node not included
+        uint32_t lastNode = NO_NODE;//node the actor is found at, should be passed as hint with the next request
+        bool found = false;
+    };
+
+    /**
+     * Arrays a snapshot is built from. Index 0 is the empty node, so NO_NODE can be used as null.
+     */
+    struct NodeArrays {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> movableBits;//bit i of word i/32 is set if node i is movable
+        std::vector<uint32_t> neighbours;//NEIGHBOUR_COUNT per node, NO_NODE if there is no neighbour
+
+        void resize(uint32_t nodeCount) {
+            positions.resize(nodeCount, glm::vec3(0, 0, 0));
+            movableBits.resize((nodeCount + 31) / 32, 0);
+            neighbours.resize(nodeCount * NEIGHBOUR_COUNT, NO_NODE);
+        }
+
+        void setMovable(uint32_t node, bool isMovable) {
+            if (isMovable) {
+                movableBits[node / 32] |= (1u << (node % 32));
+            } else {
+                movableBits[node / 32] &= ~(1u << (node % 32));
+            }
+        }
+    };
+
+    /**
+     * AIMovementNode keeps 9 neighbours with self at 4, snapshot skips self.
+     * @return neighbour slot for AIMovementNode neighbour index, it must not be 4
+     */
+    static uint32_t getNeighbourSlot(int neighbourIndex) {
+        return (uint32_t) (neighbourIndex < 4 ? neighbourIndex : neighbourIndex - 1);
+    }
+
+private:
+    /**
+     * Binary file layout, all values little endian:
+     *
+     * BinaryHeader
+     * float    positions[nodeCount * 3]
+     * uint32_t movableBits[(nodeCount + 31) / 32]
+     * uint32_t neighbours[nodeCount * 8]
+     *
+     * Header is 16 bytes and all arrays hold 4 byte values, so every array is aligned when the file is mapped.
+     */
+    struct BinaryHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t nodeCount;//including the empty node
+        uint32_t rootNode;
+    };
+
+    static const uint32_t BINARY_VERSION = 1;
+    static const uint32_t NOT_IN_HEAP = 0xFFFFFFFF;
+    static const uint32_t NO_ENTRANCE = 0xFFFFFFFF;
+
+    /**
+     * Per search state, sized for the whole graph once and reused. Values of a node are only valid if its stamp is
+     * the current search, so starting a search doesn't need clearing the arrays.
+     */
+    struct SearchScratch {
+        uint32_t currentStamp = 0;
+        std::vector<uint32_t> stamps;
+        std::vector<float> costs;
+        std::vector<float> priorities;
+        std::vector<uint32_t> from;
+        std::vector<uint32_t> depths;
+        std::vector<uint32_t> heapPositions;
+        std::vector<uint32_t> heap;//binary min heap of nodes, ordered by priorities
+        uint32_t heapSize = 0;
+
+        //hierarchical search state, these are small and only their capacity is reused
+        std::vector<std::pair<uint32_t, float>> startEntranceCosts;//entrance -> cost from start
+        std::vector<std::pair<uint32_t, float>> goalEntranceCosts;//entrance -> cost to goal
+        std::vector<uint32_t> abstractPath;
+
+        explicit SearchScratch(uint32_t nodeCount);
+
+        void startSearch();
+
+        bool isReached(uint32_t node) const {
+            return stamps[node] == currentStamp;
+        }
+
+        void reach(uint32_t node, uint32_t fromNode, float cost, float priority, uint32_t depth);
+
+        void pushOrDecrease(uint32_t node);
+
+        uint32_t pop();
+
+        void siftUp(uint32_t heapPosition);
+
+        void siftDown(uint32_t heapPosition);
+    };
+
+    uint32_t nodeCount = 0;
+    const glm::vec3 *positions = nullptr;
+    const uint32_t *movableBits = nullptr;
+    const uint32_t *neighbours = nullptr;
+
+    NodeArrays ownedArrays;//empty if arrays are mapped
+    std::unique_ptr<MappedFile> mappedFile;
+
+    uint32_t rootNode = NO_NODE;
+    glm::vec3 gridOrigin;//grid nodes are placed at 1 unit steps on x and z starting from here
+
+    //x/z cell -> nodes at that cell on any height. Nodes of columnKeys[i] are columnNodes[columnStarts[i], columnStarts[i+1])
+    std::vector<uint64_t> columnKeys;
+    std::vector<uint32_t> columnStarts;
+    std::vector<uint32_t> columnNodes;
+
+    //hierarchy. Entrances are sorted by cluster, and edges by their source entrance
+    std::vector<uint32_t> nodeClusters;//node -> cluster
+    std::vector<uint32_t> nodeEntrances;//node -> entrance, NO_ENTRANCE if node is not an entrance
+    std::vector<uint32_t> entranceNodes;//entrance -> node
+    std::vector<uint32_t> clusterEntranceStarts;//entrances of cluster i are [clusterEntranceStarts[i], clusterEntranceStarts[i+1])
+    std::vector<uint32_t> entranceEdgeStarts;//edges of entrance i are [entranceEdgeStarts[i], entranceEdgeStarts[i+1])
+    std::vector<uint32_t> entranceEdgeTargets;
+    std::vector<float> entranceEdgeCosts;
+    uint32_t hierarchyBuildTime = 0;//ms
+
+    mutable SDL_mutex *scratchMutex;
+    mutable std::vector<SearchScratch *> freeScratches;
+
+    AINavigationSnapshot(std::unique_ptr<MappedFile> mappedFile, uint32_t nodeCount, uint32_t rootNode);
+
+    void initialize(uint32_t rootNode);
+
+    bool inline isPositionCloseEnough(const glm::vec3 &position1, const glm::vec3 &position2) const {
+        return (glm::length2(position1 - position2) < GRID_SNAP_DISTANCE);
+    }
+
+    bool isMovable(uint32_t node) const {
+        return ((movableBits[node / 32] >> (node % 32)) & 1u) != 0;
+    }
+
+    uint64_t getColumnKey(float x, float z) const;
+
+    uint64_t getClusterKey(float x, float z) const;
+
+    void buildHierarchy();
+
+    /**
+     * Searches inside a single cluster, from start. If goal is NO_NODE, all nodes of the cluster that are reachable are
+     * searched, so scratch has the costs from start to all of them.
+     * @return true if goal is reached
+     */
+    bool searchCluster(SearchScratch &scratch, uint32_t start, uint32_t goal, uint32_t cluster) const;
+
+    /**
+     * Searches inside start's cluster, and appends the path to goal to route. start is not appended.
+     */
+    bool appendClusterPath(SearchScratch &scratch, uint32_t start, uint32_t goal, std::vector<glm::vec3> *route) const;
+
+    /**
+     * Plans on the entrance graph, then refines the plan until route has maximumNumberOfNodes nodes, 0 means whole
+     * route. Start and goal must be in different clusters.
+     */
+    bool hierarchicalPath(SearchScratch &scratch, uint32_t start, uint32_t goal, uint32_t maximumNumberOfNodes,
+                          std::vector<glm::vec3> *route) const;
+
+    /**
+     * @return movable node close enough to position, NO_NODE if there is none
+     */
+    uint32_t findNode(const glm::vec3 &position) const;
+
+    /**
+     * @return false if there is no node at the column of x/z
+     */
+    bool getColumn(float x, float z, uint32_t &begin, uint32_t &end) const;
+
+    SearchScratch *acquireScratch() const;
+
+    void releaseScratch(SearchScratch *scratch) const;
+
+    uint32_t aStarPath(SearchScratch &scratch, uint32_t start, const glm::vec3 &destination, uint32_t maximumNumberOfNodes,
+                       std::vector<glm::vec3> *route, bool isFailureLogged = true) const;
+
+public:
+    /**
+     * @param nodeArrays node arrays, index 0 must be an empty node
+     * @param rootNode index of the node grid generation started from
+     */
+    AINavigationSnapshot(NodeArrays &&nodeArrays, uint32_t rootNode);
+
+    ~AINavigationSnapshot();
+
+    AINavigationSnapshot(const AINavigationSnapshot &) = delete;
+    AINavigationSnapshot &operator=(const AINavigationSnapshot &) = delete;
+
+    /**
+     * Finds the ground under position using precomputed node heights, and moves position to floating height above it.
+     * Same contract with AIGridCollisionQuery::setProperHeight with unlimited check height, but without a ray test.
+     *
+     * @return false if there is no node under position
+     */
+    bool setProperHeight(glm::vec3 *position, float floatingHeight) const;
+
+    /**
+     * Finds route from request.from to request.to. If both ends are in the same cluster, route is searched on the grid,
+     * and search gives up after maximumNumberOfNodes depth. Otherwise a grid search limited to NAVIGATION_FLAT_SEARCH_DEPTH
+     * is tried first, because routes through entrances can be longer for close ends. If that fails, it is planned
+     * hierarchically, and only the first maximumNumberOfNodes nodes of the route are returned, the rest is expected to be
+     * requested as actor walks.
+     */
+    RouteResult coursePath(const RouteRequest &request) const;
+
+    size_t getEntranceCount() const {
+        return entranceNodes.size();
+    }
+
+    size_t getClusterCount() const {
+        return clusterEntranceStarts.empty() ? 0 : clusterEntranceStarts.size() - 1;
+    }
+
+    uint32_t getHierarchyBuildTime() const {
+        return hierarchyBuildTime;
+    }
+
+    size_t getNodeCount() const {
+        return nodeCount - 1;
+    }
+
+    void debugDraw(BulletDebugDrawer *debugDrawer) const;
+
+    /**
+     * Writes the snapshot in binary format, that can be loaded with deserialize.
+     */
+    bool serialize(const std::string &fileName) const;
+
+    /**
+     * Loads a snapshot written by serialize. File is memory mapped, and the snapshot uses the mapped arrays directly.
+     * @return nullptr if file is missing or invalid
+     */
+    static std::shared_ptr<const AINavigationSnapshot> deserialize(const std::string &fileName);
+
+    /**
+     * Writes the snapshot in AI walk grid xml format, that can be loaded with AIMovementGrid::deserialize.
+     */
+    bool serializeXML(const std::string &fileName) const;
+};
+
+
+#endif //LIMONENGINE_AINAVIGATIONSNAPSHOT_H
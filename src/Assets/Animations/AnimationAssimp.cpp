@@ -5,33 +5,55 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <memory>
+#include <algorithm>
 #include "AnimationAssimp.h"
 #include "AnimationNode.h"
 
 
 
-//FIXME there must be a better way then is found.
-//FIXME requiring node name should not be a thing
 bool AnimationAssimp::calculateTransform(const std::string& nodeName, float time, Transformation& transformation) const {
+    glm::vec3 translate, scale;
+    glm::quat orientation;
+    if (!calculateChannelTransform(getChannelIndex(nodeName), time, translate, scale, orientation, nullptr)) {
+        return false;
+    }
+    transformation.setScale(scale);
+    transformation.setOrientation(orientation);
+    transformation.setTranslate(translate);
+    return true;
+}
+
+int32_t AnimationAssimp::getChannelIndex(const std::string &nodeName) const {
+    auto channelIt = channelIndexes.find(nodeName);
+    if (channelIt == channelIndexes.end()) { //if the bone has no animation, it can happen
+        return -1;
+    }
+    return channelIt->second;
+}
+
+bool AnimationAssimp::calculateChannelTransform(int32_t channelIndex, float time, glm::vec3 &translate, glm::vec3 &scale,
+                                                glm::quat &orientation, AnimationNode::Cursor *cursor) const {
     bool status = false;
-    if (nodes.find(nodeName) == nodes.end()) { //if the bone has no animation, it can happen
+    if (channelIndex < 0 || (size_t)channelIndex >= channels.size()) {
         return status;
     }
     status = true;
-    AnimationNode *nodeAnimation = nodes.at(nodeName);
+    const CompressedAnimationNode &nodeAnimation = channels[channelIndex];
 
-    transformation.setScale(nodeAnimation->getScalingVector(time));
-    transformation.setOrientation(nodeAnimation->getRotationQuat(time));
-    transformation.setTranslate(nodeAnimation->getPositionVector(time));
+    scale = nodeAnimation.getScalingVector(time, cursor);
+    orientation = nodeAnimation.getRotationQuat(time, cursor);
+    translate = nodeAnimation.getPositionVector(time, cursor);
     return status;
 }
 
-AnimationAssimp::AnimationAssimp(aiAnimation *assimpAnimation) {
+AnimationAssimp::AnimationAssimp(aiAnimation *assimpAnimation, const CompressedAnimationNode::Tolerances &tolerances) {
     duration = assimpAnimation->mDuration;
     ticksPerSecond = assimpAnimation->mTicksPerSecond;
-    //create and attach AnimationNodes
+    //create AnimationNodes, and attach their compressed versions
+    channels.reserve(assimpAnimation->mNumChannels);
     for (unsigned int j = 0; j < assimpAnimation->mNumChannels; ++j) {
-        AnimationNode *node = new AnimationNode();
+        std::unique_ptr<AnimationNode> node = std::make_unique<AnimationNode>();
         for (unsigned int k = 0; k < assimpAnimation->mChannels[j]->mNumPositionKeys; ++k) {
             node->translates.push_back(glm::vec3(
                     assimpAnimation->mChannels[j]->mPositionKeys[k].mValue.x,
@@ -56,7 +78,16 @@ AnimationAssimp::AnimationAssimp(aiAnimation *assimpAnimation) {
                     assimpAnimation->mChannels[j]->mRotationKeys[k].mValue.z));
             node->rotationTimes.push_back(assimpAnimation->mChannels[j]->mRotationKeys[k].mTime);
         }
-        nodes[assimpAnimation->mChannels[j]->mNodeName.C_Str()] = node;
+        channelIndexes[assimpAnimation->mChannels[j]->mNodeName.C_Str()] = (int32_t)channels.size();
+        channels.push_back(CompressedAnimationNode(*node, tolerances));
+
+        float translateError, rotationError, scaleError;
+        channels.back().measureError(*node, translateError, rotationError, scaleError);
+        maximumTranslateError = std::max(maximumTranslateError, translateError);
+        maximumRotationError = std::max(maximumRotationError, rotationError);
+        maximumScaleError = std::max(maximumScaleError, scaleError);
+        uncompressedSize += CompressedAnimationNode::getMemorySize(*node);
+        compressedSize += channels.back().getMemorySize();
     }
 
     //validate
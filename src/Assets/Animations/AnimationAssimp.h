@@ -12,19 +12,31 @@
 #include <unordered_map>
 #include <tinyxml2.h>
 #include "AnimationInterface.h"
-
-class AnimationNode;
+#include "CompressedAnimationNode.h"
 
 class AnimationAssimp : public AnimationInterface {
     float ticksPerSecond;
     float duration;
-    //This map keeps the animations for node(bone)
-    std::unordered_map<std::string, AnimationNode*> nodes;
+    //animations for each node(bone), and the channel index of nodes
+    std::vector<CompressedAnimationNode> channels;
+    std::unordered_map<std::string, int32_t> channelIndexes;
+
+    //compression statistics, collected at load
+    size_t uncompressedSize = 0;
+    size_t compressedSize = 0;
+    float maximumTranslateError = 0.0f;
+    float maximumRotationError = 0.0f;
+    float maximumScaleError = 0.0f;
 public:
-    AnimationAssimp(aiAnimation *assimpAnimation);
+    AnimationAssimp(aiAnimation *assimpAnimation, const CompressedAnimationNode::Tolerances &tolerances);
 
     bool calculateTransform(const std::string& nodeName, float time, Transformation& transformation) const;
 
+    int32_t getChannelIndex(const std::string& nodeName) const;
+
+    bool calculateChannelTransform(int32_t channelIndex, float time, glm::vec3& translate, glm::vec3& scale,
+                                   glm::quat& orientation, AnimationNode::Cursor *cursor) const;
+
     float getTicksPerSecond() const {
         return ticksPerSecond;
     }
@@ -32,6 +44,22 @@ public:
     float getDuration() const {
         return duration;
     }
+
+    /**
+     * @param uncompressedSize bytes the animation would use with full precision keys
+     * @param compressedSize bytes it uses
+     * @param translateError maximum local translate error of any channel, in model units
+     * @param rotationError maximum local rotation error of any channel, in radians
+     * @param scaleError maximum local scale error of any channel
+     */
+    void getCompressionStatistics(size_t &uncompressedSize, size_t &compressedSize, float &translateError,
+                                  float &rotationError, float &scaleError) const {
+        uncompressedSize = this->uncompressedSize;
+        compressedSize = this->compressedSize;
+        translateError = this->maximumTranslateError;
+        rotationError = this->maximumRotationError;
+        scaleError = this->maximumScaleError;
+    }
 };
 
 
@@ -15,3 +15,10 @@ bool AnimationAssimpSection::calculateTransform(const std::string& nodeName, flo
     time = startTime + time;
     return baseAnimation->calculateTransform(nodeName, time, transformation);
 }
+
+bool AnimationAssimpSection::calculateChannelTransform(int32_t channelIndex, float time, glm::vec3 &translate,
+                                                       glm::vec3 &scale, glm::quat &orientation,
+                                                       AnimationNode::Cursor *cursor) const {
+    time = startTime + time;
+    return baseAnimation->calculateChannelTransform(channelIndex, time, translate, scale, orientation, cursor);
+}
@@ -18,6 +18,13 @@ public:
 
     bool calculateTransform(const std::string& nodeName, float time, Transformation& transformation) const;
 
+    int32_t getChannelIndex(const std::string& nodeName) const {
+        return baseAnimation->getChannelIndex(nodeName);
+    }
+
+    bool calculateChannelTransform(int32_t channelIndex, float time, glm::vec3& translate, glm::vec3& scale,
+                                   glm::quat& orientation, AnimationNode::Cursor *cursor) const;
+
     float getTicksPerSecond() const {
         return baseAnimation->getTicksPerSecond();
     }
@@ -6,6 +6,8 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <fstream>
+#include <cstring>
 #include "AnimationNode.h"
 
 bool AnimationCustom::calculateTransform(const std::string& nodeName __attribute((unused)), float time, Transformation& transformation) const {
@@ -15,8 +17,10 @@ bool AnimationCustom::calculateTransform(const std::string& nodeName __attribute
     return true;
 }
 
+const uint32_t AnimationCustom::BINARY_VERSION;
+
 /**
- * Saves the animation to a xml file with the name of first node of animation.
+ * Saves the animation to a xml file with the name of first node of animation, and to a binary file next to it.
  * @param path must end with "/"
  * @return true if saved successfully, or not needs saving. False if fails to save
  */
@@ -48,6 +52,52 @@ bool AnimationCustom::serializeAnimation(const std::string &path) const {
         return false;
     }
 
-    return true;
+    return serializeAnimationBinary(path + this->name + ".animbin");
+
+}
+
+bool AnimationCustom::serializeAnimationBinary(const std::string &fileName) const {
+    if (animationNode->translates.size() != animationNode->translateTimes.size() ||
+        animationNode->scales.size() != animationNode->scaleTimes.size() ||
+        animationNode->rotations.size() != animationNode->rotationTimes.size()) {
+        std::cerr << "Animation " << name << " has keys without times, it can't be saved as binary." << std::endl;
+        return false;
+    }
+    std::ofstream outputFile(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outputFile.is_open()) {
+        std::cerr << "ERROR saving animation file " << fileName << ", can't open file." << std::endl;
+        return false;
+    }
+    BinaryHeader header;
+    memcpy(header.magic, "LANM", 4);
+    header.version = BINARY_VERSION;
+    header.nodeCount = 1;//custom animations have a single node
+    header.nameLength = (uint32_t)name.size();
+    header.duration = duration;
+    header.ticksPerSecond = ticksPerSecond;
+    outputFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    outputFile.write(name.c_str(), name.size());
+    const char padding[4] = {0, 0, 0, 0};
+    outputFile.write(padding, (4 - name.size() % 4) % 4);
 
+    uint32_t keyCounts[3] = {(uint32_t)animationNode->translates.size(), (uint32_t)animationNode->scales.size(),
+                             (uint32_t)animationNode->rotations.size()};
+    outputFile.write(reinterpret_cast<const char *>(keyCounts), sizeof(keyCounts));
+
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed for animation file");
+    outputFile.write(reinterpret_cast<const char *>(animationNode->translateTimes.data()), keyCounts[0] * sizeof(float));
+    outputFile.write(reinterpret_cast<const char *>(animationNode->translates.data()), keyCounts[0] * sizeof(glm::vec3));
+    outputFile.write(reinterpret_cast<const char *>(animationNode->scaleTimes.data()), keyCounts[1] * sizeof(float));
+    outputFile.write(reinterpret_cast<const char *>(animationNode->scales.data()), keyCounts[1] * sizeof(glm::vec3));
+    outputFile.write(reinterpret_cast<const char *>(animationNode->rotationTimes.data()), keyCounts[2] * sizeof(float));
+    //quaternion member order depends on glm configuration, so they are written one by one
+    for (const glm::quat &rotation : animationNode->rotations) {
+        float components[4] = {rotation.x, rotation.y, rotation.z, rotation.w};
+        outputFile.write(reinterpret_cast<const char *>(components), sizeof(components));
+    }
+    if (!outputFile.good()) {
+        std::cerr << "ERROR saving animation file " << fileName << ", write failed." << std::endl;
+        return false;
+    }
+    return true;
 }
@@ -6,6 +6,7 @@
 #define LIMONENGINE_ANIMATIONCUSTOM_H
 
 
+#include <cstdint>
 #include "AnimationNode.h"
 #include "../../Transformation.h"
 #include "AnimationInterface.h"
@@ -13,11 +14,36 @@
 class AnimationCustom : public AnimationInterface {
     friend class AnimationLoader;
     friend struct AnimationSequenceInterface;
+    friend class AnimationNodeTest;//samples nodes of shipped animations directly
+
+    /**
+     * Binary file layout, all values little endian:
+     *
+     * BinaryHeader
+     * char     name[nameLength], padded with 0 to a multiple of 4
+     * uint32_t keyCounts[nodeCount * 3], translate, scale and rotation key counts of each node
+     * for each node:
+     *     float translateTimes[translateCount], float translates[translateCount * 3]
+     *     float scaleTimes[scaleCount], float scales[scaleCount * 3]
+     *     float rotationTimes[rotationCount], float rotations[rotationCount * 4] as x, y, z, w
+     *
+     * Header is 24 bytes and all other values are 4 bytes, so every array is aligned when the file is mapped.
+     */
+    struct BinaryHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t nodeCount;
+        uint32_t nameLength;
+        float duration;
+        float ticksPerSecond;
+    };
+
+    static const uint32_t BINARY_VERSION = 1;
 
     float ticksPerSecond;
     float duration;
 
-    AnimationNode* animationNode;
+    AnimationNode* animationNode = nullptr;
     std::string name;
 
     /*this private constructor is meant for deserialize only*/
@@ -42,6 +68,19 @@ public:
 
     bool calculateTransform(const std::string& nodeName __attribute((unused)), float time __attribute((unused)), Transformation& transformation) const;
 
+    //custom animations have a single node, it is used for any name
+    int32_t getChannelIndex(const std::string& nodeName __attribute((unused))) const {
+        return 0;
+    }
+
+    bool calculateChannelTransform(int32_t channelIndex __attribute((unused)), float time, glm::vec3& translate,
+                                   glm::vec3& scale, glm::quat& orientation, AnimationNode::Cursor *cursor) const {
+        scale = animationNode->getScalingVector(time, cursor);
+        orientation = animationNode->getRotationQuat(time, cursor);
+        translate = animationNode->getPositionVector(time, cursor);
+        return true;
+    }
+
     float getTicksPerSecond() const {
         return ticksPerSecond;
     }
@@ -55,6 +94,8 @@ public:
     }
 
     bool serializeAnimation(const std::string &path) const;
+
+    bool serializeAnimationBinary(const std::string &fileName) const;
 };
 
 
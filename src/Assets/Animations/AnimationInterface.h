@@ -7,12 +7,28 @@
 
 
 #include "../../Transformation.h"
+#include "AnimationNode.h"
 #include <glm/glm.hpp>
+#include <string>
+#include <cstdint>
 
 class AnimationInterface {
 public:
     virtual bool calculateTransform(const std::string& nodeName, float time, Transformation& transformation) const = 0;
 
+    /**
+     * @return index of the channel that animates the node, -1 if the node is not animated
+     */
+    virtual int32_t getChannelIndex(const std::string& nodeName) const = 0;
+
+    /**
+     * Same as calculateTransform, but takes the channel index from getChannelIndex, so there is no name lookup, and
+     * returns the components directly instead of building a Transformation.
+     * @param cursor key cursor of the channel, kept by the caller between frames. Can be nullptr.
+     */
+    virtual bool calculateChannelTransform(int32_t channelIndex, float time, glm::vec3& translate, glm::vec3& scale,
+                                           glm::quat& orientation, AnimationNode::Cursor *cursor) const = 0;
+
     virtual float getTicksPerSecond() const = 0;
 
     virtual float getDuration() const = 0;
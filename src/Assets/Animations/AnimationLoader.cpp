@@ -3,22 +3,110 @@
 //
 
 #include <iostream>
+#include <memory>
+#include <cstring>
 #include <glm/gtc/quaternion.hpp>
+#include <SDL2/SDL_timer.h>
 #include "AnimationLoader.h"
 
 #include "AnimationNode.h"
 #include "AnimationCustom.h"
+#include "../../Utils/MappedFile.h"
 
 AnimationCustom *AnimationLoader::loadAnimation(const std::string &fileName) {
+    std::string binaryFileName = fileName.substr(0, fileName.find_last_of('.')) + ".animbin";
     AnimationCustom* newAnimation = new AnimationCustom();
+    //binary is only a cache of the xml, if the xml is edited after it, the xml is used
+    if(!MappedFile::isOutdated(binaryFileName, fileName) && loadAnimationFromBinary(binaryFileName, newAnimation)) {
+        return newAnimation;
+    }
+    Uint32 loadStartTime = SDL_GetTicks();
     if(!loadAnimationFromXML(fileName, newAnimation)) {
         std::cerr << "Animation load failed" << std::endl;
         delete newAnimation;
         return nullptr;
     }
+    std::cout << "Animation " << fileName << " loaded from XML in " << SDL_GetTicks() - loadStartTime << " ms." << std::endl;
+    //convert, so the next load doesn't parse XML
+    if(newAnimation->serializeAnimationBinary(binaryFileName)) {
+        std::cout << "Animation converted to binary file " << binaryFileName << std::endl;
+    }
     return newAnimation;
 }
 
+bool AnimationLoader::loadAnimationFromBinary(const std::string &fileName, AnimationCustom *loadingAnimation) {
+    Uint32 loadStartTime = SDL_GetTicks();
+    MappedFile mappedFile(fileName);
+    if (!mappedFile.isValid()) {
+        return false;
+    }
+    AnimationCustom::BinaryHeader header;
+    if (mappedFile.getSize() < sizeof(header)) {
+        std::cerr << fileName << " is not a valid animation file." << std::endl;
+        return false;
+    }
+    memcpy(&header, mappedFile.getData(), sizeof(header));
+    if (memcmp(header.magic, "LANM", 4) != 0 || header.version != AnimationCustom::BINARY_VERSION) {
+        std::cerr << fileName << " is not a valid animation file, or its version is not supported." << std::endl;
+        return false;
+    }
+    if (header.nodeCount != 1) {
+        std::cerr << "Animation file " << fileName << " has " << header.nodeCount
+                  << " nodes, custom animations must have exactly one." << std::endl;
+        return false;
+    }
+
+    //offsets are checked against size before anything is read
+    size_t offset = sizeof(header);
+    size_t paddedNameLength = ((size_t)header.nameLength + 3) & ~(size_t)3;
+    size_t keyCountsOffset = offset + paddedNameLength;
+    if (keyCountsOffset + 3 * sizeof(uint32_t) > mappedFile.getSize()) {
+        std::cerr << "Animation file " << fileName << " is corrupted, it is too short." << std::endl;
+        return false;
+    }
+    uint32_t keyCounts[3];
+    memcpy(keyCounts, mappedFile.getData() + keyCountsOffset, sizeof(keyCounts));
+    size_t expectedSize = keyCountsOffset + sizeof(keyCounts) +
+                          ((size_t)keyCounts[0] * 4 + (size_t)keyCounts[1] * 4 + (size_t)keyCounts[2] * 5) * sizeof(float);
+    if (mappedFile.getSize() != expectedSize) {
+        std::cerr << "Animation file " << fileName << " is corrupted, size doesn't match key counts." << std::endl;
+        return false;
+    }
+    //sampling reads the last key of each channel, so none of them can be empty
+    if (keyCounts[0] == 0 || keyCounts[1] == 0 || keyCounts[2] == 0) {
+        std::cerr << "Animation file " << fileName << " is corrupted, it has a channel without keys." << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<AnimationNode> animationForNode(new AnimationNode());
+    //all arrays are 4 byte aligned in the file, and the mapping is page aligned
+    const float *values = reinterpret_cast<const float *>(mappedFile.getData() + keyCountsOffset + sizeof(keyCounts));
+    animationForNode->translateTimes.assign(values, values + keyCounts[0]);
+    values += keyCounts[0];
+    const glm::vec3 *vectors = reinterpret_cast<const glm::vec3 *>(values);
+    animationForNode->translates.assign(vectors, vectors + keyCounts[0]);
+    values += keyCounts[0] * 3;
+    animationForNode->scaleTimes.assign(values, values + keyCounts[1]);
+    values += keyCounts[1];
+    vectors = reinterpret_cast<const glm::vec3 *>(values);
+    animationForNode->scales.assign(vectors, vectors + keyCounts[1]);
+    values += keyCounts[1] * 3;
+    animationForNode->rotationTimes.assign(values, values + keyCounts[2]);
+    values += keyCounts[2];
+    animationForNode->rotations.reserve(keyCounts[2]);
+    for (uint32_t i = 0; i < keyCounts[2]; ++i, values += 4) {
+        animationForNode->rotations.push_back(glm::quat(values[3], values[0], values[1], values[2]));
+    }
+
+    loadingAnimation->name = std::string(reinterpret_cast<const char *>(mappedFile.getData() + offset), header.nameLength);
+    loadingAnimation->duration = header.duration;
+    loadingAnimation->ticksPerSecond = header.ticksPerSecond;
+    delete loadingAnimation->animationNode;
+    loadingAnimation->animationNode = animationForNode.release();
+    std::cout << "Animation " << fileName << " loaded in " << SDL_GetTicks() - loadStartTime << " ms." << std::endl;
+    return true;
+}
+
 bool AnimationLoader::loadAnimationFromXML(const std::string &fileName, AnimationCustom *loadingAnimation) {
 
     tinyxml2::XMLDocument xmlDoc;
@@ -12,12 +12,22 @@ class AnimationCustom;
 
 class AnimationLoader {
     static bool loadAnimationFromXML(const std::string &fileName, AnimationCustom *loadingAnimation);
+
+    /**
+     * Loads the layout AnimationCustom::serializeAnimationBinary writes. Key arrays are copied from the mapped file as
+     * a whole, nothing is parsed. @return false without error if file doesn't exist
+     */
+    static bool loadAnimationFromBinary(const std::string &fileName, AnimationCustom *loadingAnimation);
     static bool loadNodesFromXML(tinyxml2::XMLNode *animationNode, AnimationCustom *loadingAnimation);
 
     static bool readTranslateAndTimes(tinyxml2::XMLElement *nodeNode, AnimationNode *animationForNode);
     static bool readScaleAndTimes(tinyxml2::XMLElement *nodeNode, AnimationNode *animationForNode);
     static bool readRotationAndTimes(tinyxml2::XMLElement *nodeNode, AnimationNode *animationForNode);
 public:
+    /**
+     * Loads the binary file with the same name and .animbin extension if it exists. If not, loads the XML and writes
+     * the binary next to it, so XML is parsed only once.
+     */
     static AnimationCustom* loadAnimation(const std::string& fileName);
 
 
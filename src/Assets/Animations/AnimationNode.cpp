@@ -2,118 +2,105 @@
 // Created by engin on 18.05.2018.
 //
 
+#include <algorithm>
 #include "AnimationNode.h"
 
-glm::vec3 AnimationNode::getPositionVector(const float timeInTicks) const {
-    glm::vec3 transformVector;
-    if (translates.size() == 1) {
-        transformVector = translates[0];
-    } else {
-        uint32_t positionIndex = translateTimes.size();
-        for (unsigned int i = 0; i < translates.size(); i++) {
-            if (timeInTicks < translateTimes[i + 1]) {
-                positionIndex = i;
-                break;
+uint32_t AnimationNode::findKeyIndex(const std::vector<float> &times, float timeInTicks, uint32_t *cursorIndex) {
+    //times before first and after last key are handled by callers, so there is always a next key
+    uint32_t lastIndex = (uint32_t)times.size() - 2;
+    if (cursorIndex != nullptr) {
+        //forward playback either stays in the same key, or moves to the next one
+        for (uint32_t index = *cursorIndex; index <= lastIndex && index <= *cursorIndex + 1; ++index) {
+            if (times[index] <= timeInTicks && timeInTicks < times[index + 1]) {
+                *cursorIndex = index;
+                return index;
             }
         }
+    }
+    uint32_t index = (uint32_t)(std::upper_bound(times.begin(), times.end(), timeInTicks) - times.begin()) - 1;
+    if (cursorIndex != nullptr) {
+        *cursorIndex = index;
+    }
+    return index;
+}
 
-        if(timeInTicks == translateTimes[translateTimes.size()-1]) {
-            //this is the case were we request last transformation, and it doesn't require interpolation
-            return translates[translateTimes.size()-1];
-        }
-
-        if(timeInTicks < translateTimes[0]) {
-            return translates[0];
-        }
+glm::vec3 AnimationNode::getPositionVector(const float timeInTicks, Cursor *cursor) const {
+    if (translates.size() == 1) {
+        return translates[0];
+    }
+    if(timeInTicks >= translateTimes[translateTimes.size()-1]) {
+        //this is the case were we request last transformation, and it doesn't require interpolation
+        return translates[translateTimes.size()-1];
+    }
 
-        unsigned int NextPositionIndex = (positionIndex + 1);
-        assert(NextPositionIndex < translates.size());
-        float DeltaTime = (float) (translateTimes[NextPositionIndex] -
-                                   translateTimes[positionIndex]);
-        float Factor = (timeInTicks - (float) translateTimes[positionIndex]) / DeltaTime;
-        assert(Factor >= 0.0f && Factor <= 1.0f);
-        const glm::vec3 &Start = translates[positionIndex];
-        const glm::vec3 &End = translates[NextPositionIndex];
-        glm::vec3 Delta = End - Start;
-        transformVector = Start + Factor * Delta;
+    if(timeInTicks < translateTimes[0]) {
+        return translates[0];
     }
-    return transformVector;
+
+    uint32_t positionIndex = findKeyIndex(translateTimes, timeInTicks, cursor == nullptr ? nullptr : &cursor->translateIndex);
+    unsigned int NextPositionIndex = (positionIndex + 1);
+    assert(NextPositionIndex < translates.size());
+    float DeltaTime = (float) (translateTimes[NextPositionIndex] -
+                               translateTimes[positionIndex]);
+    float Factor = (timeInTicks - (float) translateTimes[positionIndex]) / DeltaTime;
+    assert(Factor >= 0.0f && Factor <= 1.0f);
+    const glm::vec3 &Start = translates[positionIndex];
+    const glm::vec3 &End = translates[NextPositionIndex];
+    glm::vec3 Delta = End - Start;
+    return Start + Factor * Delta;
 }
 
-glm::vec3 AnimationNode::getScalingVector(const float timeInTicks) const {
-    glm::vec3 scalingTransformVector;
+glm::vec3 AnimationNode::getScalingVector(const float timeInTicks, Cursor *cursor) const {
+    assert(scales.size() > 0);
     if (scales.size() == 1) {
-        scalingTransformVector = scales[0];
-    } else {
-        uint32_t ScalingIndex = scaleTimes.size();
-        assert(scales.size() > 0);
-        for (unsigned int i = 0; i < scales.size(); i++) {
-            if (timeInTicks < scaleTimes[i + 1]) {
-                ScalingIndex = i;
-                break;
-            }
-        }
-
-        if(timeInTicks == scaleTimes[scaleTimes.size()-1]) {
-            //this is the case were we request last transformation, and it doesn't require interpolation
-            return scales[scaleTimes.size()-1];
-        }
-
-        if(timeInTicks < scaleTimes[0]) {
-            return scales[0];
-        }
+        return scales[0];
+    }
+    if(timeInTicks >= scaleTimes[scaleTimes.size()-1]) {
+        //this is the case were we request last transformation, and it doesn't require interpolation
+        return scales[scaleTimes.size()-1];
+    }
 
-        unsigned int NextScalingIndex = (ScalingIndex + 1);
-        assert(NextScalingIndex < scales.size());
-        float DeltaTime = (scaleTimes[NextScalingIndex] -
-                           scaleTimes[ScalingIndex]);
-        float Factor = (timeInTicks - (float) scaleTimes[ScalingIndex]) / DeltaTime;
-        assert(Factor >= 0.0f && Factor <= 1.0f);
-        const glm::vec3 &Start = scales[ScalingIndex];
-        const glm::vec3 &End = scales[NextScalingIndex];
-        glm::vec3 Delta = End - Start;
-        scalingTransformVector = Start + Factor * Delta;
+    if(timeInTicks < scaleTimes[0]) {
+        return scales[0];
     }
-    return scalingTransformVector;
+
+    uint32_t ScalingIndex = findKeyIndex(scaleTimes, timeInTicks, cursor == nullptr ? nullptr : &cursor->scaleIndex);
+    unsigned int NextScalingIndex = (ScalingIndex + 1);
+    assert(NextScalingIndex < scales.size());
+    float DeltaTime = (scaleTimes[NextScalingIndex] -
+                       scaleTimes[ScalingIndex]);
+    float Factor = (timeInTicks - (float) scaleTimes[ScalingIndex]) / DeltaTime;
+    assert(Factor >= 0.0f && Factor <= 1.0f);
+    const glm::vec3 &Start = scales[ScalingIndex];
+    const glm::vec3 &End = scales[NextScalingIndex];
+    glm::vec3 Delta = End - Start;
+    return Start + Factor * Delta;
 }
 
-glm::quat AnimationNode::getRotationQuat(const float timeInTicks) const {
-    glm::quat rotationTransformQuaternion;
+glm::quat AnimationNode::getRotationQuat(const float timeInTicks, Cursor *cursor) const {
+    assert(rotations.size() > 0);
     if (rotations.size() == 1) {
-        rotationTransformQuaternion = rotations[0];
-    } else {
-
-        uint32_t rotationIndex = rotationTimes.size();
-
-        assert(rotations.size() > 0);
-
-        for (unsigned int i = 0; i < rotations.size(); i++) {
-            if (timeInTicks < (float) rotationTimes[i + 1]) {
-                rotationIndex = i;
-                break;
-            }
-        }
-
-        if(timeInTicks == rotationTimes[rotationTimes.size()-1]) {
-            //this is the case were we request last transformation, and it doesn't require interpolation
-            return rotations[rotationTimes.size()-1];
-        }
-
-        if(timeInTicks < rotationTimes[0]) {
-            return rotations[0];
-        }
+        return rotations[0];
+    }
+    if(timeInTicks >= rotationTimes[rotationTimes.size()-1]) {
+        //this is the case were we request last transformation, and it doesn't require interpolation
+        return rotations[rotationTimes.size()-1];
+    }
 
-        unsigned int NextRotationIndex = (rotationIndex + 1);
-        assert(NextRotationIndex < rotations.size());
-        float DeltaTime = (rotationTimes[NextRotationIndex] -
-                           rotationTimes[rotationIndex]);
-        float Factor = (timeInTicks - (float) rotationTimes[rotationIndex]) / DeltaTime;
-        assert(Factor >= 0.0f && Factor <= 1.0f);
-        const glm::quat &StartRotationQ = rotations[rotationIndex];
-        const glm::quat &EndRotationQ = rotations[NextRotationIndex];
-        rotationTransformQuaternion = glm::normalize(glm::slerp(StartRotationQ, EndRotationQ, Factor));
+    if(timeInTicks < rotationTimes[0]) {
+        return rotations[0];
     }
-    return rotationTransformQuaternion;
+
+    uint32_t rotationIndex = findKeyIndex(rotationTimes, timeInTicks, cursor == nullptr ? nullptr : &cursor->rotationIndex);
+    unsigned int NextRotationIndex = (rotationIndex + 1);
+    assert(NextRotationIndex < rotations.size());
+    float DeltaTime = (rotationTimes[NextRotationIndex] -
+                       rotationTimes[rotationIndex]);
+    float Factor = (timeInTicks - (float) rotationTimes[rotationIndex]) / DeltaTime;
+    assert(Factor >= 0.0f && Factor <= 1.0f);
+    const glm::quat &StartRotationQ = rotations[rotationIndex];
+    const glm::quat &EndRotationQ = rotations[NextRotationIndex];
+    return glm::normalize(glm::slerp(StartRotationQ, EndRotationQ, Factor));
 }
 
 
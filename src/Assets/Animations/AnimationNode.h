@@ -11,6 +11,7 @@
 #include <tinyxml2.h>
 #include <glm/gtc/quaternion.hpp>
 #include <string>
+#include <cstdint>
 
 //ATTENTION this is not a class, but a struct
 struct AnimationNode {
@@ -22,15 +23,31 @@ struct AnimationNode {
         std::vector<glm::quat> rotations;
         std::vector<float>rotationTimes;
 
+        /**
+         * Key indexes found by the last sample. Passing it back with the next sample lets forward playback find its keys
+         * without a search. It is only a hint, if it doesn't match the time, keys are binary searched.
+         */
+        struct Cursor {
+            uint32_t translateIndex = 0;
+            uint32_t scaleIndex = 0;
+            uint32_t rotationIndex = 0;
+        };
+
         void fillNode(tinyxml2::XMLDocument &document, tinyxml2::XMLElement *nodeElement) const;
 
-        glm::quat getRotationQuat(const float timeInTicks) const;
+        glm::quat getRotationQuat(const float timeInTicks, Cursor *cursor = nullptr) const;
+
+        glm::vec3 getScalingVector(const float timeInTicks, Cursor *cursor = nullptr) const;
 
-        glm::vec3 getScalingVector(const float timeInTicks) const;
+        glm::vec3 getPositionVector(const float timeInTicks, Cursor *cursor = nullptr) const;
 
-        glm::vec3 getPositionVector(const float timeInTicks) const;
+        /**
+         * @return index of the key that is at or before time, time must be between first and last keys
+         */
+        static uint32_t findKeyIndex(const std::vector<float> &times, float timeInTicks, uint32_t *cursorIndex);
 
     private:
+
         void fillTranslateAndTimes(tinyxml2::XMLDocument &document, tinyxml2::XMLElement *nodeElement) const;
 
         void fillScaleAndTimes(tinyxml2::XMLDocument &document, tinyxml2::XMLElement *nodeElement) const;
@@ -0,0 +1,182 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "AnimationPose.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define LIMON_ANIMATION_POSE_SSE
+#include <xmmintrin.h>
+#endif
+
+void AnimationPose::resize(size_t boneCount) {
+    this->boneCount = boneCount;
+    size_t paddedCount = (boneCount + 3) & ~(size_t)3;
+    translateX.resize(paddedCount, 0.0f);
+    translateY.resize(paddedCount, 0.0f);
+    translateZ.resize(paddedCount, 0.0f);
+    scaleX.resize(paddedCount, 1.0f);
+    scaleY.resize(paddedCount, 1.0f);
+    scaleZ.resize(paddedCount, 1.0f);
+    orientationX.resize(paddedCount, 0.0f);
+    orientationY.resize(paddedCount, 0.0f);
+    orientationZ.resize(paddedCount, 0.0f);
+    orientationW.resize(paddedCount, 1.0f);
+}
+
+void AnimationPose::set(size_t bone, const glm::vec3 &translate, const glm::vec3 &scale, const glm::quat &orientation) {
+    translateX[bone] = translate.x;
+    translateY[bone] = translate.y;
+    translateZ[bone] = translate.z;
+    scaleX[bone] = scale.x;
+    scaleY[bone] = scale.y;
+    scaleZ[bone] = scale.z;
+    glm::quat normalizedOrientation = glm::normalize(orientation);
+    orientationX[bone] = normalizedOrientation.x;
+    orientationY[bone] = normalizedOrientation.y;
+    orientationZ[bone] = normalizedOrientation.z;
+    orientationW[bone] = normalizedOrientation.w;
+}
+
+void AnimationPose::copyBone(size_t bone, const AnimationPose &source) {
+    translateX[bone] = source.translateX[bone];
+    translateY[bone] = source.translateY[bone];
+    translateZ[bone] = source.translateZ[bone];
+    scaleX[bone] = source.scaleX[bone];
+    scaleY[bone] = source.scaleY[bone];
+    scaleZ[bone] = source.scaleZ[bone];
+    orientationX[bone] = source.orientationX[bone];
+    orientationY[bone] = source.orientationY[bone];
+    orientationZ[bone] = source.orientationZ[bone];
+    orientationW[bone] = source.orientationW[bone];
+}
+
+glm::mat4 AnimationPose::getMatrix(size_t bone) const {
+    glm::vec3 translate(translateX[bone], translateY[bone], translateZ[bone]);
+    glm::vec3 scale(scaleX[bone], scaleY[bone], scaleZ[bone]);
+    glm::quat orientation(orientationW[bone], orientationX[bone], orientationY[bone], orientationZ[bone]);
+    return glm::translate(glm::mat4(1.0f), translate) * glm::mat4_cast(orientation) *
+           glm::scale(glm::mat4(1.0f), scale);
+}
+
+void AnimationPose::blendRangeScalar(const AnimationPose &from, const AnimationPose &to, float factor,
+                                     AnimationPose &result, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        result.translateX[i] = from.translateX[i] + factor * (to.translateX[i] - from.translateX[i]);
+        result.translateY[i] = from.translateY[i] + factor * (to.translateY[i] - from.translateY[i]);
+        result.translateZ[i] = from.translateZ[i] + factor * (to.translateZ[i] - from.translateZ[i]);
+        result.scaleX[i] = from.scaleX[i] + factor * (to.scaleX[i] - from.scaleX[i]);
+        result.scaleY[i] = from.scaleY[i] + factor * (to.scaleY[i] - from.scaleY[i]);
+        result.scaleZ[i] = from.scaleZ[i] + factor * (to.scaleZ[i] - from.scaleZ[i]);
+
+        //q and -q are the same rotation, flip target to take the shortest path
+        float dot = from.orientationX[i] * to.orientationX[i] + from.orientationY[i] * to.orientationY[i] +
+                    from.orientationZ[i] * to.orientationZ[i] + from.orientationW[i] * to.orientationW[i];
+        bool flip = std::signbit(dot);
+        float targetX = flip ? -to.orientationX[i] : to.orientationX[i];
+        float targetY = flip ? -to.orientationY[i] : to.orientationY[i];
+        float targetZ = flip ? -to.orientationZ[i] : to.orientationZ[i];
+        float targetW = flip ? -to.orientationW[i] : to.orientationW[i];
+        float x = from.orientationX[i] + factor * (targetX - from.orientationX[i]);
+        float y = from.orientationY[i] + factor * (targetY - from.orientationY[i]);
+        float z = from.orientationZ[i] + factor * (targetZ - from.orientationZ[i]);
+        float w = from.orientationW[i] + factor * (targetW - from.orientationW[i]);
+        float length = std::sqrt(x * x + y * y + z * z + w * w);
+        result.orientationX[i] = x / length;
+        result.orientationY[i] = y / length;
+        result.orientationZ[i] = z / length;
+        result.orientationW[i] = w / length;
+    }
+}
+
+void AnimationPose::blendScalar(const AnimationPose &from, const AnimationPose &to, float factor, AnimationPose &result) {
+    result.resize(from.boneCount);
+    blendRangeScalar(from, to, factor, result, 0, from.boneCount);
+}
+
+#ifdef LIMON_ANIMATION_POSE_SSE
+
+void AnimationPose::blend(const AnimationPose &from, const AnimationPose &to, float factor, AnimationPose &result) {
+    result.resize(from.boneCount);
+    const __m128 factor4 = _mm_set1_ps(factor);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    //arrays are padded, so the last group can be processed the same way
+    for (size_t i = 0; i < from.boneCount; i += 4) {
+        const float *fromComponents[6] = {&from.translateX[i], &from.translateY[i], &from.translateZ[i],
+                                          &from.scaleX[i], &from.scaleY[i], &from.scaleZ[i]};
+        const float *toComponents[6] = {&to.translateX[i], &to.translateY[i], &to.translateZ[i],
+                                        &to.scaleX[i], &to.scaleY[i], &to.scaleZ[i]};
+        float *resultComponents[6] = {&result.translateX[i], &result.translateY[i], &result.translateZ[i],
+                                      &result.scaleX[i], &result.scaleY[i], &result.scaleZ[i]};
+        for (int j = 0; j < 6; ++j) {
+            __m128 from4 = _mm_loadu_ps(fromComponents[j]);
+            __m128 to4 = _mm_loadu_ps(toComponents[j]);
+            _mm_storeu_ps(resultComponents[j], _mm_add_ps(from4, _mm_mul_ps(factor4, _mm_sub_ps(to4, from4))));
+        }
+
+        __m128 fromX = _mm_loadu_ps(&from.orientationX[i]);
+        __m128 fromY = _mm_loadu_ps(&from.orientationY[i]);
+        __m128 fromZ = _mm_loadu_ps(&from.orientationZ[i]);
+        __m128 fromW = _mm_loadu_ps(&from.orientationW[i]);
+        __m128 toX = _mm_loadu_ps(&to.orientationX[i]);
+        __m128 toY = _mm_loadu_ps(&to.orientationY[i]);
+        __m128 toZ = _mm_loadu_ps(&to.orientationZ[i]);
+        __m128 toW = _mm_loadu_ps(&to.orientationW[i]);
+
+        //q and -q are the same rotation, flip target to take the shortest path
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(fromX, toX), _mm_mul_ps(fromY, toY)),
+                                           _mm_mul_ps(fromZ, toZ)), _mm_mul_ps(fromW, toW));
+        __m128 flip = _mm_and_ps(dot, signMask);
+        toX = _mm_xor_ps(toX, flip);
+        toY = _mm_xor_ps(toY, flip);
+        toZ = _mm_xor_ps(toZ, flip);
+        toW = _mm_xor_ps(toW, flip);
+
+        __m128 x = _mm_add_ps(fromX, _mm_mul_ps(factor4, _mm_sub_ps(toX, fromX)));
+        __m128 y = _mm_add_ps(fromY, _mm_mul_ps(factor4, _mm_sub_ps(toY, fromY)));
+        __m128 z = _mm_add_ps(fromZ, _mm_mul_ps(factor4, _mm_sub_ps(toZ, fromZ)));
+        __m128 w = _mm_add_ps(fromW, _mm_mul_ps(factor4, _mm_sub_ps(toW, fromW)));
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                                          _mm_mul_ps(z, z)), _mm_mul_ps(w, w)));
+        _mm_storeu_ps(&result.orientationX[i], _mm_div_ps(x, length));
+        _mm_storeu_ps(&result.orientationY[i], _mm_div_ps(y, length));
+        _mm_storeu_ps(&result.orientationZ[i], _mm_div_ps(z, length));
+        _mm_storeu_ps(&result.orientationW[i], _mm_div_ps(w, length));
+    }
+}
+
+void AnimationPose::multiply(const glm::mat4 &first, const glm::mat4 &second, glm::mat4 &result) {
+    //matrices are column major, result column j is first's columns weighted by second column j
+    const float *firstData = glm::value_ptr(first);
+    const float *secondData = glm::value_ptr(second);
+    float *resultData = glm::value_ptr(result);
+    __m128 column0 = _mm_loadu_ps(firstData);
+    __m128 column1 = _mm_loadu_ps(firstData + 4);
+    __m128 column2 = _mm_loadu_ps(firstData + 8);
+    __m128 column3 = _mm_loadu_ps(firstData + 12);
+    for (int j = 0; j < 4; ++j) {
+        //second column j is read completely before result column j is written, so aliasing is safe
+        __m128 weight0 = _mm_set1_ps(secondData[j * 4]);
+        __m128 weight1 = _mm_set1_ps(secondData[j * 4 + 1]);
+        __m128 weight2 = _mm_set1_ps(secondData[j * 4 + 2]);
+        __m128 weight3 = _mm_set1_ps(secondData[j * 4 + 3]);
+        __m128 resultColumn = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(column0, weight0), _mm_mul_ps(column1, weight1)),
+                                                    _mm_mul_ps(column2, weight2)), _mm_mul_ps(column3, weight3));
+        _mm_storeu_ps(resultData + j * 4, resultColumn);
+    }
+}
+
+#else
+
+void AnimationPose::blend(const AnimationPose &from, const AnimationPose &to, float factor, AnimationPose &result) {
+    blendScalar(from, to, factor, result);
+}
+
+void AnimationPose::multiply(const glm::mat4 &first, const glm::mat4 &second, glm::mat4 &result) {
+    result = first * second;
+}
+
+#endif
@@ -0,0 +1,65 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_ANIMATIONPOSE_H
+#define LIMONENGINE_ANIMATIONPOSE_H
+
+
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/**
+ * Local space translate, scale and orientation of each bone of a skeleton.
+ *
+ * Each component is kept in its own array, so blending processes 4 bones with a single SSE instruction. Arrays are
+ * padded to a multiple of 4 with identity values, so the last group doesn't need special handling.
+ *
+ * blendScalar is the reference implementation, blend uses SSE if the target supports it, and falls back to
+ * blendScalar otherwise. Both use the same operations in the same order, so they give the same results.
+ */
+class AnimationPose {
+    size_t boneCount = 0;
+    std::vector<float> translateX, translateY, translateZ;
+    std::vector<float> scaleX, scaleY, scaleZ;
+    std::vector<float> orientationX, orientationY, orientationZ, orientationW;
+
+    static void blendRangeScalar(const AnimationPose &from, const AnimationPose &to, float factor, AnimationPose &result,
+                                 size_t begin, size_t end);
+
+public:
+    void resize(size_t boneCount);
+
+    size_t getBoneCount() const {
+        return boneCount;
+    }
+
+    /**
+     * Orientation is normalized, same as Transformation::setOrientation.
+     */
+    void set(size_t bone, const glm::vec3 &translate, const glm::vec3 &scale, const glm::quat &orientation);
+
+    void copyBone(size_t bone, const AnimationPose &source);
+
+    /**
+     * @return translate * rotate * scale matrix of the bone, same as Transformation::getWorldTransform
+     */
+    glm::mat4 getMatrix(size_t bone) const;
+
+    /**
+     * Lerps translate and scale, and nlerps orientation on the shortest path. Poses must have the same bone count.
+     */
+    static void blendScalar(const AnimationPose &from, const AnimationPose &to, float factor, AnimationPose &result);
+
+    static void blend(const AnimationPose &from, const AnimationPose &to, float factor, AnimationPose &result);
+
+    /**
+     * result = first * second. result can be the same object with any of the parameters.
+     */
+    static void multiply(const glm::mat4 &first, const glm::mat4 &second, glm::mat4 &result);
+};
+
+
+#endif //LIMONENGINE_ANIMATIONPOSE_H
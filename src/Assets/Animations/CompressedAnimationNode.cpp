@@ -0,0 +1,240 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+#include "CompressedAnimationNode.h"
+
+//smallest three components of a unit quaternion are in [-1/sqrt(2), 1/sqrt(2)]
+static const float SMALLEST_THREE_RANGE = 0.70710678f;
+static const float QUATERNION_COMPONENT_STEPS = 32767.0f;//15 bits
+static const float VECTOR_COMPONENT_STEPS = 65535.0f;//16 bits
+
+static glm::vec3 interpolateVec3(const glm::vec3 &start, const glm::vec3 &end, float factor) {
+    return start + factor * (end - start);
+}
+
+static glm::quat interpolateQuat(const glm::quat &start, const glm::quat &end, float factor) {
+    return glm::normalize(glm::slerp(start, end, factor));
+}
+
+static float quatAngle(const glm::quat &first, const glm::quat &second) {
+    //q and -q are the same rotation
+    float dot = std::min(std::fabs(glm::dot(glm::normalize(first), glm::normalize(second))), 1.0f);
+    return 2.0f * std::acos(dot);
+}
+
+/**
+ * Greedily extends a segment from the last kept key, as long as every key it covers can be interpolated from the
+ * segment ends within tolerance. First and last keys are always kept, unless all keys are within tolerance of the
+ * first one, then only it is kept.
+ *
+ * @return indexes of kept keys
+ */
+template<typename T, typename Interpolate, typename Distance>
+static std::vector<uint32_t> reduceKeys(const std::vector<T> &keys, const std::vector<float> &times, float tolerance,
+                                        Interpolate interpolate, Distance distance) {
+    std::vector<uint32_t> keptIndexes;
+    if (keys.empty()) {
+        return keptIndexes;
+    }
+    keptIndexes.push_back(0);
+    bool constant = true;
+    for (size_t i = 1; i < keys.size(); ++i) {
+        if (distance(keys[0], keys[i]) > tolerance) {
+            constant = false;
+            break;
+        }
+    }
+    if (constant) {
+        return keptIndexes;
+    }
+
+    uint32_t start = 0;
+    for (uint32_t end = start + 2; end < keys.size(); ++end) {
+        for (uint32_t middle = start + 1; middle < end; ++middle) {
+            float duration = times[end] - times[start];
+            float factor = duration > 0.0f ? (times[middle] - times[start]) / duration : 0.0f;
+            if (distance(interpolate(keys[start], keys[end], factor), keys[middle]) > tolerance) {
+                //end is too far, segment ends with the key before it
+                start = end - 1;
+                keptIndexes.push_back(start);
+                break;
+            }
+        }
+    }
+    keptIndexes.push_back((uint32_t)keys.size() - 1);
+    return keptIndexes;
+}
+
+void CompressedAnimationNode::Vec3Track::build(const std::vector<glm::vec3> &keys, const std::vector<float> &keyTimes,
+                                               float tolerance) {
+    std::vector<uint32_t> keptIndexes = reduceKeys(keys, keyTimes, tolerance, interpolateVec3,
+                                                   [](const glm::vec3 &first, const glm::vec3 &second) {
+                                                       return glm::length(first - second);
+                                                   });
+    if (keptIndexes.empty()) {
+        return;
+    }
+    glm::vec3 maximum = keys[keptIndexes[0]];
+    minimum = keys[keptIndexes[0]];
+    for (uint32_t index : keptIndexes) {
+        minimum = glm::min(minimum, keys[index]);
+        maximum = glm::max(maximum, keys[index]);
+    }
+    extent = maximum - minimum;
+
+    times.reserve(keptIndexes.size());
+    values.reserve(keptIndexes.size() * 3);
+    for (uint32_t index : keptIndexes) {
+        times.push_back(keyTimes[index]);
+        for (int component = 0; component < 3; ++component) {
+            float normalized = 0.0f;
+            if (extent[component] > 0.0f) {
+                normalized = (keys[index][component] - minimum[component]) / extent[component];
+            }
+            values.push_back((uint16_t)std::lround(glm::clamp(normalized, 0.0f, 1.0f) * VECTOR_COMPONENT_STEPS));
+        }
+    }
+}
+
+glm::vec3 CompressedAnimationNode::Vec3Track::getKey(uint32_t index) const {
+    const uint16_t *key = &values[index * 3];
+    return minimum + extent * glm::vec3(key[0], key[1], key[2]) / VECTOR_COMPONENT_STEPS;
+}
+
+glm::vec3 CompressedAnimationNode::Vec3Track::sample(float timeInTicks, uint32_t *cursorIndex) const {
+    assert(!times.empty());
+    if (times.size() == 1 || timeInTicks < times[0]) {
+        return getKey(0);
+    }
+    if (timeInTicks >= times[times.size() - 1]) {
+        return getKey((uint32_t)times.size() - 1);
+    }
+    uint32_t index = AnimationNode::findKeyIndex(times, timeInTicks, cursorIndex);
+    float factor = (timeInTicks - times[index]) / (times[index + 1] - times[index]);
+    return interpolateVec3(getKey(index), getKey(index + 1), factor);
+}
+
+void CompressedAnimationNode::QuatTrack::build(const std::vector<glm::quat> &keys, const std::vector<float> &keyTimes,
+                                               float tolerance) {
+    std::vector<uint32_t> keptIndexes = reduceKeys(keys, keyTimes, tolerance, interpolateQuat, quatAngle);
+
+    times.reserve(keptIndexes.size());
+    values.reserve(keptIndexes.size() * 3);
+    for (uint32_t index : keptIndexes) {
+        times.push_back(keyTimes[index]);
+        glm::quat normalized = glm::normalize(keys[index]);
+        float components[4] = {normalized.x, normalized.y, normalized.z, normalized.w};
+        uint16_t largestIndex = 0;
+        for (uint16_t component = 1; component < 4; ++component) {
+            if (std::fabs(components[component]) > std::fabs(components[largestIndex])) {
+                largestIndex = component;
+            }
+        }
+        //largest component is stored as positive, by negating the whole quaternion if needed
+        float sign = components[largestIndex] < 0.0f ? -1.0f : 1.0f;
+        uint16_t packed[3];
+        int packedIndex = 0;
+        for (uint16_t component = 0; component < 4; ++component) {
+            if (component == largestIndex) {
+                continue;
+            }
+            float normalizedComponent = glm::clamp(sign * components[component] / SMALLEST_THREE_RANGE, -1.0f, 1.0f);
+            packed[packedIndex++] = (uint16_t)std::lround((normalizedComponent * 0.5f + 0.5f) * QUATERNION_COMPONENT_STEPS);
+        }
+        packed[0] |= (uint16_t)((largestIndex & 1) << 15);
+        packed[1] |= (uint16_t)((largestIndex >> 1) << 15);
+        values.insert(values.end(), packed, packed + 3);
+    }
+}
+
+glm::quat CompressedAnimationNode::QuatTrack::getKey(uint32_t index) const {
+    const uint16_t *key = &values[index * 3];
+    uint16_t largestIndex = (uint16_t)((key[0] >> 15) | ((key[1] >> 15) << 1));
+    float components[4];
+    float sumOfSquares = 0.0f;
+    int packedIndex = 0;
+    for (uint16_t component = 0; component < 4; ++component) {
+        if (component == largestIndex) {
+            continue;
+        }
+        float normalizedComponent = (key[packedIndex++] & 0x7FFF) / QUATERNION_COMPONENT_STEPS * 2.0f - 1.0f;
+        components[component] = normalizedComponent * SMALLEST_THREE_RANGE;
+        sumOfSquares += components[component] * components[component];
+    }
+    components[largestIndex] = std::sqrt(std::max(0.0f, 1.0f - sumOfSquares));
+    return glm::normalize(glm::quat(components[3], components[0], components[1], components[2]));
+}
+
+glm::quat CompressedAnimationNode::QuatTrack::sample(float timeInTicks, uint32_t *cursorIndex) const {
+    assert(!times.empty());
+    if (times.size() == 1 || timeInTicks < times[0]) {
+        return getKey(0);
+    }
+    if (timeInTicks >= times[times.size() - 1]) {
+        return getKey((uint32_t)times.size() - 1);
+    }
+    uint32_t index = AnimationNode::findKeyIndex(times, timeInTicks, cursorIndex);
+    float factor = (timeInTicks - times[index]) / (times[index + 1] - times[index]);
+    return interpolateQuat(getKey(index), getKey(index + 1), factor);
+}
+
+CompressedAnimationNode::CompressedAnimationNode(const AnimationNode &node, const Tolerances &tolerances) {
+    translates.build(node.translates, node.translateTimes, tolerances.translate);
+    scales.build(node.scales, node.scaleTimes, tolerances.scale);
+    rotations.build(node.rotations, node.rotationTimes, tolerances.rotation);
+}
+
+glm::quat CompressedAnimationNode::getRotationQuat(const float timeInTicks, AnimationNode::Cursor *cursor) const {
+    return rotations.sample(timeInTicks, cursor == nullptr ? nullptr : &cursor->rotationIndex);
+}
+
+glm::vec3 CompressedAnimationNode::getScalingVector(const float timeInTicks, AnimationNode::Cursor *cursor) const {
+    return scales.sample(timeInTicks, cursor == nullptr ? nullptr : &cursor->scaleIndex);
+}
+
+glm::vec3 CompressedAnimationNode::getPositionVector(const float timeInTicks, AnimationNode::Cursor *cursor) const {
+    return translates.sample(timeInTicks, cursor == nullptr ? nullptr : &cursor->translateIndex);
+}
+
+void CompressedAnimationNode::measureError(const AnimationNode &original, float &translateError, float &rotationError,
+                                           float &scaleError) const {
+    translateError = rotationError = scaleError = 0.0f;
+    std::vector<float> sampleTimes;
+    const std::vector<float> *keyTimes[3] = {&original.translateTimes, &original.scaleTimes, &original.rotationTimes};
+    for (const std::vector<float> *times : keyTimes) {
+        for (size_t i = 0; i < times->size(); ++i) {
+            sampleTimes.push_back((*times)[i]);
+            if (i + 1 < times->size()) {
+                sampleTimes.push_back(((*times)[i] + (*times)[i + 1]) / 2.0f);
+            }
+        }
+    }
+    for (float time : sampleTimes) {
+        if (!original.translates.empty()) {
+            translateError = std::max(translateError,
+                                      glm::length(original.getPositionVector(time) - getPositionVector(time)));
+        }
+        if (!original.scales.empty()) {
+            scaleError = std::max(scaleError, glm::length(original.getScalingVector(time) - getScalingVector(time)));
+        }
+        if (!original.rotations.empty()) {
+            rotationError = std::max(rotationError, quatAngle(original.getRotationQuat(time), getRotationQuat(time)));
+        }
+    }
+}
+
+size_t CompressedAnimationNode::getMemorySize() const {
+    return sizeof(CompressedAnimationNode) +
+           (translates.times.size() + scales.times.size() + rotations.times.size()) * sizeof(float) +
+           (translates.values.size() + scales.values.size() + rotations.values.size()) * sizeof(uint16_t);
+}
+
+size_t CompressedAnimationNode::getMemorySize(const AnimationNode &node) {
+    return sizeof(AnimationNode) +
+           (node.translateTimes.size() + node.scaleTimes.size() + node.rotationTimes.size()) * sizeof(float) +
+           (node.translates.size() + node.scales.size()) * sizeof(glm::vec3) + node.rotations.size() * sizeof(glm::quat);
+}
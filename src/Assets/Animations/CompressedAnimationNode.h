@@ -0,0 +1,85 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_COMPRESSEDANIMATIONNODE_H
+#define LIMONENGINE_COMPRESSEDANIMATIONNODE_H
+
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "AnimationNode.h"
+
+/**
+ * Read only, compressed copy of an AnimationNode, sampled the same way.
+ *
+ * Keys that can be interpolated from their neighbours within tolerance are removed. Remaining translate and scale keys
+ * are quantized to 16 bits per component, in the range of the track. Rotations are stored as the smallest three
+ * components, 15 bits each, and the index of the dropped largest component in the 2 spare bits. Keys are decompressed
+ * while sampling, only the 2 keys around the time are touched.
+ *
+ * Tolerances are for the local transform of the node, errors of parents accumulate on their children.
+ */
+class CompressedAnimationNode {
+public:
+    struct Tolerances {
+        float translate;//in model units
+        float rotation;//in radians
+        float scale;
+    };
+
+private:
+    struct Vec3Track {
+        std::vector<float> times;
+        std::vector<uint16_t> values;//3 per key
+        glm::vec3 minimum = glm::vec3(0.0f);
+        glm::vec3 extent = glm::vec3(0.0f);
+
+        void build(const std::vector<glm::vec3> &keys, const std::vector<float> &keyTimes, float tolerance);
+
+        glm::vec3 getKey(uint32_t index) const;
+
+        glm::vec3 sample(float timeInTicks, uint32_t *cursorIndex) const;
+    };
+
+    struct QuatTrack {
+        std::vector<float> times;
+        std::vector<uint16_t> values;//3 per key
+
+        void build(const std::vector<glm::quat> &keys, const std::vector<float> &keyTimes, float tolerance);
+
+        glm::quat getKey(uint32_t index) const;
+
+        glm::quat sample(float timeInTicks, uint32_t *cursorIndex) const;
+    };
+
+    Vec3Track translates;
+    Vec3Track scales;
+    QuatTrack rotations;
+
+public:
+    CompressedAnimationNode(const AnimationNode &node, const Tolerances &tolerances);
+
+    glm::quat getRotationQuat(const float timeInTicks, AnimationNode::Cursor *cursor = nullptr) const;
+
+    glm::vec3 getScalingVector(const float timeInTicks, AnimationNode::Cursor *cursor = nullptr) const;
+
+    glm::vec3 getPositionVector(const float timeInTicks, AnimationNode::Cursor *cursor = nullptr) const;
+
+    /**
+     * Samples both nodes at every key time of original, and half way between keys.
+     * Rotation error is the angle between the orientations, in radians.
+     */
+    void measureError(const AnimationNode &original, float &translateError, float &rotationError,
+                      float &scaleError) const;
+
+    size_t getMemorySize() const;
+
+    static size_t getMemorySize(const AnimationNode &node);
+};
+
+
+#endif //LIMONENGINE_COMPRESSEDANIMATIONNODE_H
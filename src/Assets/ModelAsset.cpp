@@ -3,6 +3,8 @@
 //
 
 #include <set>
+#include <atomic>
+#include <algorithm>
 #include "ModelAsset.h"
 #include "../glm/gtx/matrix_decompose.hpp"
 #include "../Utils/GLMUtils.h"
@@ -16,6 +18,14 @@ ModelAsset::ModelAsset(AssetManager *assetManager, uint32_t assetID, const std::
                 fileList),
           boneIDCounter(0),
           boneIDCounterPerMesh(0) {
+    Options *options = assetManager->getGlHelper()->getOptions();
+    poseCacheQuantization = options->getAnimationPoseCacheQuantization();
+    poseCacheTolerance = options->getAnimationPoseCacheTolerance();
+    poseCacheMaximumSize = options->getAnimationPoseCacheMaximumSize();
+    poseCacheMutex = SDL_CreateMutex();
+    animationCompressionTolerances.translate = options->getAnimationCompressionTranslateTolerance();
+    animationCompressionTolerances.rotation = options->getAnimationCompressionRotationTolerance();
+    animationCompressionTolerances.scale = options->getAnimationCompressionScaleTolerance();
     if (fileList.empty()) {
         std::cerr << "Model load failed because file name vector is empty." << std::endl;
         exit(-1);
@@ -76,6 +86,7 @@ ModelAsset::ModelAsset(AssetManager *assetManager, uint32_t assetID, const std::
     this->rootNode = loadNodeTree(scene->mRootNode);
 
     createMeshes(scene, scene->mRootNode, glm::mat4(1.0f));
+    buildSkeleton(rootNode, -1);
     if(this->hasAnimation) {
         fillAnimationSet(scene->mNumAnimations, scene->mAnimations);
     }
@@ -338,20 +349,6 @@ std::shared_ptr<BoneNode> ModelAsset::loadNodeTree(aiNode *aiNode) {
     return currentNode;
 }
 
-bool ModelAsset::findNode(const std::string &nodeName, std::shared_ptr<BoneNode>& foundNode, std::shared_ptr<BoneNode> searchRoot) const {
-    if (nodeName == searchRoot->name) {
-        foundNode = searchRoot;
-        return true;
-    } else {
-        for (unsigned int i = 0; i < searchRoot->children.size(); ++i) {
-            if (findNode(nodeName, foundNode, searchRoot->children[i])) {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
 /**
  * Blends two animations to generate transform matrix vector
  *
@@ -368,7 +365,10 @@ bool ModelAsset::findNode(const std::string &nodeName, std::shared_ptr<BoneNode>
 bool ModelAsset::getTransformBlended(std::string animationNameOld, long timeOld, bool loopedOld,
                                      std::string animationNameNew, long timeNew, bool loopedNew,
                                                 float blendFactor,
-                                                std::vector<glm::mat4> &transformMatrix) const {
+                                                std::vector<glm::mat4> &transformMatrix,
+                                                std::vector<AnimationNode::Cursor> *cursorsOld,
+                                                std::vector<AnimationNode::Cursor> *cursorsNew,
+                                                uint32_t skippedBoneLevels, SampledPose *sampledPose) const {
 
 /*
     for(auto it = animations.begin(); it != animations.end(); it++) {
@@ -378,28 +378,26 @@ bool ModelAsset::getTransformBlended(std::string animationNameOld, long timeOld,
     if((animationNameOld.empty() || animationNameOld == "") &&
       (animationNameNew.empty() || animationNameNew == "")) {
         //if no animation name is provided, we return bind pose by default
-        for(std::unordered_map<std::string, BoneInformation>::const_iterator it = boneInformationMap.begin(); it != boneInformationMap.end(); it++){
-            std::shared_ptr<BoneNode> node;
-            std::string name = it->first;
-            if(findNode(name, node, rootNode)) {
-                transformMatrix[node->boneID] = boneInformationMap.at(node->name).parentOffset;
-                //parent above means parent transform of the mesh node, not the parent of bone.
-            }
+        setBindPose(transformMatrix);
+        if(sampledPose != nullptr) {
+            sampledPose->sampled.clear();
         }
         std::cout << "bind pose returned. for animation name [" << animationNameOld << "]"<< std::endl;
         return true;
     }
 
     std::shared_ptr<const AnimationInterface> currentAnimationOld = nullptr;
+    const std::vector<int32_t> *channelsOld = nullptr;
     float animationTimeOld;
     bool isFinishedOld = false;
     if(!(animationNameOld.empty() ||animationNameOld == "")) {
-        if (animations.find(animationNameOld) != animations.end()) {
-            currentAnimationOld = animations.at(animationNameOld);
-        } else {
+        auto animationIt = animations.find(animationNameOld);
+        if (animationIt == animations.end()) {
             std::cerr << "Animation " << animationNameOld << " not found, playing first animation. " << std::endl;
-            currentAnimationOld = animations.begin()->second;
+            animationIt = animations.begin();
         }
+        currentAnimationOld = animationIt->second;
+        channelsOld = &animationChannels.at(animationIt->first);
 
         float ticksPerSecond;
         if (currentAnimationOld->getTicksPerSecond() != 0) {
@@ -422,15 +420,17 @@ bool ModelAsset::getTransformBlended(std::string animationNameOld, long timeOld,
     }
 
     std::shared_ptr<const AnimationInterface> currentAnimationNew = nullptr;
+    const std::vector<int32_t> *channelsNew = nullptr;
     float animationTimeNew;
     bool isFinishedNew = false;
     if(!(animationNameNew.empty() ||animationNameNew == "")) {
-        if (animations.find(animationNameNew) != animations.end()) {
-            currentAnimationNew = animations.at(animationNameNew);
-        } else {
+        auto animationIt = animations.find(animationNameNew);
+        if (animationIt == animations.end()) {
             std::cerr << "Animation " << animationNameNew << " not found, playing first animation. " << std::endl;
-            currentAnimationNew = animations.begin()->second;
+            animationIt = animations.begin();
         }
+        currentAnimationNew = animationIt->second;
+        channelsNew = &animationChannels.at(animationIt->first);
 
         float ticksPerSecond;
         if (currentAnimationNew->getTicksPerSecond() != 0) {
@@ -454,17 +454,18 @@ bool ModelAsset::getTransformBlended(std::string animationNameOld, long timeOld,
 
     //at this point, it is possible one of the animations doesn't exists, if both didn't we would have returned bind pose.
     //if one of them is not found, return single animation, and log the issue
-    glm::mat4 parentTransform(1.0f);
-
     if(currentAnimationOld == nullptr) {
         std::cerr << "Animation blend fail, old animation "<< animationNameOld <<" not found" << std::endl;
-        traverseAndSetTransform(rootNode, parentTransform, currentAnimationNew, animationTimeNew, transformMatrix);
+        setTransforms(*currentAnimationNew, *channelsNew, animationTimeNew, transformMatrix, cursorsNew, skippedBoneLevels,
+                      sampledPose);
     } else if(currentAnimationNew == nullptr) {
         std::cerr << "Animation blend fail, new animation "<< animationNameNew <<" not found" << std::endl;
-        traverseAndSetTransform(rootNode, parentTransform, currentAnimationOld, animationTimeOld, transformMatrix);
+        setTransforms(*currentAnimationOld, *channelsOld, animationTimeOld, transformMatrix, cursorsOld, skippedBoneLevels,
+                      sampledPose);
     } else {
-        traverseAndSetTransformBlended(rootNode, parentTransform, currentAnimationOld, animationTimeOld,
-                                       currentAnimationNew, animationTimeNew, blendFactor, transformMatrix);
+        setTransformsBlended(*currentAnimationOld, *channelsOld, animationTimeOld, cursorsOld,
+                             *currentAnimationNew, *channelsNew, animationTimeNew, cursorsNew, blendFactor,
+                             skippedBoneLevels, transformMatrix, sampledPose);
     }
     return isFinishedOld && isFinishedNew;
 }
@@ -481,7 +482,9 @@ bool ModelAsset::getTransformBlended(std::string animationNameOld, long timeOld,
  *
  * @return if last frame of animation is played for not looped animation. Always false for looped ones.
  */
-bool ModelAsset::getTransform(long time, bool looped, std::string animationName, std::vector<glm::mat4> &transformMatrix) const {
+bool ModelAsset::getTransform(long time, bool looped, std::string animationName, std::vector<glm::mat4> &transformMatrix,
+                              std::vector<AnimationNode::Cursor> *cursors, uint32_t skippedBoneLevels,
+                              SampledPose *sampledPose) const {
 /*
     for(auto it = animations.begin(); it != animations.end(); it++) {
         std::cout << "Animations name: " << it->first << " size " << animations.size() <<std::endl;
@@ -491,25 +494,20 @@ bool ModelAsset::getTransform(long time, bool looped, std::string animationName,
         //this means return to bind pose
         //FIXME calculating bind pose for each frame is wrong, but I am assuming this part will be removed, and idle pose
         //will be used instead. If bind pose requirement arises, it should set once, and reused.
-        for(std::unordered_map<std::string, BoneInformation>::const_iterator it = boneInformationMap.begin(); it != boneInformationMap.end(); it++){
-            std::shared_ptr<BoneNode> node;
-            std::string name = it->first;
-            if(findNode(name, node, rootNode)) {
-                transformMatrix[node->boneID] = boneInformationMap.at(node->name).parentOffset;
-                //parent above means parent transform of the mesh node, not the parent of bone.
-            }
+        setBindPose(transformMatrix);
+        if(sampledPose != nullptr) {
+            sampledPose->sampled.clear();
         }
         std::cout << "bind pose returned. for animation name [" << animationName << "]"<< std::endl;
         return true;
     }
 
-    std::shared_ptr<const AnimationInterface> currentAnimation;
-    if(animations.find(animationName) != animations.end()) {
-        currentAnimation = animations.at(animationName);
-    } else {
+    auto animationIt = animations.find(animationName);
+    if(animationIt == animations.end()) {
         std::cerr << "Animation " << animationName << " not found, playing first animation. " << std::endl;
-        currentAnimation = animations.begin()->second;
+        animationIt = animations.begin();
     }
+    std::shared_ptr<const AnimationInterface> currentAnimation = animationIt->second;
 
     float animationTime;
     float ticksPerSecond;
@@ -532,102 +530,274 @@ bool ModelAsset::getTransform(long time, bool looped, std::string animationName,
         }
     }
 
-    glm::mat4 parentTransform(1.0f);
-    traverseAndSetTransform(rootNode, parentTransform, currentAnimation, animationTime, transformMatrix);
+    if(poseCacheQuantization <= 0) {
+        setTransforms(*currentAnimation, animationChannels.at(animationIt->first), animationTime, transformMatrix, cursors,
+                      skippedBoneLevels, sampledPose);
+        return result;
+    }
+
+    //cached poses are evaluated at the closest bucket time, not at the time of the instance that fills the bucket.
+    //Otherwise the cached pose would depend on which instance is updated first, which is not fixed with parallel updates
+    float timeInMilliseconds = animationTime / ticksPerSecond * 1000.0f;
+    PoseCacheKey key;
+    key.animation = currentAnimation.get();
+    key.timeBucket = (int64_t)std::floor(timeInMilliseconds / poseCacheQuantization + 0.5f);
+    key.skippedBoneLevels = skippedBoneLevels;
+    float bucketTimeInMilliseconds = key.timeBucket * poseCacheQuantization;
+    if(std::fabs(bucketTimeInMilliseconds - timeInMilliseconds) > poseCacheTolerance) {
+        setTransforms(*currentAnimation, animationChannels.at(animationIt->first), animationTime, transformMatrix, cursors,
+                      skippedBoneLevels, sampledPose);
+        return result;
+    }
+    if(!getCachedPose(key, transformMatrix, sampledPose)) {
+        //cursors are not moved on cache hits, they are only hints so the next miss searches the keys
+        static thread_local SampledPose evaluatedPose;
+        float bucketTime = std::min(bucketTimeInMilliseconds / 1000.0f * ticksPerSecond, currentAnimation->getDuration());
+        setTransforms(*currentAnimation, animationChannels.at(animationIt->first), bucketTime, transformMatrix, cursors,
+                      skippedBoneLevels, &evaluatedPose);
+        setCachedPose(key, transformMatrix, evaluatedPose);
+        if(sampledPose != nullptr) {
+            *sampledPose = evaluatedPose;
+        }
+    }
     return result;
 }
 
-void ModelAsset::traverseAndSetTransformBlended(std::shared_ptr<const BoneNode> boneNode, const glm::mat4 &parentTransform,
-                                                std::shared_ptr<const AnimationInterface> animationOld,
-                                                float timeInTicksOld,
-                                                std::shared_ptr<const AnimationInterface> animationNew,
-                                                float timeInTicksNew,
-                                                float blendFactor,
-                                                std::vector<glm::mat4> &transforms) const {
-
-    glm::mat4 nodeTransform;
-    Transformation tf1, tf2;
-    bool status = animationOld->calculateTransform(boneNode->name, timeInTicksOld, tf1);
-    bool status2 = animationNew->calculateTransform(boneNode->name, timeInTicksNew, tf2);
-
-    if(!status && !status2) {
-        nodeTransform = boneNode->transformation;//if both failed
-    } else if(!status) {
-        nodeTransform = tf2.getWorldTransform();//if only first failed(only by else)
-    } else if(!status2) {
-        nodeTransform = tf1.getWorldTransform();//if only second failed(only by else)
-    } else {//if both succeed
-        //now blend tf1 and tf2
-        Transformation blended;
-
-        glm::vec3 scaleDelta = tf2.getScale() - tf1.getScale();
-        blended.setScale(tf1.getScale() + blendFactor * scaleDelta);
+bool ModelAsset::getCachedPose(const PoseCacheKey &key, std::vector<glm::mat4> &transforms,
+                               SampledPose *sampledPose) const {
+    bool found = false;
+    SDL_LockMutex(poseCacheMutex);
+    auto cacheIt = poseCache.find(key);
+    if(cacheIt != poseCache.end() && cacheIt->second.transforms.size() == transforms.size()) {
+        std::copy(cacheIt->second.transforms.begin(), cacheIt->second.transforms.end(), transforms.begin());
+        if(sampledPose != nullptr) {
+            *sampledPose = cacheIt->second.sampledPose;
+        }
+        found = true;
+        poseCacheHits++;
+    } else {
+        poseCacheMisses++;
+    }
+    SDL_UnlockMutex(poseCacheMutex);
+    return found;
+}
 
-        glm::vec3 translateDelta = tf2.getTranslate() - tf1.getTranslate();
-        blended.setTranslate(tf1.getTranslate() + blendFactor * translateDelta);
+void ModelAsset::setCachedPose(const PoseCacheKey &key, const std::vector<glm::mat4> &transforms,
+                               const SampledPose &sampledPose) const {
+    //pose keeps 10 floats per node
+    size_t entrySize = sizeof(PoseCacheKey) + sizeof(PoseCacheEntry) + transforms.size() * sizeof(glm::mat4) +
+                       sampledPose.sampled.size() * (10 * sizeof(float) + sizeof(uint8_t));
+    SDL_LockMutex(poseCacheMutex);
+    //if another instance evaluated the same bucket meanwhile, it evaluated the same pose, first one is kept
+    if(poseCache.find(key) == poseCache.end()) {
+        if(poseCacheSize + entrySize > poseCacheMaximumSize) {
+            poseCache.clear();
+            poseCacheSize = 0;
+        }
+        PoseCacheEntry &entry = poseCache[key];
+        entry.transforms = transforms;
+        entry.sampledPose = sampledPose;
+        poseCacheSize += entrySize;
+    }
+    SDL_UnlockMutex(poseCacheMutex);
+}
 
-        blended.setOrientation(glm::normalize(slerp(tf1.getOrientation(), tf2.getOrientation(), blendFactor)));
+void ModelAsset::clearPoseCache() {
+    SDL_LockMutex(poseCacheMutex);
+    poseCache.clear();
+    poseCacheSize = 0;
+    SDL_UnlockMutex(poseCacheMutex);
+}
 
-        nodeTransform = blended.getWorldTransform();
+void ModelAsset::buildSkeleton(std::shared_ptr<const BoneNode> boneNode, int32_t parentIndex) {
+    int32_t nodeIndex = (int32_t)skeleton.names.size();
+    skeleton.names.push_back(boneNode->name);
+    skeleton.parents.push_back(parentIndex);
+    skeleton.boneIDs.push_back((uint32_t)boneNode->boneID);
+    skeleton.bindTransforms.push_back(boneNode->transformation);
+    skeleton.leafLevels.push_back(0);
+    auto boneInformationIt = boneInformationMap.find(boneNode->name);
+    if(boneInformationIt != boneInformationMap.end()) {
+        skeleton.hasBoneInformation.push_back(1);
+        skeleton.meshTransforms.push_back(boneInformationIt->second.globalMeshInverse * boneInformationIt->second.parentOffset);
+        skeleton.offsets.push_back(boneInformationIt->second.offset);
+        skeleton.parentOffsets.push_back(boneInformationIt->second.parentOffset);
+    } else {
+        skeleton.hasBoneInformation.push_back(0);
+        skeleton.meshTransforms.push_back(glm::mat4(1.0f));
+        skeleton.offsets.push_back(glm::mat4(1.0f));
+        skeleton.parentOffsets.push_back(glm::mat4(1.0f));
     }
+    for (unsigned int i = 0; i < boneNode->children.size(); ++i) {
+        size_t childIndex = skeleton.names.size();
+        buildSkeleton(boneNode->children[i], nodeIndex);
+        if(skeleton.leafLevels[childIndex] < 255) {
+            skeleton.leafLevels[nodeIndex] = std::max(skeleton.leafLevels[nodeIndex],
+                                                      (uint8_t)(skeleton.leafLevels[childIndex] + 1));
+        }
+    }
+}
 
-    nodeTransform = parentTransform * nodeTransform;
-
-    if(boneInformationMap.find(boneNode->name) != boneInformationMap.end()) {
-        transforms[boneNode->boneID] =
-                boneInformationMap.at(boneNode->name).globalMeshInverse * boneInformationMap.at(boneNode->name).parentOffset * nodeTransform * boneInformationMap.at(boneNode->name).offset;
-        //parent above means parent transform of the mesh node, not the parent of bone.
+void ModelAsset::bindAnimationChannels(const std::string &animationName) {
+    std::shared_ptr<const AnimationInterface> animation = animations.at(animationName);
+    std::vector<int32_t> &channels = animationChannels[animationName];
+    channels.resize(skeleton.names.size());
+    for (size_t i = 0; i < skeleton.names.size(); ++i) {
+        channels[i] = animation->getChannelIndex(skeleton.names[i]);
     }
+}
 
-    //Call children even if parent does not have animation attached.
-    for (unsigned int i = 0; i < boneNode->children.size(); ++i) {
-        traverseAndSetTransformBlended(boneNode->children[i], nodeTransform, animationOld, timeInTicksOld, animationNew,
-                timeInTicksNew, blendFactor, transforms);
+void ModelAsset::setBindPose(std::vector<glm::mat4> &transforms) const {
+    for (size_t i = 0; i < skeleton.boneIDs.size(); ++i) {
+        if(skeleton.hasBoneInformation[i]) {
+            transforms[skeleton.boneIDs[i]] = skeleton.parentOffsets[i];
+            //parent above means parent transform of the mesh node, not the parent of bone.
+        }
     }
 }
 
-void ModelAsset::traverseAndSetTransform( std::shared_ptr<const BoneNode> boneNode, const glm::mat4 &parentTransform,
-                                          std::shared_ptr<const AnimationInterface> animation,
-                                    float timeInTicks,
-                                    std::vector<glm::mat4> &transforms) const {
+bool ModelAsset::samplePose(const AnimationInterface &animation, const std::vector<int32_t> &channels, float timeInTicks,
+                            std::vector<AnimationNode::Cursor> *cursors, uint32_t skippedBoneLevels,
+                            AnimationPose &pose, std::vector<uint8_t> &sampled) const {
+    size_t nodeCount = skeleton.boneIDs.size();
+    pose.resize(nodeCount);
+    sampled.resize(nodeCount);
+    AnimationNode::Cursor *nodeCursors = nullptr;
+    if(cursors != nullptr) {
+        cursors->resize(nodeCount);
+        nodeCursors = cursors->data();
+    }
+
+    bool anySampled = false;
+    glm::vec3 translate, scale;
+    glm::quat orientation;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        sampled[i] = channels[i] >= 0 && skeleton.leafLevels[i] >= skippedBoneLevels &&
+                     animation.calculateChannelTransform(channels[i], timeInTicks, translate, scale, orientation,
+                                                         nodeCursors == nullptr ? nullptr : &nodeCursors[i]);
+        if(sampled[i]) {
+            pose.set(i, translate, scale, orientation);
+            anySampled = true;
+        }
+    }
+    return anySampled;
+}
 
+void ModelAsset::setPalette(const AnimationPose &pose, const std::vector<uint8_t> &sampled,
+                            std::vector<glm::mat4> &transforms) const {
+    //transforms of all nodes are needed for children, even if they don't have bone information
+    static thread_local std::vector<glm::mat4> nodeTransforms;
+    nodeTransforms.resize(skeleton.boneIDs.size());
     glm::mat4 nodeTransform;
-    Transformation tf;
-    bool status = animation->calculateTransform(boneNode->name, timeInTicks, tf);
-    nodeTransform = tf.getWorldTransform();
+    for (size_t i = 0; i < skeleton.boneIDs.size(); ++i) {
+        if(sampled[i]) {
+            nodeTransform = pose.getMatrix(i);
+        } else {
+            nodeTransform = skeleton.bindTransforms[i];
+        }
 
-    if(!status) {
-        nodeTransform = boneNode->transformation;
-    }
+        if(skeleton.parents[i] >= 0) {
+            AnimationPose::multiply(nodeTransforms[skeleton.parents[i]], nodeTransform, nodeTransforms[i]);
+        } else {
+            nodeTransforms[i] = nodeTransform;
+        }
 
-    nodeTransform = parentTransform * nodeTransform;
+        if(skeleton.hasBoneInformation[i]) {
+            glm::mat4 &boneTransform = transforms[skeleton.boneIDs[i]];
+            AnimationPose::multiply(skeleton.meshTransforms[i], nodeTransforms[i], boneTransform);
+            AnimationPose::multiply(boneTransform, skeleton.offsets[i], boneTransform);
+            //parent above means parent transform of the mesh node, not the parent of bone.
+        }
+    }
+}
 
-    if(boneInformationMap.find(boneNode->name) != boneInformationMap.end()) {
-        transforms[boneNode->boneID] =
-                boneInformationMap.at(boneNode->name).globalMeshInverse * boneInformationMap.at(boneNode->name).parentOffset * nodeTransform * boneInformationMap.at(boneNode->name).offset;
-        //parent above means parent transform of the mesh node, not the parent of bone.
+void ModelAsset::setTransformsBlended(const AnimationInterface &animationOld, const std::vector<int32_t> &channelsOld,
+                                      float timeInTicksOld, std::vector<AnimationNode::Cursor> *cursorsOld,
+                                      const AnimationInterface &animationNew, const std::vector<int32_t> &channelsNew,
+                                      float timeInTicksNew, std::vector<AnimationNode::Cursor> *cursorsNew,
+                                      float blendFactor, uint32_t skippedBoneLevels,
+                                      std::vector<glm::mat4> &transforms, SampledPose *sampledPose) const {
+    static thread_local AnimationPose poseOld, poseNew, poseBlended;
+    static thread_local std::vector<uint8_t> sampledOld, sampledNew;
+    samplePose(animationOld, channelsOld, timeInTicksOld, cursorsOld, skippedBoneLevels, poseOld, sampledOld);
+    samplePose(animationNew, channelsNew, timeInTicksNew, cursorsNew, skippedBoneLevels, poseNew, sampledNew);
+
+    //if only one animation has the node, blending it with itself keeps it as is
+    for (size_t i = 0; i < skeleton.boneIDs.size(); ++i) {
+        if(!sampledOld[i] && sampledNew[i]) {
+            poseOld.copyBone(i, poseNew);
+            sampledOld[i] = 1;
+        } else if(sampledOld[i] && !sampledNew[i]) {
+            poseNew.copyBone(i, poseOld);
+        }
+    }
+    AnimationPose::blend(poseOld, poseNew, blendFactor, poseBlended);
+    //nodes that neither animation has are still not sampled, so they use the bind transform
+    setPalette(poseBlended, sampledOld, transforms);
+    if(sampledPose != nullptr) {
+        sampledPose->pose = poseBlended;
+        sampledPose->sampled = sampledOld;
     }
+}
 
-    //Call children even if parent does not have animation attached.
-    for (unsigned int i = 0; i < boneNode->children.size(); ++i) {
-        traverseAndSetTransform(boneNode->children[i], nodeTransform, animation, timeInTicks, transforms);
+void ModelAsset::setTransforms(const AnimationInterface &animation, const std::vector<int32_t> &channels,
+                               float timeInTicks, std::vector<glm::mat4> &transforms,
+                               std::vector<AnimationNode::Cursor> *cursors, uint32_t skippedBoneLevels,
+                               SampledPose *sampledPose) const {
+    static thread_local AnimationPose pose;
+    static thread_local std::vector<uint8_t> sampled;
+    samplePose(animation, channels, timeInTicks, cursors, skippedBoneLevels, pose, sampled);
+    setPalette(pose, sampled, transforms);
+    if(sampledPose != nullptr) {
+        sampledPose->pose = pose;
+        sampledPose->sampled = sampled;
     }
 }
 
+void ModelAsset::getTransform(const SampledPose &sampledPose, std::vector<glm::mat4> &transformMatrix) const {
+    setPalette(sampledPose.pose, sampledPose.sampled, transformMatrix);
+}
+
 bool ModelAsset::isAnimated() const {
     return hasAnimation;
 }
 
 void
 ModelAsset::fillAnimationSet(unsigned int numAnimation, aiAnimation **pAnimations, const std::string &animationNamePrefix) {
+    //totals of all model assets, so the log shows the saving for everything loaded so far
+    static std::atomic<size_t> totalUncompressedSize(0);
+    static std::atomic<size_t> totalCompressedSize(0);
+
     aiAnimation* currentAnimation;
+    size_t uncompressedSize = 0, compressedSize = 0;
+    float maximumTranslateError = 0.0f, maximumRotationError = 0.0f, maximumScaleError = 0.0f;
     for (unsigned int i = 0; i < numAnimation; ++i) {
         currentAnimation = pAnimations[i];
         std::string animationName = animationNamePrefix + currentAnimation->mName.C_Str();
         std::cout << "add animation with name " << animationNamePrefix << animationName << std::endl;
 
-        std::shared_ptr<AnimationAssimp> animationObject = std::make_shared<AnimationAssimp>(currentAnimation);
+        std::shared_ptr<AnimationAssimp> animationObject = std::make_shared<AnimationAssimp>(currentAnimation, animationCompressionTolerances);
         animations[animationName] = animationObject;
+        bindAnimationChannels(animationName);
+        clearPoseCache();//replaced animation might be cached
+
+        size_t animationUncompressedSize, animationCompressedSize;
+        float translateError, rotationError, scaleError;
+        animationObject->getCompressionStatistics(animationUncompressedSize, animationCompressedSize, translateError,
+                                                  rotationError, scaleError);
+        uncompressedSize += animationUncompressedSize;
+        compressedSize += animationCompressedSize;
+        maximumTranslateError = std::max(maximumTranslateError, translateError);
+        maximumRotationError = std::max(maximumRotationError, rotationError);
+        maximumScaleError = std::max(maximumScaleError, scaleError);
+    }
+    if (numAnimation > 0) {
+        totalUncompressedSize += uncompressedSize;
+        totalCompressedSize += compressedSize;
+        std::cout << "Animations of " << name << " compressed from " << uncompressedSize << " to " << compressedSize
+                  << " bytes, maximum error translate: " << maximumTranslateError << ", rotation: "
+                  << maximumRotationError << " radians, scale: " << maximumScaleError << ". All models: "
+                  << totalUncompressedSize << " to " << totalCompressedSize << " bytes." << std::endl;
     }
     //validate
 }
@@ -642,6 +812,8 @@ bool ModelAsset::addAnimationAsSubSequence(const std::string &baseAnimationName,
     std::shared_ptr<AnimationAssimpSection> animation = std::make_shared<AnimationAssimpSection>(animationAssimp, startTime, endTime);
 
     this->animations[newAnimationName] = animation;
+    bindAnimationChannels(newAnimationName);
+    clearPoseCache();//replaced animation might be cached
 
     this->animationSections.push_back(AnimationSection(baseAnimationName, newAnimationName, startTime, endTime));
     std::cout << "animation created and added to sections" << std::endl;
@@ -13,6 +13,7 @@
 #include <BulletCollision/CollisionShapes/btShapeHull.h>
 #include <cstdint>
 #include <unordered_map>
+#include <SDL2/SDL_mutex.h>
 
 #include "../Utils/AssimpUtils.h"
 #include "../Material.h"
@@ -21,6 +22,8 @@
 #include "../Utils/GLMConverter.h"
 #include "BoneNode.h"
 #include "Animations/AnimationInterface.h"
+#include "Animations/AnimationPose.h"
+#include "Animations/CompressedAnimationNode.h"
 
 
 class AnimationAssimp;
@@ -33,6 +36,62 @@ class ModelAsset : public Asset {
         glm::mat4 globalMeshInverse;
     };
 
+    /**
+     * Node tree flattened at load time. Nodes are in depth first order, so parents always come before their children,
+     * and evaluating is a single loop over the arrays without name lookups.
+     */
+    struct Skeleton {
+        std::vector<std::string> names;//only used to bind animation channels
+        std::vector<int32_t> parents;//-1 for root
+        std::vector<uint32_t> boneIDs;
+        std::vector<glm::mat4> bindTransforms;//used if animation has no channel for the node
+        std::vector<uint8_t> hasBoneInformation;//if not, node only passes its transform to children
+        std::vector<glm::mat4> meshTransforms;//globalMeshInverse * parentOffset
+        std::vector<glm::mat4> offsets;
+        std::vector<glm::mat4> parentOffsets;//for bind pose
+        std::vector<uint8_t> leafLevels;//0 for leaf nodes, otherwise 1 more than the highest child
+    };
+
+    /**
+     * Poses are cached per animation and time bucket, so instances playing the same animation at close times share
+     * the evaluation. Level of detail changes the pose, so it is part of the key. Cached pose is always evaluated at
+     * the bucket time, so it doesn't depend on which instance fills the bucket first.
+     */
+    struct PoseCacheKey {
+        const AnimationInterface *animation;
+        int64_t timeBucket;
+        uint32_t skippedBoneLevels;
+
+        bool operator==(const PoseCacheKey &other) const {
+            return animation == other.animation && timeBucket == other.timeBucket &&
+                   skippedBoneLevels == other.skippedBoneLevels;
+        }
+    };
+
+    struct PoseCacheKeyHash {
+        size_t operator()(const PoseCacheKey &key) const {
+            size_t hash = std::hash<const void *>()(key.animation);
+            hash ^= std::hash<int64_t>()(key.timeBucket) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            hash ^= std::hash<uint32_t>()(key.skippedBoneLevels) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
+public:
+    /**
+     * Local transforms an evaluation is built from, so callers can interpolate poses instead of skinning matrices.
+     */
+    struct SampledPose {
+        AnimationPose pose;
+        std::vector<uint8_t> sampled;//nodes that are not sampled use their bind transform. Empty for bind pose
+    };
+
+private:
+    struct PoseCacheEntry {
+        std::vector<glm::mat4> transforms;
+        SampledPose sampledPose;
+    };
+
     struct AnimationSection {
         std::string baseAnimationName;
         std::string animationName;
@@ -61,6 +120,21 @@ class ModelAsset : public Asset {
     std::unordered_map<std::string, std::shared_ptr<MeshAsset>> simplifiedMeshes;//physics
     std::unordered_map<std::string, BoneInformation> boneInformationMap;
 
+    Skeleton skeleton;
+    std::unordered_map<std::string, std::vector<int32_t>> animationChannels;//channel index of each skeleton node, per animation
+
+    //pose cache is shared by all instances, which can be updated from different threads
+    float poseCacheQuantization;
+    float poseCacheTolerance;
+    size_t poseCacheMaximumSize;
+    mutable SDL_mutex *poseCacheMutex;
+    mutable std::unordered_map<PoseCacheKey, PoseCacheEntry, PoseCacheKeyHash> poseCache;
+    mutable size_t poseCacheSize = 0;
+    mutable uint64_t poseCacheHits = 0;
+    mutable uint64_t poseCacheMisses = 0;
+
+    CompressedAnimationNode::Tolerances animationCompressionTolerances;
+
     bool hasAnimation;
     bool customizationAfterSave = false;
 
@@ -71,19 +145,46 @@ class ModelAsset : public Asset {
 
     std::shared_ptr<BoneNode> loadNodeTree(aiNode *aiNode);
 
-    bool findNode(const std::string &nodeName, std::shared_ptr<BoneNode>& foundNode, std::shared_ptr<BoneNode> searchRoot) const;
+    void buildSkeleton(std::shared_ptr<const BoneNode> boneNode, int32_t parentIndex);
+
+    void bindAnimationChannels(const std::string &animationName);
 
-    void traverseAndSetTransform(std::shared_ptr<const BoneNode> boneNode, const glm::mat4 &parentTransform, std::shared_ptr<const AnimationInterface> animation,
-                                 float timeInTicks,
-                                 std::vector<glm::mat4> &transforms) const;
+    /**
+     * Samples the local transform of each skeleton node to pose. Nodes the animation has no channel for are marked not
+     * sampled, and so are nodes with leaf level below skippedBoneLevels. @return true if any node is sampled
+     */
+    bool samplePose(const AnimationInterface &animation, const std::vector<int32_t> &channels, float timeInTicks,
+                    std::vector<AnimationNode::Cursor> *cursors, uint32_t skippedBoneLevels, AnimationPose &pose,
+                    std::vector<uint8_t> &sampled) const;
 
-    void traverseAndSetTransformBlended(std::shared_ptr<const BoneNode> boneNode, const glm::mat4 &parentTransform,
-                                        std::shared_ptr<const AnimationInterface> animationOld,
-                                        float timeInTicksOld,
-                                        std::shared_ptr<const AnimationInterface> animationNew,
-                                        float timeInTicksNew,
-                                        float blendFactor,
-                                        std::vector<glm::mat4> &transforms) const;
+    /**
+     * Accumulates pose down the hierarchy and writes the skinning matrix of each bone. Not sampled nodes use their
+     * bind transform.
+     */
+    void setPalette(const AnimationPose &pose, const std::vector<uint8_t> &sampled, std::vector<glm::mat4> &transforms) const;
+
+    void setTransforms(const AnimationInterface &animation, const std::vector<int32_t> &channels, float timeInTicks,
+                       std::vector<glm::mat4> &transforms, std::vector<AnimationNode::Cursor> *cursors,
+                       uint32_t skippedBoneLevels, SampledPose *sampledPose) const;
+
+    void setTransformsBlended(const AnimationInterface &animationOld, const std::vector<int32_t> &channelsOld,
+                              float timeInTicksOld, std::vector<AnimationNode::Cursor> *cursorsOld,
+                              const AnimationInterface &animationNew, const std::vector<int32_t> &channelsNew,
+                              float timeInTicksNew, std::vector<AnimationNode::Cursor> *cursorsNew,
+                              float blendFactor, uint32_t skippedBoneLevels,
+                              std::vector<glm::mat4> &transforms, SampledPose *sampledPose) const;
+
+    void setBindPose(std::vector<glm::mat4> &transforms) const;
+
+    /**
+     * @return true if pose for the key is cached, and copied to transforms, and sampledPose if it is not nullptr
+     */
+    bool getCachedPose(const PoseCacheKey &key, std::vector<glm::mat4> &transforms, SampledPose *sampledPose) const;
+
+    void setCachedPose(const PoseCacheKey &key, const std::vector<glm::mat4> &transforms,
+                       const SampledPose &sampledPose) const;
+
+    void clearPoseCache();
 
     const aiNodeAnim *findNodeAnimation(aiAnimation *pAnimation, std::string basic_string) const;
 
@@ -108,14 +209,30 @@ public:
      * @param looped if animation should loop or not. Effects return.
      * @param animationName name of animation to seek.
      * @param transformMatrix transform matrix list for bones
+     * @param cursors key cursors of the instance for this animation, kept between calls so forward playback doesn't
+     *                search keys. Can be nullptr.
+     * @param skippedBoneLevels nodes closer to a leaf than this are not sampled and stay at bind pose, 0 samples all.
+     *                          1 skips leaf nodes, which are usually end markers, 2 also skips finger tips. Used as
+     *                          level of detail for far models.
+     * @param sampledPose if not nullptr, local pose the transforms are built from is copied here
      *
      * @return if last frame of animation is played for not looped animation. Always true for looped ones.
      */
-    bool getTransform(long time, bool looped, std::string animationName, std::vector<glm::mat4> &transformMatrix) const; //this method takes vector to avoid copying it
+    bool getTransform(long time, bool looped, std::string animationName, std::vector<glm::mat4> &transformMatrix,
+                      std::vector<AnimationNode::Cursor> *cursors = nullptr,
+                      uint32_t skippedBoneLevels = 0, SampledPose *sampledPose = nullptr) const; //this method takes vector to avoid copying it
 
     bool getTransformBlended(std::string animationName1, long time1, bool looped1,
                                          std::string animationName2, long time2, bool looped2,
-                                         float blendFactor, std::vector<glm::mat4> &transformMatrixVector) const;
+                                         float blendFactor, std::vector<glm::mat4> &transformMatrixVector,
+                                         std::vector<AnimationNode::Cursor> *cursors1 = nullptr,
+                                         std::vector<AnimationNode::Cursor> *cursors2 = nullptr,
+                                         uint32_t skippedBoneLevels = 0, SampledPose *sampledPose = nullptr) const;
+
+    /**
+     * Builds bone transforms from a pose returned by getTransform or getTransformBlended, or interpolated from them.
+     */
+    void getTransform(const SampledPose &sampledPose, std::vector<glm::mat4> &transformMatrix) const;
 
     const glm::vec3 &getBoundingBoxMin() const { return boundingBoxMin; }
 
@@ -130,6 +247,20 @@ public:
 
     ~ModelAsset() {
         //FIXME GPU side is not freed
+        SDL_DestroyMutex(poseCacheMutex);
+    }
+
+    /**
+     * @param hits number of poses served from cache since load
+     * @param misses number of poses evaluated while cache was enabled
+     * @param size bytes used by cached poses
+     */
+    void getPoseCacheStatistics(uint64_t &hits, uint64_t &misses, size_t &size) const {
+        SDL_LockMutex(poseCacheMutex);
+        hits = poseCacheHits;
+        misses = poseCacheMisses;
+        size = poseCacheSize;
+        SDL_UnlockMutex(poseCacheMutex);
     }
 
     std::vector<std::shared_ptr<MeshAsset>> getMeshes() const {
@@ -0,0 +1,92 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <algorithm>
+#include "CullingTree.h"
+#include "PhysicalRenderable.h"
+
+namespace {
+    struct CollectLeaves : btDbvt::ICollide {
+        std::vector<PhysicalRenderable *> &result;
+
+        explicit CollectLeaves(std::vector<PhysicalRenderable *> &result) : result(result) {}
+
+        void Process(const btDbvtNode *leaf) override {
+            result.push_back(static_cast<PhysicalRenderable *>(leaf->data));
+        }
+    };
+}
+
+btDbvtVolume CullingTree::buildVolume(PhysicalRenderable *object) {
+    //point light checks use the translate, which is not always in the AABB
+    const glm::vec3 &translate = object->getTransformation()->getTranslate();
+    glm::vec3 volumeMin = glm::min(object->getAabbMin(), translate);
+    glm::vec3 volumeMax = glm::max(object->getAabbMax(), translate);
+    return btDbvtVolume::FromMM(btVector3(volumeMin.x, volumeMin.y, volumeMin.z),
+                                btVector3(volumeMax.x, volumeMax.y, volumeMax.z));
+}
+
+void CullingTree::insert(PhysicalRenderable *object) {
+    if (entries.find(object) != entries.end()) {
+        return;
+    }
+    btDbvtVolume volume = buildVolume(object);
+    volume.Expand(btVector3(margin, margin, margin));
+    entries[object] = Entry{tree.insert(volume, object), false};
+    object->setCullingTree(this);
+}
+
+void CullingTree::remove(PhysicalRenderable *object) {
+    auto entryIt = entries.find(object);
+    if (entryIt == entries.end()) {
+        return;
+    }
+    tree.remove(entryIt->second.leaf);
+    if (entryIt->second.moved) {
+        movedObjects.erase(std::find(movedObjects.begin(), movedObjects.end(), object));
+    }
+    entries.erase(entryIt);
+    object->setCullingTree(nullptr);
+}
+
+void CullingTree::markMoved(PhysicalRenderable *object) {
+    auto entryIt = entries.find(object);
+    if (entryIt == entries.end() || entryIt->second.moved) {
+        return;
+    }
+    entryIt->second.moved = true;
+    movedObjects.push_back(object);
+}
+
+void CullingTree::refit(std::vector<PhysicalRenderable *> &movedObjectsOut) {
+    for (PhysicalRenderable *object : movedObjects) {
+        Entry &entry = entries[object];
+        entry.moved = false;
+        btDbvtVolume volume = buildVolume(object);
+        //only reinserts if the object left its fat leaf
+        tree.update(entry.leaf, volume, margin);
+    }
+    movedObjectsOut.insert(movedObjectsOut.end(), movedObjects.begin(), movedObjects.end());
+    movedObjects.clear();
+    //keeps the tree balanced as objects move
+    tree.optimizeIncremental(1);
+}
+
+void CullingTree::queryFrustum(const std::vector<glm::vec4> &planes, std::vector<PhysicalRenderable *> &result) const {
+    btVector3 normals[6];
+    btScalar offsets[6];
+    for (int i = 0; i < 6; ++i) {
+        normals[i] = btVector3(planes[i].x, planes[i].y, planes[i].z);
+        offsets[i] = planes[i].w;
+    }
+    CollectLeaves collector(result);
+    btDbvt::collideKDOP(tree.m_root, normals, offsets, 6, collector);
+}
+
+void CullingTree::queryAABB(const glm::vec3 &aabbMin, const glm::vec3 &aabbMax,
+                            std::vector<PhysicalRenderable *> &result) const {
+    CollectLeaves collector(result);
+    tree.collideTV(tree.m_root, btDbvtVolume::FromMM(btVector3(aabbMin.x, aabbMin.y, aabbMin.z),
+                                                     btVector3(aabbMax.x, aabbMax.y, aabbMax.z)), collector);
+}
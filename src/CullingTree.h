@@ -0,0 +1,72 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_CULLINGTREE_H
+#define LIMONENGINE_CULLINGTREE_H
+
+
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include <BulletCollision/BroadphaseCollision/btDbvt.h>
+
+class PhysicalRenderable;
+
+/**
+ * Bounding volume hierarchy over the AABBs of world objects, used to find frustum culling candidates without
+ * testing every object.
+ *
+ * Leaves are fattened by a margin, an object that moves within its leaf doesn't change the tree. Objects report AABB
+ * changes with markMoved, and the tree is refitted once per frame, before queries.
+ *
+ * Queries are conservative, every returned object should still be tested against its own AABB.
+ */
+class CullingTree {
+    struct Entry {
+        btDbvtNode *leaf;
+        bool moved;
+    };
+
+    btDbvt tree;
+    std::unordered_map<PhysicalRenderable *, Entry> entries;
+    std::vector<PhysicalRenderable *> movedObjects;
+    const float margin;
+
+    static btDbvtVolume buildVolume(PhysicalRenderable *object);
+
+public:
+    explicit CullingTree(float margin = 0.5f) : margin(margin) {}
+
+    CullingTree(const CullingTree &) = delete;
+    CullingTree &operator=(const CullingTree &) = delete;
+
+    void insert(PhysicalRenderable *object);
+
+    void remove(PhysicalRenderable *object);
+
+    /**
+     * Queues object for refit. Called by the object when its AABB changes, object must be inserted.
+     */
+    void markMoved(PhysicalRenderable *object);
+
+    /**
+     * Updates leaves of objects that are marked as moved since last call.
+     * @param movedObjectsOut filled with moved objects
+     */
+    void refit(std::vector<PhysicalRenderable *> &movedObjectsOut);
+
+    /**
+     * @param planes 6 planes, pointing inside, same as GLHelper::isInFrustum
+     */
+    void queryFrustum(const std::vector<glm::vec4> &planes, std::vector<PhysicalRenderable *> &result) const;
+
+    void queryAABB(const glm::vec3 &aabbMin, const glm::vec3 &aabbMax, std::vector<PhysicalRenderable *> &result) const;
+
+    size_t getSize() const {
+        return entries.size();
+    }
+};
+
+
+#endif //LIMONENGINE_CULLINGTREE_H
@@ -11,6 +11,8 @@
 #include "GameObjects/Model.h"
 #include "Utils/GLMUtils.h"
 
+const uint32_t GLHelper::INVALID_HANDLE;
+
 GLuint GLHelper::createShader(GLenum eShaderType, const std::string &strShaderFile) {
     GLuint shader = glCreateShader(eShaderType);
     std::string shaderCode;
@@ -155,30 +157,13 @@ void GLHelper::fillUniformMap(const GLuint program, std::unordered_map<std::stri
     delete[] name;
 }
 
-void GLHelper::attachModelUBO(const uint32_t program) {
-    GLuint allModelsAttachPoint = 7;
-
-    int uniformIndex = glGetUniformBlockIndex(program, "ModelInformationBlock");
-    if (uniformIndex >= 0) {
-        glBindBuffer(GL_UNIFORM_BUFFER, allModelsUBOLocation);
-        glUniformBlockBinding(program, uniformIndex, allModelsAttachPoint);
-        glBindBufferRange(GL_UNIFORM_BUFFER, allModelsAttachPoint, allModelsUBOLocation, 0,
-                          sizeof(glm::mat4)* NR_MAX_MODELS);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-    }
-}
-
-void GLHelper::attachModelIndicesUBO(const uint32_t programID) {
-    GLuint allModelIndexesAttachPoint = 8;
-
-    int uniformIndex = glGetUniformBlockIndex(programID, "ModelIndexBlock");
-    if (uniformIndex >= 0) {
-        glBindBuffer(GL_UNIFORM_BUFFER, allModelIndexesUBOLocation);
-        glUniformBlockBinding(programID, uniformIndex, allModelIndexesAttachPoint);
-        glBindBufferRange(GL_UNIFORM_BUFFER, allModelIndexesAttachPoint, allModelIndexesUBOLocation, 0,
-                          sizeof(uint32_t) * NR_MAX_MODELS);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-    }
+void GLHelper::attachModelTransformBuffer(const uint32_t program __attribute((unused))) {
+    //samplers are set on program creation, only the textures should be attached
+    state->attachTextureBuffer(allModelsTransformTexture, getModelTransformAttachPoint());
+    state->attachTextureBuffer(allModelIndexesTexture, getModelIndexAttachPoint());
+    state->attachTextureBuffer(allBonePalettesTexture, getBonePaletteAttachPoint());
+    state->attachTextureBuffer(allModelPaletteIndexesTexture, getModelPaletteIndexAttachPoint());
+    checkErrors("attachModelTransformBuffer");
 }
 
 void GLHelper::attachMaterialUBO(const uint32_t program, const uint32_t materialID){
@@ -219,6 +204,110 @@ void GLHelper::attachGeneralUBOs(const GLuint program){//Attach the light block
                           playerUniformSize);
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
     }
+
+    //model transform and index texture buffers use fixed texture units, so samplers can be set once
+    GLint modelTransformsLocation = glGetUniformLocation(program, "allModelTransforms");
+    if (modelTransformsLocation >= 0) {
+        state->setProgram(program);
+        glUniform1i(modelTransformsLocation, getModelTransformAttachPoint());
+    }
+    GLint modelIndexesLocation = glGetUniformLocation(program, "allModelIndexes");
+    if (modelIndexesLocation >= 0) {
+        state->setProgram(program);
+        glUniform1i(modelIndexesLocation, getModelIndexAttachPoint());
+    }
+    GLint bonePalettesLocation = glGetUniformLocation(program, "allBonePalettes");
+    if (bonePalettesLocation >= 0) {
+        state->setProgram(program);
+        glUniform1i(bonePalettesLocation, getBonePaletteAttachPoint());
+    }
+    GLint modelPaletteIndexesLocation = glGetUniformLocation(program, "allModelPaletteIndexes");
+    if (modelPaletteIndexesLocation >= 0) {
+        state->setProgram(program);
+        glUniform1i(modelPaletteIndexesLocation, getModelPaletteIndexAttachPoint());
+    }
+    GLint clusteredLightsLocation = glGetUniformLocation(program, "clusteredLights");
+    if (clusteredLightsLocation >= 0) {
+        state->setProgram(program);
+        glUniform1i(clusteredLightsLocation, getClusteredLightAttachPoint());
+    }
+    GLint lightClustersLocation = glGetUniformLocation(program, "lightClusters");
+    if (lightClustersLocation >= 0) {
+        state->setProgram(program);
+        glUniform1i(lightClustersLocation, getLightClusterAttachPoint());
+    }
+}
+
+void GLHelper::createTextureBuffer(GLenum internalFormat, uint32_t sizeInBytes, GLuint &buffer, GLuint &texture) {
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeInBytes, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    checkErrors("createTextureBuffer");
+}
+
+/**
+ * Creates a bigger buffer, copies the old content to it, and points the texture to the new buffer.
+ * Since texture object doesn't change, programs and texture units don't need to be updated.
+ *
+ * @return false if requested size is bigger then what GPU supports, buffer is not changed in that case
+ */
+bool GLHelper::growTextureBuffer(GLenum internalFormat, uint32_t texelSize, uint32_t oldSizeInBytes,
+                                 uint32_t newSizeInBytes, GLuint &buffer, GLuint texture) {
+    if(!isTextureBufferSizeSupported(texelSize, newSizeInBytes)) {
+        std::cerr << "Texture buffer can't grow to " << newSizeInBytes << " bytes, maximum supported texel count is "
+                  << maxTextureBufferSize << std::endl;
+        return false;
+    }
+    GLuint newBuffer;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newSizeInBytes, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSizeInBytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    state->activateTextureUnit(0);//this is the default working texture
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, newBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    glDeleteBuffers(1, &buffer);
+    buffer = newBuffer;
+    checkErrors("growTextureBuffer");
+    return true;
+}
+
+bool GLHelper::replaceTextureBufferData(GLuint buffer, uint32_t texelSize, const void *data, uint32_t sizeInBytes,
+                                        uint32_t &capacityInBytes) {
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    if(sizeInBytes > capacityInBytes) {
+        uint32_t newCapacity = capacityInBytes;
+        while(newCapacity < sizeInBytes) {
+            newCapacity = newCapacity * 2;
+        }
+        if(newCapacity / texelSize > (uint32_t)maxTextureBufferSize) {
+            std::cerr << "Texture buffer can't grow to " << newCapacity << " bytes, maximum supported texel count is "
+                      << maxTextureBufferSize << std::endl;
+            glBindBuffer(GL_TEXTURE_BUFFER, 0);
+            return false;
+        }
+        //content is replaced completely, so the storage is reallocated instead of copied. Texture keeps the buffer.
+        glBufferData(GL_TEXTURE_BUFFER, newCapacity, nullptr, GL_DYNAMIC_DRAW);
+        capacityInBytes = newCapacity;
+    }
+    if(sizeInBytes > 0) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeInBytes, data);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    checkErrors("replaceTextureBufferData");
+    return true;
 }
 
 
@@ -333,18 +422,33 @@ GLHelper::GLHelper(Options *options): options(options) {
     glBufferData(GL_UNIFORM_BUFFER, materialUniformSize * NR_MAX_MATERIALS, nullptr, GL_STATIC_DRAW);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-    //create model uniform buffer object
-    glGenBuffers(1, &allModelsUBOLocation);
-    glBindBuffer(GL_UNIFORM_BUFFER, allModelsUBOLocation);
-    glBufferData(GL_UNIFORM_BUFFER, modelUniformSize * NR_MAX_MODELS, nullptr, GL_STATIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-    //create model index uniform buffer object
-    glGenBuffers(1, &allModelIndexesUBOLocation);
-    glBindBuffer(GL_UNIFORM_BUFFER, allModelIndexesUBOLocation);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(uint32_t) * NR_MAX_MODELS, nullptr, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTextureBufferSize);
+    std::cout << "Maximum texture buffer size is " << maxTextureBufferSize << " texels" << std::endl;
+
+    //create model transform texture buffer, each transform is 4 RGBA32F texels
+    createTextureBuffer(GL_RGBA32F, sizeof(glm::mat4) * modelTransformCapacity, allModelsTransformBuffer, allModelsTransformTexture);
+    modelTransforms.resize(modelTransformCapacity);
+    dirtyModelTransforms.resize((modelTransformCapacity + 63) / 64, 0);
+
+    //create model index texture buffer
+    createTextureBuffer(GL_R32UI, sizeof(uint32_t) * modelIndexCapacity, allModelIndexesBuffer, allModelIndexesTexture);
+
+    //create bone palette texture buffer, and palette index of each transform slot
+    createTextureBuffer(GL_RGBA32F, sizeof(glm::mat4) * NR_BONE * bonePaletteCapacity, allBonePalettesBuffer,
+                        allBonePalettesTexture);
+    bonePalettes.resize(NR_BONE * bonePaletteCapacity);
+    dirtyBonePalettes.resize((bonePaletteCapacity + 63) / 64, 0);
+    createTextureBuffer(GL_R32UI, sizeof(uint32_t) * modelTransformCapacity, allModelPaletteIndexesBuffer,
+                        allModelPaletteIndexesTexture);
+    modelPaletteIndexes.resize(modelTransformCapacity, 0);
+
+    //create clustered light texture buffers, light clusters index into light data
+    createTextureBuffer(GL_RGBA32F, clusteredLightsCapacity, clusteredLightsBuffer, clusteredLightsTexture);
+    createTextureBuffer(GL_R32UI, lightClustersCapacity, lightClustersBuffer, lightClustersTexture);
+    std::vector<uint32_t> emptyClusters(2 * LightClusters::CLUSTER_COUNT, 0);//no lights until first setLightClusters
+    glBindBuffer(GL_TEXTURE_BUFFER, lightClustersBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, emptyClusters.size() * sizeof(uint32_t), emptyClusters.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
 
     //create depth buffer and texture for directional shadow map
     glGenFramebuffers(1, &depthOnlyFrameBufferDirectional);
@@ -393,6 +497,32 @@ GLHelper::GLHelper(Options *options): options(options) {
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
 
+    //static caster cache for point shadow maps, it is only copied from, never sampled
+    glGenFramebuffers(1, &depthOnlyFrameBufferPointStatic);
+    glGenTextures(1, &depthCubemapPointStatic);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY_ARB, depthCubemapPointStatic);
+    glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY_ARB, 0, GL_DEPTH_COMPONENT, options->getShadowMapPointWidth(),
+                 options->getShadowMapPointHeight(), NR_TOTAL_LIGHTS*6, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY_ARB, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY_ARB, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY_ARB, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, depthOnlyFrameBufferPointStatic);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubemapPointStatic, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    //layers are attached to these when they are used
+    glGenFramebuffers(1, &pointShadowLayerReadFrameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, pointShadowLayerReadFrameBuffer);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glGenFramebuffers(1, &pointShadowLayerDrawFrameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, pointShadowLayerDrawFrameBuffer);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     //create prepass depth
@@ -710,10 +840,34 @@ void GLHelper::switchRenderToShadowMapDirectional(const unsigned int index) {
     checkErrors("switchRenderToShadowMapDirectional");
 }
 
-void GLHelper::switchRenderToShadowMapPoint() {
+void GLHelper::switchRenderToShadowMapPointStatic(const unsigned int index) {
     glViewport(0, 0, options->getShadowMapPointWidth(), options->getShadowMapPointHeight());
+    //clearing the layered framebuffer would clear cache of all lights
+    glBindFramebuffer(GL_FRAMEBUFFER, pointShadowLayerDrawFrameBuffer);
+    for (unsigned int face = 0; face < 6; ++face) {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubemapPointStatic, 0, index * 6 + face);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, depthOnlyFrameBufferPointStatic);
+    glCullFace(GL_FRONT);
+    staticPointShadowMapRenderCount++;
+    checkErrors("switchRenderToShadowMapPointStatic");
+}
+
+void GLHelper::switchRenderToShadowMapPoint(const unsigned int index) {
+    glViewport(0, 0, options->getShadowMapPointWidth(), options->getShadowMapPointHeight());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, pointShadowLayerReadFrameBuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, pointShadowLayerDrawFrameBuffer);
+    for (unsigned int face = 0; face < 6; ++face) {
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubemapPointStatic, 0, index * 6 + face);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubemapPoint, 0, index * 6 + face);
+        glBlitFramebuffer(0, 0, options->getShadowMapPointWidth(), options->getShadowMapPointHeight(),
+                          0, 0, options->getShadowMapPointWidth(), options->getShadowMapPointHeight(),
+                          GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, depthOnlyFrameBufferPoint);
     glCullFace(GL_FRONT);
+    pointShadowMapRenderCount++;
     checkErrors("switchRenderToShadowMapPoint");
 }
 
@@ -733,6 +887,8 @@ void GLHelper::switchRenderToColoring() {
     state->attachCubemapArray(depthCubemapPoint, maxTextureImageUnits - 2);
     state->attachTexture(depthMap, maxTextureImageUnits - 3);
     state->attachTexture(noiseTexture, maxTextureImageUnits - 4);
+    state->attachTextureBuffer(clusteredLightsTexture, getClusteredLightAttachPoint());
+    state->attachTextureBuffer(lightClustersTexture, getLightClusterAttachPoint());
     glCullFace(GL_BACK);
     checkErrors("switchRenderToColoring");
 }
@@ -900,11 +1056,23 @@ GLHelper::~GLHelper() {
     deleteBuffer(1, lightUBOLocation);
     deleteBuffer(1, playerUBOLocation);
     deleteBuffer(1, allMaterialsUBOLocation);
+    deleteBuffer(1, allModelsTransformBuffer);
+    deleteBuffer(1, allModelIndexesBuffer);
+    deleteTexture(allModelsTransformTexture);
+    deleteTexture(allModelIndexesTexture);
+    deleteBuffer(1, clusteredLightsBuffer);
+    deleteBuffer(1, lightClustersBuffer);
+    deleteTexture(clusteredLightsTexture);
+    deleteTexture(lightClustersTexture);
     deleteBuffer(1, depthMapDirectional);
     deleteBuffer(1, depthCubemapPoint);
+    deleteTexture(depthCubemapPointStatic);
     deleteBuffer(1, depthMap);
     glDeleteFramebuffers(1, &depthOnlyFrameBufferDirectional); //maybe we should wrap this up too
     glDeleteFramebuffers(1, &depthOnlyFrameBufferPoint);
+    glDeleteFramebuffers(1, &depthOnlyFrameBufferPointStatic);
+    glDeleteFramebuffers(1, &pointShadowLayerReadFrameBuffer);
+    glDeleteFramebuffers(1, &pointShadowLayerDrawFrameBuffer);
     glDeleteFramebuffers(1, &depthOnlyFrameBuffer);
     //state->setProgram(0);
 }
@@ -1098,6 +1266,18 @@ void GLHelper::setLight(const Light &light, const int i) {
     checkErrors("setLight");
 }
 
+void GLHelper::setLightClusters(const LightClusters &lightClusters) {
+    const std::vector<glm::vec4>& lightData = lightClusters.getLightData();
+    const std::vector<uint32_t>& clusterData = lightClusters.getClusterData();
+    //clusters are uploaded only if the lights they point to are uploaded
+    if(replaceTextureBufferData(clusteredLightsBuffer, sizeof(glm::vec4), lightData.data(),
+                                (uint32_t)(lightData.size() * sizeof(glm::vec4)), clusteredLightsCapacity) &&
+       replaceTextureBufferData(lightClustersBuffer, sizeof(uint32_t), clusterData.data(),
+                                (uint32_t)(clusterData.size() * sizeof(uint32_t)), lightClustersCapacity)) {
+        clusteredLightCount = lightClusters.getLightCount();
+    }
+}
+
 void GLHelper::setMaterial(std::shared_ptr<const Material> material) {
     /*
      * this buffer has 2 objects, model has mat4 and then the material below:
@@ -1125,22 +1305,167 @@ void GLHelper::setMaterial(std::shared_ptr<const Material> material) {
     checkErrors("setMaterial");
 }
 
-void GLHelper::setModel(const uint32_t modelID, const glm::mat4& worldTransform) {
-    glBindBuffer(GL_UNIFORM_BUFFER, allModelsUBOLocation);
-    glBufferSubData(GL_UNIFORM_BUFFER, modelID * sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(worldTransform));
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-    checkErrors("setModel");
+uint32_t GLHelper::allocateModelTransform() {
+    if(!unusedModelTransformHandles.empty()) {
+        uint32_t handle = unusedModelTransformHandles.front();
+        unusedModelTransformHandles.pop();
+        return handle;
+    }
+    if(nextModelTransformHandle >= modelTransformCapacity) {
+        //both buffers are indexed by transform handle, so neither grows unless both can
+        if(isTextureBufferSizeSupported(sizeof(glm::vec4), sizeof(glm::mat4) * modelTransformCapacity * 2) &&
+           isTextureBufferSizeSupported(sizeof(uint32_t), sizeof(uint32_t) * modelTransformCapacity * 2) &&
+           growTextureBuffer(GL_RGBA32F, sizeof(glm::vec4), sizeof(glm::mat4) * modelTransformCapacity,
+                             sizeof(glm::mat4) * modelTransformCapacity * 2, allModelsTransformBuffer, allModelsTransformTexture) &&
+           growTextureBuffer(GL_R32UI, sizeof(uint32_t), sizeof(uint32_t) * modelTransformCapacity,
+                             sizeof(uint32_t) * modelTransformCapacity * 2, allModelPaletteIndexesBuffer,
+                             allModelPaletteIndexesTexture)) {
+            modelTransformCapacity = modelTransformCapacity * 2;
+            modelTransforms.resize(modelTransformCapacity);
+            dirtyModelTransforms.resize((modelTransformCapacity + 63) / 64, 0);
+            modelPaletteIndexes.resize(modelTransformCapacity, 0);
+        } else {
+            std::cerr << "Model transform buffer is full, model will not be rendered." << std::endl;
+            return INVALID_HANDLE;
+        }
+    }
+    return nextModelTransformHandle++;
 }
 
-void GLHelper::setModelIndexesUBO(std::vector<uint32_t> &modelIndicesList) {
-    std::vector<glm::uvec4> temp;
-    for (uint32_t i = 0; i < modelIndicesList.size(); ++i) {
-        temp.push_back(glm::uvec4(modelIndicesList[i], 0,0,0));
+void GLHelper::freeModelTransform(uint32_t transformHandle) {
+    if(transformHandle == INVALID_HANDLE) {
+        return;
     }
-    glBindBuffer(GL_UNIFORM_BUFFER, allModelIndexesUBOLocation);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::uvec4) * modelIndicesList.size(), glm::value_ptr(temp.at(0)));
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-    checkErrors("setModelIndexesUBO");
+    unusedModelTransformHandles.push(transformHandle);
+}
+
+void GLHelper::setModel(const uint32_t transformHandle, const glm::mat4& worldTransform) {
+    if(transformHandle == INVALID_HANDLE) {
+        return;
+    }
+    modelTransforms[transformHandle] = worldTransform;
+    dirtyModelTransforms[transformHandle / 64] |= (uint64_t(1) << (transformHandle % 64));
+}
+
+uint32_t GLHelper::uploadDirtySlots(GLuint buffer, std::vector<uint64_t> &dirtySlots, uint32_t slotCount,
+                                    uint32_t slotSize, const uint8_t *data, uint32_t &uploadedSlotCount) {
+    uint32_t uploadCallCount = 0;
+    uint32_t rangeStart = 0;
+    bool inRange = false;
+    //one extra iteration after the last slot closes the last range
+    for (uint32_t i = 0; i <= slotCount; ++i) {
+        bool isDirty = false;
+        if(i < slotCount) {
+            if(dirtySlots[i / 64] == 0 && !inRange) {
+                i = i + (63 - (i % 64));//whole word is clean, skip to the next one
+                continue;
+            }
+            isDirty = (dirtySlots[i / 64] & (uint64_t(1) << (i % 64))) != 0;
+        }
+        if(isDirty && !inRange) {
+            rangeStart = i;
+            inRange = true;
+        } else if(!isDirty && inRange) {
+            if(uploadCallCount == 0) {
+                glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+            }
+            glBufferSubData(GL_TEXTURE_BUFFER, rangeStart * slotSize, (i - rangeStart) * slotSize,
+                            data + rangeStart * slotSize);
+            uploadedSlotCount += i - rangeStart;
+            uploadCallCount++;
+            inRange = false;
+        }
+    }
+    if(uploadCallCount > 0) {
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        std::fill(dirtySlots.begin(), dirtySlots.end(), 0);
+    }
+    return uploadCallCount;
+}
+
+void GLHelper::flushModelTransforms() {
+    modelTransformUploadRangeCount += uploadDirtySlots(allModelsTransformBuffer, dirtyModelTransforms,
+                                                       nextModelTransformHandle, sizeof(glm::mat4),
+                                                       reinterpret_cast<const uint8_t *>(modelTransforms.data()),
+                                                       modelTransformUploadCount);
+    uploadDirtySlots(allBonePalettesBuffer, dirtyBonePalettes, nextBonePaletteHandle, sizeof(glm::mat4) * NR_BONE,
+                     reinterpret_cast<const uint8_t *>(bonePalettes.data()), bonePaletteUploadCount);
+    if(modelPaletteIndexesDirty) {
+        //only changes when an animated model is created, so it is uploaded as a whole
+        glBindBuffer(GL_TEXTURE_BUFFER, allModelPaletteIndexesBuffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, nextModelTransformHandle * sizeof(uint32_t), modelPaletteIndexes.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        modelPaletteIndexesDirty = false;
+    }
+    checkErrors("flushModelTransforms");
+}
+
+uint32_t GLHelper::allocateBonePalette() {
+    if(!unusedBonePaletteHandles.empty()) {
+        uint32_t handle = unusedBonePaletteHandles.front();
+        unusedBonePaletteHandles.pop();
+        return handle;
+    }
+    if(nextBonePaletteHandle >= bonePaletteCapacity) {
+        if(growTextureBuffer(GL_RGBA32F, sizeof(glm::vec4), sizeof(glm::mat4) * NR_BONE * bonePaletteCapacity,
+                             sizeof(glm::mat4) * NR_BONE * bonePaletteCapacity * 2, allBonePalettesBuffer,
+                             allBonePalettesTexture)) {
+            bonePaletteCapacity = bonePaletteCapacity * 2;
+            bonePalettes.resize(NR_BONE * bonePaletteCapacity);
+            dirtyBonePalettes.resize((bonePaletteCapacity + 63) / 64, 0);
+        } else {
+            std::cerr << "Bone palette buffer is full, model will not be rendered." << std::endl;
+            return INVALID_HANDLE;
+        }
+    }
+    return nextBonePaletteHandle++;
+}
+
+void GLHelper::freeBonePalette(uint32_t paletteHandle) {
+    if(paletteHandle == INVALID_HANDLE) {
+        return;
+    }
+    unusedBonePaletteHandles.push(paletteHandle);
+}
+
+void GLHelper::setModelBonePalette(uint32_t transformHandle, uint32_t paletteHandle) {
+    if(transformHandle == INVALID_HANDLE || paletteHandle == INVALID_HANDLE) {
+        return;
+    }
+    modelPaletteIndexes[transformHandle] = paletteHandle;
+    modelPaletteIndexesDirty = true;
+}
+
+void GLHelper::setBonePalette(uint32_t paletteHandle, const std::vector<glm::mat4> &boneTransforms) {
+    if(paletteHandle == INVALID_HANDLE) {
+        return;
+    }
+    size_t boneCount = std::min(boneTransforms.size(), (size_t)NR_BONE);
+    std::copy(boneTransforms.begin(), boneTransforms.begin() + boneCount, bonePalettes.begin() + paletteHandle * NR_BONE);
+    dirtyBonePalettes[paletteHandle / 64] |= (uint64_t(1) << (paletteHandle % 64));
+}
+
+void GLHelper::setModelIndexes(const std::vector<uint32_t> &modelIndicesList) {
+    if(modelIndicesList.empty()) {
+        return;
+    }
+    if(modelIndicesList.size() > modelIndexCapacity) {
+        uint32_t newCapacity = modelIndexCapacity;
+        while(newCapacity < modelIndicesList.size()) {
+            newCapacity = newCapacity * 2;
+        }
+        //old content is not needed, but growing keeps the texture object, so nothing needs rebinding
+        if(growTextureBuffer(GL_R32UI, sizeof(uint32_t), 0, sizeof(uint32_t) * newCapacity,
+                             allModelIndexesBuffer, allModelIndexesTexture)) {
+            modelIndexCapacity = newCapacity;
+        } else {
+            return;
+        }
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, allModelIndexesBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeof(uint32_t) * modelIndicesList.size(), modelIndicesList.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    checkErrors("setModelIndexes");
 }
 
 void GLHelper::setPlayerMatrices(const glm::vec3 &cameraPosition, const glm::mat4 &cameraTransform) {
@@ -1168,7 +1493,7 @@ void GLHelper::setPlayerMatrices(const glm::vec3 &cameraPosition, const glm::mat
 }
 
 void GLHelper::calculateFrustumPlanes(const glm::mat4 &cameraMatrix,
-                                      const glm::mat4 &projectionMatrix, std::vector<glm::vec4> &planes) const {
+                                      const glm::mat4 &projectionMatrix, std::vector<glm::vec4> &planes) {
     assert(planes.size() == 6);
     glm::mat4 clipMat;
 
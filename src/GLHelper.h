@@ -16,6 +16,7 @@
 #include <streambuf>
 #include <iostream>
 #include <unordered_map>
+#include <queue>
 #include <GL/glew.h>
 
 #ifdef __APPLE__
@@ -27,12 +28,16 @@
 
 #endif/*__APPLE__*/
 
-#define NR_POINT_LIGHTS 3
+#define NR_POINT_LIGHTS 3 //point lights with shadows, others are lit through light clusters
 #define NR_TOTAL_LIGHTS 4
-#define NR_MAX_MODELS (1000)
+#define NR_INITIAL_CLUSTERED_LIGHT_CAPACITY (256)
+#define NR_INITIAL_MODEL_CAPACITY (1000)
+#define NR_INITIAL_BONE_PALETTE_CAPACITY (64)
+#define NR_BONE 128 //bones per palette, must match the shaders
 #define NR_MAX_MATERIALS 2000
 
 #include "Options.h"
+#include "LightClusters.h"
 class Material;
 
 class Light;
@@ -102,6 +107,10 @@ class GLHelper {
             attachTexture(textureID, textureUnit, GL_TEXTURE_CUBE_MAP_ARRAY_ARB);
         }
 
+        void attachTextureBuffer(GLuint textureID, GLuint textureUnit) {
+            attachTexture(textureID, textureUnit, GL_TEXTURE_BUFFER);
+        }
+
 
         void setProgram(GLuint program) {
             if (program != this->activeProgram) {
@@ -114,6 +123,8 @@ class GLHelper {
 
 
 public:
+    static const uint32_t INVALID_HANDLE = 0xFFFFFFFF;//returned when a buffer is full and can't grow
+
     enum VariableTypes {
         INT,
         FLOAT,
@@ -138,6 +149,8 @@ public:
                 case GL_SAMPLER_CUBE_MAP_ARRAY_ARB:
                 case GL_SAMPLER_2D:
                 case GL_SAMPLER_2D_ARRAY:
+                case GL_SAMPLER_BUFFER:
+                case GL_UNSIGNED_INT_SAMPLER_BUFFER:
                 case GL_INT:
                     type = INT;
                     break;
@@ -187,8 +200,62 @@ private:
     GLuint lightUBOLocation;
     GLuint playerUBOLocation;
     GLuint allMaterialsUBOLocation;
-    GLuint allModelsUBOLocation;
-    GLuint allModelIndexesUBOLocation;
+
+    /*
+     * Model transforms and per instance model indexes are kept in texture buffers instead of UBOs, because UBO size
+     * is limited. Transform slots are handed out by allocateModelTransform, and they are not related to world object IDs.
+     */
+    GLuint allModelsTransformBuffer;
+    GLuint allModelsTransformTexture;
+    uint32_t modelTransformCapacity = NR_INITIAL_MODEL_CAPACITY;
+    uint32_t nextModelTransformHandle = 0;
+    std::queue<uint32_t> unusedModelTransformHandles;
+
+    /*
+     * setModel only updates the CPU copy and marks the slot dirty. Dirty slots are uploaded once per frame by
+     * flushModelTransforms, consecutive dirty slots are merged to single upload.
+     */
+    std::vector<glm::mat4> modelTransforms;
+    std::vector<uint64_t> dirtyModelTransforms;//bitset, one bit per transform slot
+    uint32_t modelTransformUploadCount = 0;
+    uint32_t modelTransformUploadRangeCount = 0;
+
+    GLuint allModelIndexesBuffer;
+    GLuint allModelIndexesTexture;
+    uint32_t modelIndexCapacity = NR_INITIAL_MODEL_CAPACITY;
+
+    /*
+     * Bone palettes of all animated models are kept in a single texture buffer, NR_BONE matrices per palette. Shaders
+     * find the palette of an instance through the palette index of its transform slot, so animated models can be
+     * rendered instanced too. Palettes are uploaded by flushModelTransforms, same as transforms.
+     */
+    GLuint allBonePalettesBuffer;
+    GLuint allBonePalettesTexture;
+    uint32_t bonePaletteCapacity = NR_INITIAL_BONE_PALETTE_CAPACITY;
+    uint32_t nextBonePaletteHandle = 0;
+    std::queue<uint32_t> unusedBonePaletteHandles;
+    std::vector<glm::mat4> bonePalettes;
+    std::vector<uint64_t> dirtyBonePalettes;//bitset, one bit per palette
+    uint32_t bonePaletteUploadCount = 0;
+
+    GLuint allModelPaletteIndexesBuffer;
+    GLuint allModelPaletteIndexesTexture;
+    std::vector<uint32_t> modelPaletteIndexes;//transform slot -> bone palette
+    bool modelPaletteIndexesDirty = false;
+
+    /*
+     * Point lights without shadows, and the clusters they are assigned to. Both are rewritten every frame by
+     * setLightClusters, buffers grow when they don't fit.
+     */
+    GLuint clusteredLightsBuffer;
+    GLuint clusteredLightsTexture;
+    uint32_t clusteredLightsCapacity = sizeof(glm::vec4) * LightClusters::LIGHT_DATA_TEXELS * NR_INITIAL_CLUSTERED_LIGHT_CAPACITY;//in bytes
+    GLuint lightClustersBuffer;
+    GLuint lightClustersTexture;
+    uint32_t lightClustersCapacity = sizeof(uint32_t) * 4 * LightClusters::CLUSTER_COUNT;//in bytes
+    uint32_t clusteredLightCount = 0;
+
+    GLint maxTextureBufferSize;
 
     uint32_t activeMaterialIndex;
 
@@ -198,6 +265,18 @@ private:
     GLuint depthOnlyFrameBufferPoint;
     GLuint depthCubemapPoint;
 
+    /*
+     * Point shadow maps are cached, each active light keeps its layers until it is rendered again. Static casters are
+     * rendered to a second cube map array, which is copied to the sampled one before dynamic casters are rendered on
+     * top. Layered attachments can't be cleared or copied per layer, so the layer framebuffers are used for that.
+     */
+    GLuint depthOnlyFrameBufferPointStatic;
+    GLuint depthCubemapPointStatic;
+    GLuint pointShadowLayerReadFrameBuffer;
+    GLuint pointShadowLayerDrawFrameBuffer;
+    uint32_t pointShadowMapRenderCount = 0;
+    uint32_t staticPointShadowMapRenderCount = 0;
+
     GLuint depthOnlyFrameBuffer;
     GLuint depthMap;
 
@@ -220,7 +299,6 @@ private:
     const uint_fast32_t lightUniformSize = (sizeof(glm::mat4) * 7) + (4 * sizeof(glm::vec4));
     const uint32_t playerUniformSize = 5 * sizeof(glm::mat4)+ 3* sizeof(glm::vec4);
     int32_t materialUniformSize = 2 * sizeof(glm::vec3) + sizeof(float) + sizeof(GLuint);
-    int32_t modelUniformSize = sizeof(glm::mat4);
 
     glm::mat4 cameraMatrix;
     glm::mat4 perspectiveProjectionMatrix;
@@ -241,6 +319,37 @@ public:
         lineCount = renderLineCount;
     }
 
+    /**
+     * Returns how many model transforms are uploaded in this frame, and how many upload calls they required.
+     */
+    void getModelTransformUploadCount(uint32_t& transformCount, uint32_t& uploadCallCount) {
+        transformCount = modelTransformUploadCount;
+        uploadCallCount = modelTransformUploadRangeCount;
+    }
+
+    /**
+     * Returns how many bone palettes are uploaded in this frame.
+     */
+    uint32_t getBonePaletteUploadCount() const {
+        return bonePaletteUploadCount;
+    }
+
+    /**
+     * Returns how many point shadow maps are rendered in this frame, and for how many of them static casters are
+     * rendered again instead of using the cache.
+     */
+    void getPointShadowMapRenderCount(uint32_t& renderCount, uint32_t& staticRenderCount) const {
+        renderCount = pointShadowMapRenderCount;
+        staticRenderCount = staticPointShadowMapRenderCount;
+    }
+
+    /**
+     * Returns how many point lights are lit through light clusters, without shadows.
+     */
+    uint32_t getClusteredLightCount() const {
+        return clusteredLightCount;
+    }
+
     const glm::mat4 &getLightProjectionMatrixPoint() const {
         return lightProjectionMatrixPoint;
     }
@@ -283,6 +392,51 @@ private:
     void fillUniformMap(const GLuint program, std::unordered_map<std::string, Uniform *> &uniformMap) const;
 
     void attachGeneralUBOs(const GLuint program);
+
+    void createTextureBuffer(GLenum internalFormat, uint32_t sizeInBytes, GLuint &buffer, GLuint &texture);
+    bool isTextureBufferSizeSupported(uint32_t texelSize, uint32_t sizeInBytes) const {
+        return sizeInBytes / texelSize <= (uint32_t)maxTextureBufferSize;
+    }
+    bool growTextureBuffer(GLenum internalFormat, uint32_t texelSize, uint32_t oldSizeInBytes, uint32_t newSizeInBytes,
+                           GLuint &buffer, GLuint texture);
+
+    GLuint getModelTransformAttachPoint() const {
+        return maxTextureImageUnits - 5;
+    }
+
+    GLuint getModelIndexAttachPoint() const {
+        return maxTextureImageUnits - 6;
+    }
+
+    GLuint getBonePaletteAttachPoint() const {
+        return maxTextureImageUnits - 7;
+    }
+
+    GLuint getModelPaletteIndexAttachPoint() const {
+        return maxTextureImageUnits - 8;
+    }
+
+    GLuint getClusteredLightAttachPoint() const {
+        return maxTextureImageUnits - 9;
+    }
+
+    GLuint getLightClusterAttachPoint() const {
+        return maxTextureImageUnits - 10;
+    }
+
+    /**
+     * Replaces the content of buffer, growing it if data doesn't fit.
+     * @return false if data is bigger then what GPU supports, buffer is not changed in that case
+     */
+    bool replaceTextureBufferData(GLuint buffer, uint32_t texelSize, const void *data, uint32_t sizeInBytes,
+                                  uint32_t &capacityInBytes);
+
+    /**
+     * Uploads dirty slots of buffer, merging consecutive dirty slots to single upload, and clears the dirty bits.
+     * @return number of upload calls
+     */
+    uint32_t uploadDirtySlots(GLuint buffer, std::vector<uint64_t> &dirtySlots, uint32_t slotCount, uint32_t slotSize,
+                              const uint8_t *data, uint32_t &uploadedSlotCount);
     void bufferExtraVertexData(uint_fast32_t elementPerVertexCount, GLenum elementType, uint_fast32_t dataSize,
                                const void *extraData, uint_fast32_t &vao, uint_fast32_t &vbo,
                                const uint_fast32_t attachPointer);
@@ -292,7 +446,11 @@ public:
 
     ~GLHelper();
 
-    void attachModelUBO(const uint32_t program);
+    Options *getOptions() const {
+        return options;
+    }
+
+    void attachModelTransformBuffer(const uint32_t program);
 
     void attachMaterialUBO(const uint32_t program, const uint32_t materialID);
 
@@ -325,10 +483,7 @@ public:
 
     void clearFrame() {
 
-        //additional depths for Directional is not needed, but depth for point is reqired, because there is no way to clear
-        //it per layer, so we are clearing per frame. This also means, lights should not reuse the textures.
-        glBindFramebuffer(GL_FRAMEBUFFER, depthOnlyFrameBufferPoint);
-        glClear(GL_DEPTH_BUFFER_BIT);
+        //point shadow maps are not cleared, they are cached per light. Layers are cleared when a light is rendered again.
         glBindFramebuffer(GL_FRAMEBUFFER, depthOnlyFrameBufferDirectional);
         glClear(GL_DEPTH_BUFFER_BIT);
         glBindFramebuffer(GL_FRAMEBUFFER, depthOnlyFrameBuffer);
@@ -344,6 +499,11 @@ public:
 
         renderTriangleCount = 0;
         renderLineCount = 0;
+        modelTransformUploadCount = 0;
+        modelTransformUploadRangeCount = 0;
+        bonePaletteUploadCount = 0;
+        pointShadowMapRenderCount = 0;
+        staticPointShadowMapRenderCount = 0;
         //std::cout << "program change count was : " << state->programChangeCount << std::endl;
         state->programChangeCount = 0;
 
@@ -398,6 +558,11 @@ public:
 
     void setLight(const Light &light, const int i);
 
+    /**
+     * Uploads built light clusters, used by the next coloring pass.
+     */
+    void setLightClusters(const LightClusters &lightClusters);
+
     void removeLight(const int i) {
         GLint temp = 0;
         glBindBuffer(GL_UNIFORM_BUFFER, lightUBOLocation);
@@ -410,7 +575,15 @@ public:
     void setPlayerMatrices(const glm::vec3 &cameraPosition, const glm::mat4 &cameraMatrix);
 
     void switchRenderToShadowMapDirectional(const unsigned int index);
-    void switchRenderToShadowMapPoint();
+    /**
+     * Clears static caster layers of the light, and binds them for rendering.
+     */
+    void switchRenderToShadowMapPointStatic(const unsigned int index);
+
+    /**
+     * Copies static caster layers of the light to its shadow map, and binds it, so dynamic casters are rendered on top.
+     */
+    void switchRenderToShadowMapPoint(const unsigned int index);
     void switchRenderToDepthPrePass();
     void switchRenderToColoring();
     void switchRenderToSSAOGeneration();
@@ -421,14 +594,18 @@ public:
         return maxTextureImageUnits;
     }
 
-    void calculateFrustumPlanes(const glm::mat4 &cameraMatrix, const glm::mat4 &projectionMatrix,
-                                std::vector<glm::vec4> &planes) const;
+    static void calculateFrustumPlanes(const glm::mat4 &cameraMatrix, const glm::mat4 &projectionMatrix,
+                                       std::vector<glm::vec4> &planes);
+
+    const std::vector<glm::vec4>& getFrustumPlanes() const {
+        return frustumPlanes;
+    }
 
     inline bool isInFrustum(const glm::vec3& aabbMin, const glm::vec3& aabbMax) const {
         return isInFrustum(aabbMin, aabbMax, frustumPlanes);
     }
 
-    inline bool isInFrustum(const glm::vec3& aabbMin, const glm::vec3& aabbMax, const std::vector<glm::vec4>& frustumPlaneVector) const {
+    static inline bool isInFrustum(const glm::vec3& aabbMin, const glm::vec3& aabbMax, const std::vector<glm::vec4>& frustumPlaneVector) {
         bool inside = true;
         //test all 6 frustum planes
         for (int i = 0; i<6; i++) {
@@ -446,11 +623,42 @@ public:
 
     void setMaterial(std::shared_ptr<const Material>material);
 
-    void setModel(const uint32_t modelID, const glm::mat4 &worldTransform);
+    /**
+     * Reserves a slot for a model transform, growing the transform buffer if there is no free slot.
+     * @return handle that should be passed to setModel, and used as model index for instanced rendering.
+     *         INVALID_HANDLE if the buffer can't grow, such models are not rendered.
+     */
+    uint32_t allocateModelTransform();
+
+    void freeModelTransform(uint32_t transformHandle);
+
+    void setModel(const uint32_t transformHandle, const glm::mat4 &worldTransform);
+
+    /**
+     * Reserves a bone palette, growing the palette buffer if there is no free palette.
+     * @return handle that should be passed to setBonePalette and setModelBonePalette. INVALID_HANDLE if the buffer
+     *         can't grow, such models are not rendered.
+     */
+    uint32_t allocateBonePalette();
+
+    void freeBonePalette(uint32_t paletteHandle);
+
+    /**
+     * Instances rendered with the transform slot use the bone palette.
+     */
+    void setModelBonePalette(uint32_t transformHandle, uint32_t paletteHandle);
+
+    /**
+     * Only updates the CPU copy, it is uploaded by flushModelTransforms. Bones after NR_BONE are ignored.
+     */
+    void setBonePalette(uint32_t paletteHandle, const std::vector<glm::mat4> &boneTransforms);
 
-    void setModelIndexesUBO(std::vector<uint32_t> &modelIndicesList);
+    /**
+     * Uploads transforms and bone palettes that are changed since last call. Must be called before rendering the frame.
+     */
+    void flushModelTransforms();
 
-    void attachModelIndicesUBO(const uint32_t programID);
+    void setModelIndexes(const std::vector<uint32_t> &modelIndicesList);
 
     void renderInstanced(GLuint program, uint_fast32_t VAO, uint_fast32_t EBO, uint_fast32_t triangleCount,
                          uint32_t instanceCount);
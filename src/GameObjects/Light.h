@@ -10,6 +10,7 @@
 #include "glm/glm.hpp"
 #include "GameObject.h"
 #include "../GLHelper.h"
+#include "../VisibilityBatch.h"
 #include "../../libs/ImGui/imgui.h"
 #include "../../libs/ImGuizmo/ImGuizmo.h"
 
@@ -125,6 +126,20 @@ public:
         return true;//for safety only
     }
 
+    /**
+     * Adds the volume isShadowCaster checks to batch.
+     * @return bit of the light in batch masks
+     */
+    uint32_t addToVisibilityBatch(VisibilityBatch& batch) const {
+        switch (this->lightType) {
+            case DIRECTIONAL:
+                return batch.addFrustum(this->frustumPlanes);
+            case POINT:
+                return batch.addRange(this->position, activeDistance);
+        }
+        return batch.addRange(this->position, activeDistance);//for safety only
+    }
+
     /************Game Object methods **************/
 
     uint32_t getWorldObjectID() const override {
@@ -8,13 +8,14 @@
 
 Model::Model(uint32_t objectID, AssetManager *assetManager, const float mass, const std::string &modelFile,
              bool disconnected = false) :
-        PhysicalRenderable(assetManager->getGlHelper(), mass, disconnected), objectID(objectID), assetManager(assetManager),
+        PhysicalRenderable(assetManager->getGlHelper(), mass, disconnected), objectID(objectID),
+        transformHandle(assetManager->getGlHelper()->allocateModelTransform()), assetManager(assetManager),
         name(modelFile) {
 
     transformation.setUpdateCallback(std::bind(&Model::transformChangeCallback, this));
 
-    //this is required because the shader has fixed size arrays
-    boneTransforms.resize(128);
+    //this is required because the bone palettes have fixed size
+    boneTransforms.resize(NR_BONE);
     modelAsset = assetManager->loadAsset<ModelAsset>({modelFile});
     //set up the rigid body
     this->triangleCount = 0;
@@ -28,6 +29,15 @@ Model::Model(uint32_t objectID, AssetManager *assetManager, const float mass, co
     baseTransform.setIdentity();
     baseTransform.setOrigin(GLMConverter::GLMToBlt(-1.0f * centerOffset));
     this->animated = modelAsset->isAnimated();
+    if(animated) {
+        bonePaletteHandle = glHelper->allocateBonePalette();
+        if(bonePaletteHandle == GLHelper::INVALID_HANDLE) {
+            //it would be skinned with whatever palette its transform slot pointed to before
+            glHelper->freeModelTransform(transformHandle);
+            transformHandle = GLHelper::INVALID_HANDLE;
+        }
+        glHelper->setModelBonePalette(transformHandle, bonePaletteHandle);
+    }
     std::map<uint_fast32_t, btConvexHullShape *> hullMap;
 
     std::map<uint_fast32_t, btTransform> btTransformMap;
@@ -124,10 +134,49 @@ Model::Model(uint32_t objectID, AssetManager *assetManager, const float mass, co
         //for animated bodies, setup the first frame
         this->setupForTime(0);
     }
+    //transform slot might be reused, so it can contain transform of a removed model
+    glHelper->setModel(this->transformHandle, this->transformation.getWorldTransform());
 }
 
 void Model::setupForTime(long time) {
+    finishSetupForTime(time, updatePose(time));
+}
+
+void Model::setAnimationLOD(uint32_t updateInterval, uint32_t skippedBoneLevels, uint32_t tick) {
+    if(tick != lastAnimationLODTick + 1 || updateInterval <= 1 || skippedBoneLevels != animationSkippedBoneLevels) {
+        boneTransformsTo.clear();
+    }
+    lastAnimationLODTick = tick;
+    animationUpdateInterval = std::max(updateInterval, 1u);
+    animationSkippedBoneLevels = skippedBoneLevels;
+}
+
+bool Model::updatePose(long time) {
     if(animated && !animationLastFramePlayed) {
+        if(!boneTransformsTo.empty() && animationTicksSinceEvaluation + 1 < animationUpdateInterval) {
+            //time still advances, so the next evaluation is at the right time
+            animationTime = animationTime + (time - lastSetupTime) * animationTimeScale;
+            if(animationBlend) {
+                animationTimeOld = animationTimeOld + (time - lastSetupTime) * animationTimeScale;
+            }
+            ++animationTicksSinceEvaluation;
+            //skinning matrices can't be interpolated componentwise without shearing, local transforms are interpolated instead
+            float factor = (float)animationTicksSinceEvaluation / (float)animationUpdateInterval;
+            AnimationPose::blend(animationPoseFrom.pose, animationPoseTo.pose, factor, animationPoseInterpolated.pose);
+            animationPoseInterpolated.sampled = animationPoseTo.sampled;
+            modelAsset->getTransform(animationPoseInterpolated, boneTransforms);
+            for (auto boneIt = boneIdCompoundChildMap.begin(); boneIt != boneIdCompoundChildMap.end(); ++boneIt) {
+                boneTransforms[boneIt->first] = centerOffsetMatrix * boneTransforms[boneIt->first];
+            }
+            isBonePaletteDirty = true;
+            return false;
+        }
+        animationTicksSinceEvaluation = 0;
+        //poses are only needed for interpolation, the new one is written to from, and swapped after evaluation
+        ModelAsset::SampledPose *sampledPose = nullptr;
+        if(animationUpdateInterval > 1) {
+            sampledPose = &animationPoseFrom;
+        }
         //check if we need to blend
         if(animationBlend) {
             //we need 2 animation times, and a factor
@@ -142,15 +191,23 @@ void Model::setupForTime(long time) {
             }
             animationLastFramePlayed = modelAsset->getTransformBlended(animationNameOld, animationTimeOld, animationLoopedOld,
                                                                        animationName, animationTime, animationLooped,
-                                                                       blendFactor, boneTransforms);
+                                                                       blendFactor, boneTransforms,
+                                                                       &animationCursorsOld, &animationCursors,
+                                                                       animationSkippedBoneLevels, sampledPose);
             //std::cout << "blend " << animationNameOld << " with " << animationName << " for " << blendFactor << " factor" << std::endl;
         } else {
             animationTime = animationTime + (time - lastSetupTime) * animationTimeScale;
-            animationLastFramePlayed = modelAsset->getTransform(animationTime, animationLooped, animationName, boneTransforms);
+            animationLastFramePlayed = modelAsset->getTransform(animationTime, animationLooped, animationName, boneTransforms,
+                                                                &animationCursors, animationSkippedBoneLevels, sampledPose);
         }
+        isBonePaletteDirty = true;
+        return true;
+    }
+    return false;
+}
 
-
-
+void Model::finishSetupForTime(long time, bool isPoseUpdated) {
+    if(isPoseUpdated) {
         btVector3 scale = this->getRigidBody()->getCollisionShape()->getLocalScaling();
         this->getRigidBody()->getCollisionShape()->setLocalScaling(btVector3(1, 1, 1));
         for (unsigned int i = 0; i < boneTransforms.size(); ++i) {
@@ -163,6 +220,28 @@ void Model::setupForTime(long time) {
         }
         this->getRigidBody()->getCollisionShape()->setLocalScaling(scale);
         compoundShape->recalculateLocalAabb();
+
+        if(animationUpdateInterval > 1 && !animationLastFramePlayed && !animationPoseFrom.sampled.empty()) {
+            //keep the last 2 evaluations, and show the previous one until updatePose interpolates towards the last.
+            //updatePose wrote the new pose to from, so swapping makes it to
+            std::swap(animationPoseFrom, animationPoseTo);
+            if(boneTransformsTo.empty() || animationPoseFrom.sampled != animationPoseTo.sampled) {
+                //nothing to interpolate from, or different nodes are sampled. Start from the new pose
+                animationPoseFrom = animationPoseTo;
+                boneTransformsTo = boneTransforms;
+            } else {
+                boneTransformsTo.swap(boneTransforms);
+            }
+        } else {
+            boneTransformsTo.clear();
+        }
+    }
+    if(isBonePaletteDirty) {
+        glHelper->setBonePalette(bonePaletteHandle, boneTransforms);
+        isBonePaletteDirty = false;
+    }
+    if(animated) {
+        updateExposedBoneTransforms();
     }
     lastSetupTime = time;
 }
@@ -213,8 +292,7 @@ void Model::setSamplersAndUBOs(GLSLProgram *program) {
         std::cerr << "Uniform \"shadowSamplerPoint\" could not be set" << std::endl;
     }
 
-    glHelper->attachModelUBO(program->getID());
-    glHelper->attachModelIndicesUBO(program->getID());
+    glHelper->attachModelTransformBuffer(program->getID());
 }
 
 bool Model::setupRenderVariables(MeshMeta *meshMetaData) {
@@ -227,26 +305,23 @@ bool Model::setupRenderVariables(MeshMeta *meshMetaData) {
         return false;
     }
 
-    if (animated) {
-        //set all of the bones to unitTransform for testing
-
-        for (auto boneIterator = exposedBoneTransforms.begin();
-             boneIterator != exposedBoneTransforms.end(); ++boneIterator) {
-                glm::vec3 temp1;//these are not used
-                glm::vec4 temp2;
-                glm::vec3 translate, scale;
-                glm::quat orientation;
+    return true;
+}
 
-                glm::decompose(this->transformation.getWorldTransform() * boneTransforms[boneIterator->first], scale, orientation, translate, temp1, temp2);
+void Model::updateExposedBoneTransforms() {
+    for (auto boneIterator = exposedBoneTransforms.begin();
+         boneIterator != exposedBoneTransforms.end(); ++boneIterator) {
+            glm::vec3 temp1;//these are not used
+            glm::vec4 temp2;
+            glm::vec3 translate, scale;
+            glm::quat orientation;
 
-                exposedBoneTransforms[boneIterator->first]->setTranslate(translate);
-                exposedBoneTransforms[boneIterator->first]->setScale(scale);
-                exposedBoneTransforms[boneIterator->first]->setOrientation(orientation);
-        }
+            glm::decompose(this->transformation.getWorldTransform() * boneTransforms[boneIterator->first], scale, orientation, translate, temp1, temp2);
 
-        program->setUniformArray("boneTransformArray[0]", boneTransforms);
+            exposedBoneTransforms[boneIterator->first]->setTranslate(translate);
+            exposedBoneTransforms[boneIterator->first]->setScale(scale);
+            exposedBoneTransforms[boneIterator->first]->setOrientation(orientation);
     }
-    return true;
 }
 
 void Model::render() {
@@ -258,8 +333,8 @@ void Model::render() {
     }
 }
 
-void Model::renderInstanced(std::vector<uint32_t> &modelIndices) {
-    glHelper->setModelIndexesUBO(modelIndices);
+void Model::renderInstanced(const std::vector<uint32_t> &modelIndices) {
+    glHelper->setModelIndexes(modelIndices);
     for (std::vector<MeshMeta *>::iterator iter = meshMetaData.begin(); iter != meshMetaData.end(); ++iter) {
         MeshMeta* meshMetaData = *iter;
 
@@ -276,12 +351,10 @@ void Model::renderInstanced(std::vector<uint32_t> &modelIndices) {
 
 
 void Model::renderWithProgram(GLSLProgram &program) {
-    glHelper->attachModelUBO(program.getID());
+    glHelper->attachModelTransformBuffer(program.getID());
     for (auto iter = meshMetaData.begin(); iter != meshMetaData.end(); ++iter) {
 
         if (animated) {
-            //set all of the bones to unitTransform for testing
-            program.setUniformArray("boneTransformArray[0]", boneTransforms);
             program.setUniform("isAnimated", true);
         } else {
             program.setUniform("isAnimated", false);
@@ -293,15 +366,12 @@ void Model::renderWithProgram(GLSLProgram &program) {
     }
 }
 
-void Model::renderWithProgramInstanced(std::vector<uint32_t> &modelIndices, GLSLProgram &program) {
-    glHelper->setModelIndexesUBO(modelIndices);
+void Model::renderWithProgramInstanced(const std::vector<uint32_t> &modelIndices, GLSLProgram &program) {
+    glHelper->setModelIndexes(modelIndices);
 
-    glHelper->attachModelUBO(program.getID());
-    glHelper->attachModelIndicesUBO(program.getID());
+    glHelper->attachModelTransformBuffer(program.getID());
     for (auto iter = meshMetaData.begin(); iter != meshMetaData.end(); ++iter) {
         if (animated) {
-            //set all of the bones to unitTransform for testing
-            program.setUniformArray("boneTransformArray[0]", boneTransforms);
             program.setUniform("isAnimated", true);
         } else {
             program.setUniform("isAnimated", false);
@@ -425,6 +495,14 @@ GameObject::ImGuiResult Model::addImGuiEditorElements(const ImGuiRequest &reques
             }
             ImGui::SliderFloat("Animation time scale", &(this->animationTimeScale), 0.01f, 2.0f);
 
+            uint64_t poseCacheHits, poseCacheMisses;
+            size_t poseCacheSize;
+            modelAsset->getPoseCacheStatistics(poseCacheHits, poseCacheMisses, poseCacheSize);
+            uint64_t poseCacheRequests = poseCacheHits + poseCacheMisses;
+            ImGui::Text("Pose cache hit rate: %.1f%%, size: %.1f KB",
+                        poseCacheRequests == 0 ? 0.0f : 100.0f * poseCacheHits / poseCacheRequests,
+                        poseCacheSize / 1024.0f);
+
             ImGui::Text("Seperate selected animation by time");
             static char newAnimationName[256] = {0};
             static float times[2] = {0};
@@ -494,6 +572,10 @@ Model::~Model() {
         children[i]->setParentObject(nullptr);
     }
 
+    glHelper->freeModelTransform(transformHandle);
+    if(animated) {
+        glHelper->freeBonePalette(bonePaletteHandle);
+    }
     assetManager->freeAsset({name});
 }
 
@@ -23,6 +23,8 @@ class ActorInterface;
 
 class Model : public PhysicalRenderable, public GameObject {
     uint32_t objectID;
+    uint32_t transformHandle;//slot of world transform in GPU, not related to objectID
+    uint32_t bonePaletteHandle = 0;//slot of boneTransforms in GPU, only for animated models
     struct MeshMeta {
         std::shared_ptr<MeshAsset> mesh = nullptr;
         GLSLProgram* program = nullptr;
@@ -39,11 +41,27 @@ class Model : public PhysicalRenderable, public GameObject {
     long animationTimeOld = 0;
     bool animationLoopedOld = true;
 
+    //key cursors of each bone, for the current and old animations
+    std::vector<AnimationNode::Cursor> animationCursors;
+    std::vector<AnimationNode::Cursor> animationCursorsOld;
+
     bool animationBlend = false;
     long animationBlendTime = 1000;
 
     bool animationLastFramePlayed = false;
     long lastSetupTime = 0;
+
+    //animation level of detail. Pose is evaluated once every animationUpdateInterval ticks, and in between local bone
+    //transforms are interpolated from the previous evaluation to the last one, so it lags one interval behind
+    uint32_t animationUpdateInterval = 1;
+    uint32_t animationSkippedBoneLevels = 0;
+    uint32_t animationTicksSinceEvaluation = 0;
+    uint32_t lastAnimationLODTick = 0;
+    ModelAsset::SampledPose animationPoseFrom;
+    ModelAsset::SampledPose animationPoseTo;
+    ModelAsset::SampledPose animationPoseInterpolated;
+    std::vector<glm::mat4> boneTransformsTo;//empty if there is nothing to interpolate
+
     float animationTimeScale = 1.0f;
     std::string name;
     bool animated = false;
@@ -51,6 +69,7 @@ class Model : public PhysicalRenderable, public GameObject {
     std::vector<LimonAPI::ParameterRequest> aiParameters;
     std::string lastSelectedAIName;
     std::vector<glm::mat4> boneTransforms;
+    bool isBonePaletteDirty = false;//boneTransforms changed since they are passed to GPU
     std::map<uint_fast32_t, uint_fast32_t> boneIdCompoundChildMap;
 
     std::vector<MeshMeta *> meshMetaData;
@@ -68,6 +87,8 @@ class Model : public PhysicalRenderable, public GameObject {
     int32_t selectedBoneID = -1;
     std::map<uint32_t, Transformation*> exposedBoneTransforms;
 
+    void updateExposedBoneTransforms();
+
     static ImGuiResult putAIonGUI(ActorInterface *actorInterface, std::vector<LimonAPI::ParameterRequest> &parameters,
                                   const ImGuiRequest &request, std::string &lastSelectedAIName);
 
@@ -82,12 +103,12 @@ public:
 
     void transformChangeCallback() {
         PhysicalRenderable::updatePhysicsFromTransform();
-        glHelper->setModel(this->getWorldObjectID(), this->transformation.getWorldTransform());
+        glHelper->setModel(this->transformHandle, this->transformation.getWorldTransform());
     }
 
     void updateTransformFromPhysics() override {
         PhysicalRenderable::updateTransformFromPhysics();
-        glHelper->setModel(this->getWorldObjectID(), this->transformation.getWorldTransform());
+        glHelper->setModel(this->transformHandle, this->transformation.getWorldTransform());
     }
 
     void setSamplersAndUBOs(GLSLProgram *program);
@@ -97,13 +118,37 @@ public:
 
     void setupForTime(long time);
 
+    /**
+     * First part of setupForTime. Evaluates the bone transforms for time, without touching physics, so different
+     * models can be updated from different threads.
+     * @return true if pose is evaluated, and should be passed to finishSetupForTime
+     */
+    bool updatePose(long time);
+
+    /**
+     * Second part of setupForTime, applies the pose from updatePose to the physics shape, and passes it to GPU. Must be
+     * called from the physics thread.
+     */
+    void finishSetupForTime(long time, bool isPoseUpdated);
+
+    /**
+     * Sets level of detail for the next updatePose. If the model was not updated on the previous tick, because it was
+     * out of all frustums, interpolation restarts, so the model catches up to current time without blending from a
+     * stale pose.
+     *
+     * @param updateInterval pose is evaluated once in this many ticks, 1 evaluates every tick
+     * @param skippedBoneLevels passed to ModelAsset::getTransform
+     * @param tick number of the current animation tick, increased by one each tick
+     */
+    void setAnimationLOD(uint32_t updateInterval, uint32_t skippedBoneLevels, uint32_t tick);
+
     void render();
 
     void renderWithProgram(GLSLProgram &program);
 
-    void renderInstanced(std::vector<uint32_t> &modelIndices);
+    void renderInstanced(const std::vector<uint32_t> &modelIndices);
 
-    void renderWithProgramInstanced(std::vector<uint32_t> &modelIndices, GLSLProgram &program);
+    void renderWithProgramInstanced(const std::vector<uint32_t> &modelIndices, GLSLProgram &program);
 
     bool isAnimated() const { return animated;}
 
@@ -121,6 +166,7 @@ public:
         this->animationNameOld = this->animationName;
         this->animationTimeOld = this->animationTime;
         this->animationLoopedOld = this->animationLooped;
+        this->animationCursorsOld.swap(this->animationCursors);
 
         this->animationName = animationName;
         this->animationTime = 0;
@@ -197,6 +243,14 @@ public:
         return modelAsset->getAssetID();
     }
 
+    /**
+     * Model transforms are kept in a GPU buffer, this handle is the index of this models transform in that buffer.
+     * Instanced render methods expect list of these handles.
+     */
+    uint32_t getTransformHandle() const {
+        return transformHandle;
+    }
+
     /**
      * This method allows attachment to a specific bone of the model, if a bone is selected. If no bone is selected, world transform is returned.
      * If a bone is returned, bone id is set to the parameter attachedBone. If no bone is selected and world transform is returned,
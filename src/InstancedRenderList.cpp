@@ -0,0 +1,66 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include "InstancedRenderList.h"
+#include "GameObjects/Model.h"
+
+const uint32_t InstancedRenderList::NOT_IN_LIST;
+
+void InstancedRenderList::insert(Model *model) {
+    if(model->getTransformHandle() == GLHelper::INVALID_HANDLE) {
+        return;//model has no transform slot, it can't be rendered
+    }
+    uint32_t worldID = model->getWorldObjectID();
+    if(worldID >= positions.size()) {
+        positions.resize(worldID + 1, NOT_IN_LIST);
+    } else if(positions[worldID] != NOT_IN_LIST) {
+        return;
+    }
+    Batch& batch = batches[model->getAssetID()];
+    positions[worldID] = (uint32_t)batch.models.size();
+    batch.models.push_back(model);
+    batch.modelIndices.push_back(model->getTransformHandle());
+}
+
+void InstancedRenderList::erase(Model *model) {
+    if(!contains(model)) {
+        return;
+    }
+    uint32_t worldID = model->getWorldObjectID();
+    Batch& batch = batches[model->getAssetID()];
+    uint32_t position = positions[worldID];
+
+    //move the last element to the removed position, then drop the last
+    batch.models[position] = batch.models.back();
+    batch.modelIndices[position] = batch.modelIndices.back();
+    positions[batch.models[position]->getWorldObjectID()] = position;
+
+    batch.models.pop_back();
+    batch.modelIndices.pop_back();
+    positions[worldID] = NOT_IN_LIST;
+}
+
+bool InstancedRenderList::contains(const Model *model) const {
+    uint32_t worldID = model->getWorldObjectID();
+    return worldID < positions.size() && positions[worldID] != NOT_IN_LIST;
+}
+
+bool InstancedRenderList::empty() const {
+    for (auto batchIt = batches.begin(); batchIt != batches.end(); ++batchIt) {
+        if(!batchIt->second.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void InstancedRenderList::clear() {
+    for (auto batchIt = batches.begin(); batchIt != batches.end(); ++batchIt) {
+        for (size_t i = 0; i < batchIt->second.models.size(); ++i) {
+            positions[batchIt->second.models[i]->getWorldObjectID()] = NOT_IN_LIST;
+        }
+        batchIt->second.models.clear();
+        batchIt->second.modelIndices.clear();
+    }
+}
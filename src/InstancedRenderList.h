@@ -0,0 +1,69 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_INSTANCEDRENDERLIST_H
+#define LIMONENGINE_INSTANCEDRENDERLIST_H
+
+
+#include <cstdint>
+#include <vector>
+#include <map>
+
+class Model;
+
+/**
+ * Keeps the models that should be rendered, grouped by their asset so each group can be rendered instanced.
+ *
+ * Each group holds flat arrays, the model index array can be passed to the instanced render methods directly.
+ * Groups are never removed, and clear keeps the capacity, so after the first few frames insert/erase don't allocate.
+ * Removal swaps the last element in, so the order of the models in a group is not preserved.
+ */
+class InstancedRenderList {
+public:
+    struct Batch {
+        std::vector<Model *> models;
+        std::vector<uint32_t> modelIndices;//transform handles of models, same order as models
+
+        bool empty() const {
+            return models.empty();
+        }
+    };
+
+private:
+    static const uint32_t NOT_IN_LIST = 0xFFFFFFFF;
+
+    std::map<uint32_t, Batch> batches;//assetID -> batch
+    std::vector<uint32_t> positions;//world object ID -> position in its batch
+
+public:
+    /**
+     * Adds the model to batch of its asset. If the model is already in the list, or it has no transform slot, nothing
+     * happens.
+     */
+    void insert(Model *model);
+
+    /**
+     * Removes the model from the list. If the model is not in the list, nothing happens.
+     */
+    void erase(Model *model);
+
+    bool contains(const Model *model) const;
+
+    /**
+     * @return true if no batch has any models
+     */
+    bool empty() const;
+
+    /**
+     * Empties all batches, but keeps their memory for reuse.
+     */
+    void clear();
+
+    const std::map<uint32_t, Batch> &getBatches() const {
+        return batches;
+    }
+};
+
+
+#endif //LIMONENGINE_INSTANCEDRENDERLIST_H
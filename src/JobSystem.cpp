@@ -0,0 +1,131 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <string>
+#include "JobSystem.h"
+
+const uint32_t JobSystem::ANY_GROUP = 0xFFFFFFFF;
+const uint32_t JobSystem::DEFAULT_GROUP = 0;
+const uint32_t JobSystem::FRAME_GROUP = 1;
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    if(workerCount == 0) {
+        workerCount = 1;
+    }
+    sleepMutex = SDL_CreateMutex();
+    sleepCondition = SDL_CreateCond();
+    SDL_AtomicSet(&pendingJobCount, 0);
+    SDL_AtomicSet(&nextQueueIndex, 0);
+    SDL_AtomicSet(&quitRequested, 0);
+
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        WorkerQueue* queue = new WorkerQueue();
+        queue->mutex = SDL_CreateMutex();
+        queues.push_back(queue);
+    }
+    //queues must be ready before any worker starts, since workers steal from each other
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        WorkerInformation* information = new WorkerInformation();
+        information->jobSystem = this;
+        information->index = i;
+        workerInformations.push_back(information);
+        std::string threadName = "LimonWorker" + std::to_string(i);
+        threads.push_back(SDL_CreateThread(&workerRunner, threadName.c_str(), information));
+    }
+}
+
+JobSystem::~JobSystem() {
+    SDL_LockMutex(sleepMutex);
+    SDL_AtomicSet(&quitRequested, 1);
+    SDL_CondBroadcast(sleepCondition);
+    SDL_UnlockMutex(sleepMutex);
+
+    for (size_t i = 0; i < threads.size(); ++i) {
+        int threadReturnValue;
+        SDL_WaitThread(threads[i], &threadReturnValue);
+    }
+
+    for (size_t i = 0; i < queues.size(); ++i) {
+        SDL_DestroyMutex(queues[i]->mutex);
+        delete queues[i];
+        delete workerInformations[i];
+    }
+    SDL_DestroyCond(sleepCondition);
+    SDL_DestroyMutex(sleepMutex);
+}
+
+int JobSystem::workerRunner(void *ptr) {
+    WorkerInformation* information = static_cast<WorkerInformation*>(ptr);
+    JobSystem* jobSystem = information->jobSystem;
+    while(true) {
+        if(jobSystem->runPendingJob(information->index, ANY_GROUP)) {
+            continue;
+        }
+        SDL_LockMutex(jobSystem->sleepMutex);
+        while(SDL_AtomicGet(&jobSystem->pendingJobCount) == 0 && SDL_AtomicGet(&jobSystem->quitRequested) == 0) {
+            SDL_CondWait(jobSystem->sleepCondition, jobSystem->sleepMutex);
+        }
+        bool shouldQuit = SDL_AtomicGet(&jobSystem->pendingJobCount) == 0 && SDL_AtomicGet(&jobSystem->quitRequested) == 1;
+        SDL_UnlockMutex(jobSystem->sleepMutex);
+        if(shouldQuit) {
+            break;
+        }
+    }
+    return 0;
+}
+
+void JobSystem::push(uint32_t group, std::function<void()> function) {
+    uint32_t queueIndex = (uint32_t)SDL_AtomicAdd(&nextQueueIndex, 1) % queues.size();
+    WorkerQueue* queue = queues[queueIndex];
+    Job job;
+    job.group = group;
+    job.function = std::move(function);
+    SDL_LockMutex(queue->mutex);
+    queue->jobs.push_back(std::move(job));
+    SDL_UnlockMutex(queue->mutex);
+
+    SDL_AtomicIncRef(&pendingJobCount);
+    //signal under the lock, so a worker that just checked the count can't miss it
+    SDL_LockMutex(sleepMutex);
+    SDL_CondSignal(sleepCondition);
+    SDL_UnlockMutex(sleepMutex);
+}
+
+bool JobSystem::runPendingJob(uint32_t preferredQueueIndex, uint32_t group) {
+    std::function<void()> job;
+    bool found = false;
+    //own queue is used as a stack, since the last job pushed is most likely to have its data in cache
+    WorkerQueue* ownQueue = queues[preferredQueueIndex % queues.size()];
+    SDL_LockMutex(ownQueue->mutex);
+    for (size_t i = ownQueue->jobs.size(); i > 0; --i) {
+        if(group == ANY_GROUP || ownQueue->jobs[i - 1].group == group) {
+            job = std::move(ownQueue->jobs[i - 1].function);
+            ownQueue->jobs.erase(ownQueue->jobs.begin() + (i - 1));
+            found = true;
+            break;
+        }
+    }
+    SDL_UnlockMutex(ownQueue->mutex);
+
+    for (size_t i = 1; !found && i < queues.size(); ++i) {
+        WorkerQueue* victimQueue = queues[(preferredQueueIndex + i) % queues.size()];
+        SDL_LockMutex(victimQueue->mutex);
+        for (size_t j = 0; j < victimQueue->jobs.size(); ++j) {
+            if(group == ANY_GROUP || victimQueue->jobs[j].group == group) {
+                job = std::move(victimQueue->jobs[j].function);
+                victimQueue->jobs.erase(victimQueue->jobs.begin() + j);
+                found = true;
+                break;
+            }
+        }
+        SDL_UnlockMutex(victimQueue->mutex);
+    }
+
+    if(!found) {
+        return false;
+    }
+    SDL_AtomicDecRef(&pendingJobCount);
+    job();
+    return true;
+}
@@ -0,0 +1,192 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_JOBSYSTEM_H
+#define LIMONENGINE_JOBSYSTEM_H
+
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <SDL2/SDL.h>
+#include <SDL_atomic.h>
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
+
+/**
+ * Fixed size thread pool, that runs jobs on worker threads created once.
+ *
+ * Each worker has its own queue. Jobs are distributed to queues round robin, a worker runs jobs from the back of its
+ * own queue, and if it is empty, steals from the front of other queues.
+ *
+ * Submitting a job returns a Future, that can be polled, waited, or chained with then(). Jobs must return a value,
+ * jobs that have nothing to return should return bool.
+ *
+ * Each job belongs to a group. Workers run jobs of any group, but waiting on a Future only helps with the jobs of its
+ * own group, so waiting on a short frame stage can't pick up a long running job, like an AI route search. A job should
+ * not wait on a job of another group, if all workers do that, none of them is left to run the waited jobs.
+ *
+ * SDL threading primitives are used instead of std::thread, because MinGW builds don't always provide std::thread.
+ */
+class JobSystem {
+    struct Job {
+        uint32_t group;
+        std::function<void()> function;
+    };
+
+    struct WorkerQueue {
+        SDL_mutex* mutex;
+        std::deque<Job> jobs;
+    };
+
+    struct WorkerInformation {
+        JobSystem* jobSystem;
+        uint32_t index;
+    };
+
+    std::vector<WorkerQueue*> queues;
+    std::vector<WorkerInformation*> workerInformations;
+    std::vector<SDL_Thread*> threads;
+    SDL_mutex* sleepMutex;
+    SDL_cond* sleepCondition;
+    SDL_atomic_t pendingJobCount;
+    SDL_atomic_t nextQueueIndex;
+    SDL_atomic_t quitRequested;
+
+    static int workerRunner(void* ptr);
+
+    static const uint32_t ANY_GROUP;
+
+    void push(uint32_t group, std::function<void()> function);
+
+    /**
+     * Runs a single job of the group if there is any, first checking preferred queue, then stealing from others.
+     * @param group group of the job to run, ANY_GROUP runs jobs of all groups
+     * @return true if a job is run
+     */
+    bool runPendingJob(uint32_t preferredQueueIndex, uint32_t group);
+
+public:
+    static const uint32_t DEFAULT_GROUP;
+    static const uint32_t FRAME_GROUP;//short jobs the frame waits on, like culling and animation stages
+
+    template<typename ResultType>
+    class Future {
+        friend class JobSystem;
+        template<typename> friend class Future;
+
+        struct SharedState {
+            JobSystem* jobSystem;
+            uint32_t group;
+            SDL_mutex* mutex;
+            SDL_atomic_t done;
+            ResultType result;
+            std::vector<std::function<void()>> continuations;
+
+            SharedState(JobSystem* jobSystem, uint32_t group) : jobSystem(jobSystem), group(group), result() {
+                mutex = SDL_CreateMutex();
+                SDL_AtomicSet(&done, 0);
+            }
+
+            ~SharedState() {
+                SDL_DestroyMutex(mutex);
+            }
+
+            void complete(ResultType&& value) {
+                std::vector<std::function<void()>> continuationsToRun;
+                SDL_LockMutex(mutex);
+                result = std::move(value);
+                SDL_AtomicSet(&done, 1);
+                continuationsToRun.swap(continuations);
+                SDL_UnlockMutex(mutex);
+                for (size_t i = 0; i < continuationsToRun.size(); ++i) {
+                    jobSystem->push(group, continuationsToRun[i]);
+                }
+            }
+        };
+
+        std::shared_ptr<SharedState> state;
+
+        Future(JobSystem* jobSystem, uint32_t group) : state(std::make_shared<SharedState>(jobSystem, group)) {}
+
+    public:
+        Future() = default;
+
+        bool isValid() const {
+            return state != nullptr;
+        }
+
+        bool isReady() const {
+            return state != nullptr && SDL_AtomicGet(&state->done) == 1;
+        }
+
+        /**
+         * Blocks until the job is done. While waiting, runs other pending jobs of the same group instead of sleeping,
+         * so it is safe to wait from a worker thread.
+         */
+        const ResultType& get() const {
+            while(!isReady()) {
+                if(!state->jobSystem->runPendingJob(0, state->group)) {
+                    SDL_Delay(0);
+                }
+            }
+            return state->result;
+        }
+
+        /**
+         * Schedules function to run with the result of this job, after this job is done. Function runs in the same group.
+         * @return Future for the result of the function
+         */
+        template<typename Function>
+        auto then(Function function) -> Future<decltype(function(std::declval<const ResultType&>()))> {
+            typedef decltype(function(std::declval<const ResultType&>())) NextResultType;
+            Future<NextResultType> next(state->jobSystem, state->group);
+            std::shared_ptr<SharedState> previousState = state;
+            std::shared_ptr<typename Future<NextResultType>::SharedState> nextState = next.state;
+            std::function<void()> continuation = [previousState, nextState, function]() mutable {
+                nextState->complete(function(previousState->result));
+            };
+
+            SDL_LockMutex(state->mutex);
+            if(SDL_AtomicGet(&state->done) == 1) {
+                SDL_UnlockMutex(state->mutex);
+                state->jobSystem->push(state->group, continuation);
+            } else {
+                state->continuations.push_back(continuation);
+                SDL_UnlockMutex(state->mutex);
+            }
+            return next;
+        }
+    };
+
+    /**
+     * @param workerCount number of worker threads, at least 1 worker is created
+     */
+    explicit JobSystem(uint32_t workerCount);
+
+    /**
+     * Runs the remaining jobs, then joins the workers.
+     */
+    ~JobSystem();
+
+    template<typename Function>
+    auto submit(Function function, uint32_t group = DEFAULT_GROUP) -> Future<decltype(function())> {
+        typedef decltype(function()) ResultType;
+        Future<ResultType> future(this, group);
+        std::shared_ptr<typename Future<ResultType>::SharedState> sharedState = future.state;
+        push(group, [sharedState, function]() mutable {
+            sharedState->complete(function());
+        });
+        return future;
+    }
+
+    uint32_t getWorkerCount() const {
+        return (uint32_t)threads.size();
+    }
+};
+
+
+#endif //LIMONENGINE_JOBSYSTEM_H
@@ -0,0 +1,100 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <cmath>
+#include <algorithm>
+#include "LightClusters.h"
+
+uint32_t LightClusters::getDepthSlice(float viewDepth) {
+    if (viewDepth <= LIGHT_CLUSTER_NEAR) {
+        return 0;
+    }
+    float slice = std::log(viewDepth / LIGHT_CLUSTER_NEAR) * NR_LIGHT_CLUSTER_Z /
+                  std::log(LIGHT_CLUSTER_FAR / LIGHT_CLUSTER_NEAR);
+    return std::min((uint32_t)slice, (uint32_t)NR_LIGHT_CLUSTER_Z - 1);
+}
+
+void LightClusters::addLight(const glm::vec3 &position, float range, const glm::vec3 &color,
+                             const glm::vec3 &attenuation, const glm::vec3 &ambientColor) {
+    lightData.push_back(glm::vec4(position, range));
+    lightData.push_back(glm::vec4(color, 0.0f));
+    lightData.push_back(glm::vec4(attenuation, 0.0f));
+    lightData.push_back(glm::vec4(ambientColor, 0.0f));
+}
+
+void LightClusters::build(const glm::mat4 &cameraMatrix, const glm::mat4 &projectionMatrix) {
+    uint32_t lightCount = getLightCount();
+    clusterLightCounts.assign(CLUSTER_COUNT, 0);
+    lightClusterRanges.assign(lightCount * 6, 0);
+
+    for (uint32_t i = 0; i < lightCount; ++i) {
+        glm::vec3 viewPosition = glm::vec3(cameraMatrix * glm::vec4(glm::vec3(lightData[i * LIGHT_DATA_TEXELS]), 1.0f));
+        float range = lightData[i * LIGHT_DATA_TEXELS].w;
+        //camera looks at -z
+        float nearDepth = -viewPosition.z - range;
+        float farDepth = -viewPosition.z + range;
+        if (farDepth <= 0.0f) {
+            continue;//behind the camera, empty range
+        }
+
+        //screen bounds of the range box, if any corner is behind the camera, projection is not usable
+        glm::vec2 screenMin(1.0f), screenMax(-1.0f);
+        bool coversScreen = false;
+        for (int corner = 0; corner < 8 && !coversScreen; ++corner) {
+            glm::vec3 offset((corner & 1) ? range : -range, (corner & 2) ? range : -range, (corner & 4) ? range : -range);
+            glm::vec4 clip = projectionMatrix * glm::vec4(viewPosition + offset, 1.0f);
+            if (clip.w <= 0.0001f) {
+                coversScreen = true;
+                break;
+            }
+            glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            screenMin = glm::min(screenMin, ndc);
+            screenMax = glm::max(screenMax, ndc);
+        }
+        if (coversScreen) {
+            screenMin = glm::vec2(-1.0f);
+            screenMax = glm::vec2(1.0f);
+        } else if (screenMax.x < -1.0f || screenMax.y < -1.0f || screenMin.x > 1.0f || screenMin.y > 1.0f) {
+            continue;//outside of the screen
+        }
+
+        uint32_t *ranges = &lightClusterRanges[i * 6];
+        ranges[0] = (uint32_t)glm::clamp((screenMin.x * 0.5f + 0.5f) * NR_LIGHT_CLUSTER_X, 0.0f, NR_LIGHT_CLUSTER_X - 1.0f);
+        ranges[1] = (uint32_t)glm::clamp((screenMax.x * 0.5f + 0.5f) * NR_LIGHT_CLUSTER_X, 0.0f, NR_LIGHT_CLUSTER_X - 1.0f) + 1;
+        ranges[2] = (uint32_t)glm::clamp((screenMin.y * 0.5f + 0.5f) * NR_LIGHT_CLUSTER_Y, 0.0f, NR_LIGHT_CLUSTER_Y - 1.0f);
+        ranges[3] = (uint32_t)glm::clamp((screenMax.y * 0.5f + 0.5f) * NR_LIGHT_CLUSTER_Y, 0.0f, NR_LIGHT_CLUSTER_Y - 1.0f) + 1;
+        ranges[4] = getDepthSlice(std::max(nearDepth, 0.0f));
+        ranges[5] = getDepthSlice(farDepth) + 1;
+
+        for (uint32_t z = ranges[4]; z < ranges[5]; ++z) {
+            for (uint32_t y = ranges[2]; y < ranges[3]; ++y) {
+                for (uint32_t x = ranges[0]; x < ranges[1]; ++x) {
+                    clusterLightCounts[(z * NR_LIGHT_CLUSTER_Y + y) * NR_LIGHT_CLUSTER_X + x]++;
+                }
+            }
+        }
+    }
+
+    //counts to offsets, then lights are written in order, so each cluster lists its lights in increasing index
+    uint32_t indexCount = 0;
+    clusterData.resize(2 * CLUSTER_COUNT);
+    for (uint32_t cluster = 0; cluster < CLUSTER_COUNT; ++cluster) {
+        clusterData[cluster * 2] = indexCount;
+        clusterData[cluster * 2 + 1] = 0;
+        indexCount += clusterLightCounts[cluster];
+    }
+    clusterData.resize(2 * CLUSTER_COUNT + indexCount);
+    for (uint32_t i = 0; i < lightCount; ++i) {
+        const uint32_t *ranges = &lightClusterRanges[i * 6];
+        for (uint32_t z = ranges[4]; z < ranges[5]; ++z) {
+            for (uint32_t y = ranges[2]; y < ranges[3]; ++y) {
+                for (uint32_t x = ranges[0]; x < ranges[1]; ++x) {
+                    uint32_t cluster = (z * NR_LIGHT_CLUSTER_Y + y) * NR_LIGHT_CLUSTER_X + x;
+                    clusterData[2 * CLUSTER_COUNT + clusterData[cluster * 2] + clusterData[cluster * 2 + 1]] = i;
+                    clusterData[cluster * 2 + 1]++;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_LIGHTCLUSTERS_H
+#define LIMONENGINE_LIGHTCLUSTERS_H
+
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+//cluster grid and depth range, must match Model/fragment.glsl
+#define NR_LIGHT_CLUSTER_X 16
+#define NR_LIGHT_CLUSTER_Y 9
+#define NR_LIGHT_CLUSTER_Z 24
+#define LIGHT_CLUSTER_NEAR 0.5f
+#define LIGHT_CLUSTER_FAR 500.0f
+
+/**
+ * Assigns point lights to view space clusters, so each fragment only iterates the lights that can reach it.
+ *
+ * Screen is split to NR_LIGHT_CLUSTER_X x NR_LIGHT_CLUSTER_Y tiles, and view depth to NR_LIGHT_CLUSTER_Z slices that
+ * grow exponentially between LIGHT_CLUSTER_NEAR and LIGHT_CLUSTER_FAR. First slice starts at the camera, last slice
+ * has no end. A light is added to every cluster its range box overlaps on screen and in depth, so assignment is
+ * conservative.
+ *
+ * Output is in the layout shaders read:
+ *  - light data, LIGHT_DATA_TEXELS vec4 per light: position and range, color, attenuation, ambient color
+ *  - cluster data, 2 uints per cluster, offset and count of its lights in the index list, followed by the index list
+ */
+class LightClusters {
+public:
+    static const uint32_t CLUSTER_COUNT = NR_LIGHT_CLUSTER_X * NR_LIGHT_CLUSTER_Y * NR_LIGHT_CLUSTER_Z;
+    static const uint32_t LIGHT_DATA_TEXELS = 4;
+
+private:
+    std::vector<glm::vec4> lightData;
+    std::vector<uint32_t> clusterData;
+    //reused by build
+    std::vector<uint32_t> clusterLightCounts;
+    std::vector<uint32_t> lightClusterRanges;//6 per light, x, y and z ranges, end exclusive
+
+    static uint32_t getDepthSlice(float viewDepth);
+
+public:
+    void clear() {
+        lightData.clear();
+    }
+
+    void addLight(const glm::vec3 &position, float range, const glm::vec3 &color, const glm::vec3 &attenuation,
+                  const glm::vec3 &ambientColor);
+
+    /**
+     * Bins added lights to clusters of the given camera.
+     */
+    void build(const glm::mat4 &cameraMatrix, const glm::mat4 &projectionMatrix);
+
+    uint32_t getLightCount() const {
+        return (uint32_t)(lightData.size() / LIGHT_DATA_TEXELS);
+    }
+
+    const std::vector<glm::vec4> &getLightData() const {
+        return lightData;
+    }
+
+    const std::vector<uint32_t> &getClusterData() const {
+        return clusterData;
+    }
+
+    /**
+     * @return total number of light references in clusters
+     */
+    uint32_t getIndexCount() const {
+        return (uint32_t)clusterData.size() - 2 * CLUSTER_COUNT;
+    }
+};
+
+
+#endif //LIMONENGINE_LIGHTCLUSTERS_H
@@ -198,6 +198,65 @@ bool Options::loadOptions(const std::string &optionsFileName) {
         this->ssaoEnabled = false;
     }
 
+    tinyxml2::XMLElement *animationLODHalfRateDistanceNode = optionsNode->FirstChildElement(
+            "animationLODHalfRateDistance");
+    if (animationLODHalfRateDistanceNode != nullptr) {
+        animationLODHalfRateDistance = std::stof(animationLODHalfRateDistanceNode->GetText());
+    }
+
+    tinyxml2::XMLElement *animationLODQuarterRateDistanceNode = optionsNode->FirstChildElement(
+            "animationLODQuarterRateDistance");
+    if (animationLODQuarterRateDistanceNode != nullptr) {
+        animationLODQuarterRateDistance = std::stof(animationLODQuarterRateDistanceNode->GetText());
+    }
+
+    tinyxml2::XMLElement *animationLODLeafBoneDistanceNode = optionsNode->FirstChildElement(
+            "animationLODLeafBoneDistance");
+    if (animationLODLeafBoneDistanceNode != nullptr) {
+        animationLODLeafBoneDistance = std::stof(animationLODLeafBoneDistanceNode->GetText());
+    }
+
+    tinyxml2::XMLElement *animationLODLeafBoneLevelsNode = optionsNode->FirstChildElement(
+            "animationLODLeafBoneLevels");
+    if (animationLODLeafBoneLevelsNode != nullptr) {
+        animationLODLeafBoneLevels = std::stoul(animationLODLeafBoneLevelsNode->GetText());
+    }
+
+    tinyxml2::XMLElement *animationPoseCacheQuantizationNode = optionsNode->FirstChildElement(
+            "animationPoseCacheQuantization");
+    if (animationPoseCacheQuantizationNode != nullptr) {
+        animationPoseCacheQuantization = std::stof(animationPoseCacheQuantizationNode->GetText());
+    }
+
+    tinyxml2::XMLElement *animationPoseCacheToleranceNode = optionsNode->FirstChildElement(
+            "animationPoseCacheTolerance");
+    if (animationPoseCacheToleranceNode != nullptr) {
+        animationPoseCacheTolerance = std::stof(animationPoseCacheToleranceNode->GetText());
+    }
+
+    tinyxml2::XMLElement *animationPoseCacheMaximumSizeNode = optionsNode->FirstChildElement(
+            "animationPoseCacheMaximumSize");
+    if (animationPoseCacheMaximumSizeNode != nullptr) {
+        animationPoseCacheMaximumSize = std::stoul(animationPoseCacheMaximumSizeNode->GetText());
+    }
+
+    tinyxml2::XMLElement *animationCompressionTranslateToleranceNode = optionsNode->FirstChildElement(
+            "animationCompressionTranslateTolerance");
+    if (animationCompressionTranslateToleranceNode != nullptr) {
+        animationCompressionTranslateTolerance = std::stof(animationCompressionTranslateToleranceNode->GetText());
+    }
+
+    tinyxml2::XMLElement *animationCompressionRotationToleranceNode = optionsNode->FirstChildElement(
+            "animationCompressionRotationTolerance");
+    if (animationCompressionRotationToleranceNode != nullptr) {
+        animationCompressionRotationTolerance = std::stof(animationCompressionRotationToleranceNode->GetText());
+    }
+
+    tinyxml2::XMLElement *animationCompressionScaleToleranceNode = optionsNode->FirstChildElement(
+            "animationCompressionScaleTolerance");
+    if (animationCompressionScaleToleranceNode != nullptr) {
+        animationCompressionScaleTolerance = std::stof(animationCompressionScaleToleranceNode->GetText());
+    }
 
 
     loadVec3(optionsNode, "walkSpeed", walkSpeed);
@@ -54,6 +54,23 @@ private:
     uint32_t ssaoSampleCount = 9;
     bool ssaoEnabled = false;
 
+    //animation level of detail, by distance to camera. 0 disables the level
+    float animationLODHalfRateDistance = 30.0f;//animated models beyond are evaluated every 2nd tick
+    float animationLODQuarterRateDistance = 60.0f;//every 4th tick
+    float animationLODLeafBoneDistance = 40.0f;//leaf bones, like fingers, are not animated beyond
+    uint32_t animationLODLeafBoneLevels = 2;//levels from the leaves not animated beyond that. 1 is only end nodes, 2 includes finger tips
+
+    //poses of the same animation at close times are shared between instances of a model
+    float animationPoseCacheQuantization = 10.0f;//in ms, poses are cached per time bucket of this size. 0 disables
+    //in ms, cached pose is used if its bucket time is at most this far. Half of quantization or more always uses the cache
+    float animationPoseCacheTolerance = 2.0f;
+    uint32_t animationPoseCacheMaximumSize = 4 * 1024 * 1024;//in bytes, per model asset. Cache is cleared when exceeded
+
+    //animation keys that can be interpolated from their neighbours within these are removed at load
+    float animationCompressionTranslateTolerance = 0.01f;//in model units
+    float animationCompressionRotationTolerance = 0.001f;//in radians
+    float animationCompressionScaleTolerance = 0.001f;
+
     void loadVec3(tinyxml2::XMLNode *optionsNode, const std::string &name, glm::vec3&);
     void loadVec4(tinyxml2::XMLNode *optionsNode, const std::string &name, glm::vec4&);
 public:
@@ -254,6 +271,86 @@ public:
     void setSsaoEnabled(bool ssaoEnabled) {
         this->ssaoEnabled = ssaoEnabled;
     }
+
+    float getAnimationLODHalfRateDistance() const {
+        return animationLODHalfRateDistance;
+    }
+
+    void setAnimationLODHalfRateDistance(float animationLODHalfRateDistance) {
+        this->animationLODHalfRateDistance = animationLODHalfRateDistance;
+    }
+
+    float getAnimationLODQuarterRateDistance() const {
+        return animationLODQuarterRateDistance;
+    }
+
+    void setAnimationLODQuarterRateDistance(float animationLODQuarterRateDistance) {
+        this->animationLODQuarterRateDistance = animationLODQuarterRateDistance;
+    }
+
+    float getAnimationLODLeafBoneDistance() const {
+        return animationLODLeafBoneDistance;
+    }
+
+    void setAnimationLODLeafBoneDistance(float animationLODLeafBoneDistance) {
+        this->animationLODLeafBoneDistance = animationLODLeafBoneDistance;
+    }
+
+    uint32_t getAnimationLODLeafBoneLevels() const {
+        return animationLODLeafBoneLevels;
+    }
+
+    void setAnimationLODLeafBoneLevels(uint32_t animationLODLeafBoneLevels) {
+        this->animationLODLeafBoneLevels = animationLODLeafBoneLevels;
+    }
+
+    float getAnimationPoseCacheQuantization() const {
+        return animationPoseCacheQuantization;
+    }
+
+    void setAnimationPoseCacheQuantization(float animationPoseCacheQuantization) {
+        this->animationPoseCacheQuantization = animationPoseCacheQuantization;
+    }
+
+    float getAnimationPoseCacheTolerance() const {
+        return animationPoseCacheTolerance;
+    }
+
+    void setAnimationPoseCacheTolerance(float animationPoseCacheTolerance) {
+        this->animationPoseCacheTolerance = animationPoseCacheTolerance;
+    }
+
+    uint32_t getAnimationPoseCacheMaximumSize() const {
+        return animationPoseCacheMaximumSize;
+    }
+
+    void setAnimationPoseCacheMaximumSize(uint32_t animationPoseCacheMaximumSize) {
+        this->animationPoseCacheMaximumSize = animationPoseCacheMaximumSize;
+    }
+
+    float getAnimationCompressionTranslateTolerance() const {
+        return animationCompressionTranslateTolerance;
+    }
+
+    void setAnimationCompressionTranslateTolerance(float animationCompressionTranslateTolerance) {
+        this->animationCompressionTranslateTolerance = animationCompressionTranslateTolerance;
+    }
+
+    float getAnimationCompressionRotationTolerance() const {
+        return animationCompressionRotationTolerance;
+    }
+
+    void setAnimationCompressionRotationTolerance(float animationCompressionRotationTolerance) {
+        this->animationCompressionRotationTolerance = animationCompressionRotationTolerance;
+    }
+
+    float getAnimationCompressionScaleTolerance() const {
+        return animationCompressionScaleTolerance;
+    }
+
+    void setAnimationCompressionScaleTolerance(float animationCompressionScaleTolerance) {
+        this->animationCompressionScaleTolerance = animationCompressionScaleTolerance;
+    }
 };
 
 
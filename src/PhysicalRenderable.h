@@ -9,6 +9,7 @@
 #include "Renderable.h"
 #include "Utils/GLMConverter.h"
 #include "GameObjects/Sound.h"
+#include "CullingTree.h"
 #include <memory>
 
 class PhysicalRenderable : public Renderable {
@@ -24,6 +25,7 @@ protected:
     std::vector<PhysicalRenderable*> children;
     std::unique_ptr<Sound> soundAttachment2 = nullptr;
     bool customAnimation = false;
+    CullingTree *cullingTree = nullptr;//set by the tree when inserted
 
 public:
     explicit PhysicalRenderable(GLHelper *glHelper, float mass, bool disconnected)
@@ -109,6 +111,9 @@ public:
         this->aabbMin = GLMConverter::BltToGLM(abMin);
         this->aabbMax = GLMConverter::BltToGLM(abMax);
         this->dirtyForFrustum = true;
+        if(this->cullingTree != nullptr) {
+            this->cullingTree->markMoved(this);
+        }
 
         if(this->soundAttachment2 != nullptr) {
             this->soundAttachment2->setWorldPosition(this->transformation.getTranslate());
@@ -171,6 +176,10 @@ public:
     bool getCustomAnimation() {
         return customAnimation;
     }
+
+    void setCullingTree(CullingTree *cullingTree) {
+        this->cullingTree = cullingTree;
+    }
 };
 
 
@@ -369,7 +369,7 @@ void Transformation::combine(const Transformation &otherTransformation) {
 
     this->translate += otherTransformation.getTranslate();
 
-    isDirty = true;
+    markHierarchyDirty();
 
     propagateUpdate();
 }
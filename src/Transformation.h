@@ -27,6 +27,8 @@ class Transformation {
     /* EDITOR INFORMATION PART */
 
     mutable glm::mat4 worldTransform;//private
+    mutable glm::mat4 rawWorldTransform;//without custom world transform generation, children are relative to this
+    mutable bool isRawDirty = true;
 
     void setWorldTransform(const glm::mat4& transform) {
         this->worldTransform = transform;
@@ -51,7 +53,38 @@ class Transformation {
             (*iterator)->isDirty = true;
         }
     }
-    
+
+    /**
+     * Marks this and all transforms attached to it dirty, nothing is computed until they are requested. If this is
+     * already dirty, its children are too, so it stops there.
+     */
+    void markHierarchyDirty() {
+        isDirty = true;
+        if (isRawDirty) {
+            return;
+        }
+        isRawDirty = true;
+        for (auto iterator = childTransforms.begin(); iterator != childTransforms.end(); ++iterator) {
+            (*iterator)->markHierarchyDirty();
+        }
+    }
+
+    /**
+     * Parent chain transform, without custom world transform generation. Each level is computed once and cached until
+     * it or one of its parents change.
+     */
+    const glm::mat4 &getRawWorldTransform() const {
+        if (isRawDirty) {
+            if (parentTransform == nullptr) {
+                rawWorldTransform = generateWorldTransformDefault();
+            } else {
+                rawWorldTransform = parentTransform->getRawWorldTransform() * generateWorldTransformDefault();
+            }
+            isRawDirty = false;
+        }
+        return rawWorldTransform;
+    }
+
 protected:
     glm::vec3 translate = glm::vec3(0.0f, 0.0f, 0.0f);
     glm::vec3 scale = glm::vec3(1.0f, 1.0f, 1.0f);
@@ -83,35 +116,18 @@ protected:
     }
 
     glm::mat4 generateRawWorldTransformWithOrWithoutParent() const {
-        //glm::mat4 totalTransform = parentTransform->generateWorldTransformDefault() * this->generateWorldTransformSingle();
-        Transformation* parent = this->parentTransform;
-        glm::mat4 rawTotalTransform = this->generateWorldTransformDefault();
-        while(parent != nullptr) {
-            glm::mat4 parentTransformTemp = parent->generateWorldTransformDefault();
-            rawTotalTransform = parentTransformTemp * rawTotalTransform;
-            parent = parent->parentTransform;
-        }
-        return rawTotalTransform;
+        return getRawWorldTransform();
     }
 
 
     glm::mat4 generateWorldTransformWithParent(){
-        //glm::mat4 totalTransform = parentTransform->generateWorldTransformDefault() * this->generateWorldTransformSingle();
-        Transformation* parent = this->parentTransform;
-        glm::mat4 rawTotalTransform = this->generateWorldTransformDefault();
-        glm::mat4 totalTransform = this->generateWorldTransformSingle();
-        while(parent != nullptr) {
-            glm::mat4 parentTransformTemp = parent->generateWorldTransformDefault();
-            rawTotalTransform = parentTransformTemp * rawTotalTransform;
-            totalTransform = parentTransformTemp * totalTransform;
-            parent = parent->parentTransform;
-        }
+        //parent chain is cached, so only this level is computed
+        glm::mat4 totalTransform = parentTransform->getRawWorldTransform() * this->generateWorldTransformSingle();
 
-        //glm::mat4 rawTotalTransform = TotalRawTransform * this->generateWorldTransformDefault();
         glm::vec3 temp1;//these are not used
         glm::vec4 temp2;
 
-        glm::decompose(rawTotalTransform, scale, orientation, translate, temp1, temp2);//update the current of these
+        glm::decompose(getRawWorldTransform(), scale, orientation, translate, temp1, temp2);//update the current of these
         return totalTransform;
     }
 
@@ -185,6 +201,7 @@ public:
         isDirty           = otherTransformation.isDirty;
         rotated           = otherTransformation.rotated;
         worldTransform    = otherTransformation.worldTransform;
+        markHierarchyDirty();//transforms attached to this should follow the new values
     }
 
     const Transformation* getParentTransform() const {
@@ -199,7 +216,7 @@ public:
 
         this->generateWorldTransformSingle = this->generateWorldTransform;
         this->generateWorldTransform = std::bind(&Transformation::generateWorldTransformWithParent, this);
-        this->isDirty = true;
+        this->markHierarchyDirty();
 
         this->scaleSingle = this->scale;
         this->translateSingle = this->translate;
@@ -237,7 +254,7 @@ public:
         this->scale = this->scaleSingle;
         this->translate = this->translateSingle;
         this->orientation = this->orientationSingle;
-
+        this->markHierarchyDirty();
     }
 
     void setUpdateCallback(std::function<void()> updateCallback) {
@@ -255,7 +272,7 @@ public:
             this->scale *= scale;
         }
         this->scaleSingle *= scale;
-        isDirty = true;
+        markHierarchyDirty();
         propagateUpdate();
     }
 
@@ -264,7 +281,7 @@ public:
             this->scale = scale;
         }
         this->scaleSingle = scale;
-        isDirty = true;
+        markHierarchyDirty();
         propagateUpdate();
     }
 
@@ -298,7 +315,7 @@ public:
             this->translate += translate;
         }
         this->translateSingle += translate;
-        isDirty = true;
+        markHierarchyDirty();
         propagateUpdate();
     }
 
@@ -307,7 +324,7 @@ public:
             this->translate = translate;
         }
         this->translateSingle = translate;
-        isDirty = true;
+        markHierarchyDirty();
         propagateUpdate();
     }
 
@@ -317,7 +334,7 @@ public:
             this->orientation = orientationSingle;
         }
         rotated = this->orientation.w < 0.99; // with rotation w gets smaller.
-        isDirty = true;
+        markHierarchyDirty();
         propagateUpdate();
     }
 
@@ -329,7 +346,7 @@ public:
         }
 
         rotated = this->orientationSingle.w < 0.99; // with rotation w gets smaller.
-        isDirty = true;
+        markHierarchyDirty();
         propagateUpdate();
     }
 
@@ -339,11 +356,10 @@ public:
         }
         this->translateSingle = translate;
 
+        markHierarchyDirty();
         for (auto childTransform = childTransforms.begin(); childTransform != childTransforms.end(); ++childTransform) {
-            (*childTransform)->isDirty = true;
             (*childTransform)->updateCallback();
         }
-        isDirty = true;
     }
 
     void setTransformationsNotPropagate(const glm::vec3& translate, const::glm::quat& orientation) {
@@ -354,11 +370,10 @@ public:
             this->translate = translate;
             this->orientation = orientationSingle;
         }
+        markHierarchyDirty();
         for (auto childTransform = childTransforms.begin(); childTransform != childTransforms.end(); ++childTransform) {
-            (*childTransform)->isDirty = true;
             (*childTransform)->updateCallback();
         }
-        isDirty = true;
     }
 
     void setTransformationsNotPropagate(const glm::vec3& translate, const::glm::quat& orientation, const glm::vec3& scale) {
@@ -373,11 +388,10 @@ public:
             this->translate = translate;
         }
 
+        markHierarchyDirty();
         for (auto childTransform = childTransforms.begin(); childTransform != childTransforms.end(); ++childTransform) {
-            (*childTransform)->isDirty = true;
             (*childTransform)->updateCallback();
         }
-        isDirty = true;
     }
 
     bool isRotated() const {
@@ -0,0 +1,92 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include "MappedFile.h"
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::isOutdated(const std::string &fileName, const std::string &sourceFileName) {
+    struct stat fileStatus;
+    struct stat sourceStatus;
+    if (stat(fileName.c_str(), &fileStatus) != 0) {
+        return true;
+    }
+    if (stat(sourceFileName.c_str(), &sourceStatus) != 0) {
+        return false;
+    }
+    //generated file is written after its source, so only a strictly newer source means it is edited
+    return sourceStatus.st_mtime > fileStatus.st_mtime;
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &fileName) {
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        return;
+    }
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        return;
+    }
+    data = static_cast<const uint8_t *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data != nullptr) {
+        size = (size_t) fileSize.QuadPart;
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != nullptr) {
+        CloseHandle(fileHandle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &fileName) {
+    fileDescriptor = open(fileName.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        return;
+    }
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0) {
+        return;
+    }
+    void *mapping = mmap(nullptr, (size_t) fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+    data = static_cast<const uint8_t *>(mapping);
+    size = (size_t) fileStatus.st_size;
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(const_cast<uint8_t *>(data), size);
+    }
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+    }
+}
+
+#endif
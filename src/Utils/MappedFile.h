@@ -0,0 +1,55 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_MAPPEDFILE_H
+#define LIMONENGINE_MAPPEDFILE_H
+
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Read only memory mapping of a whole file. The file content is paged in by the OS when accessed, instead of read
+ * into a buffer. Mapping is removed when the object is destroyed, so pointers to data must not outlive it.
+ */
+class MappedFile {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+
+public:
+    explicit MappedFile(const std::string &fileName);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isValid() const {
+        return data != nullptr;
+    }
+
+    const uint8_t *getData() const {
+        return data;
+    }
+
+    size_t getSize() const {
+        return size;
+    }
+
+    /**
+     * For files generated from another file, like binary caches of xml files.
+     * @return true if the file is missing, or the source file is modified after it. False if there is no source file.
+     */
+    static bool isOutdated(const std::string &fileName, const std::string &sourceFileName);
+};
+
+
+#endif //LIMONENGINE_MAPPEDFILE_H
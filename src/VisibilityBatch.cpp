@@ -0,0 +1,173 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <cmath>
+#include <cassert>
+#include "VisibilityBatch.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define LIMON_VISIBILITY_BATCH_SSE
+#include <xmmintrin.h>
+#endif
+
+void VisibilityBatch::clear() {
+    objectCount = 0;
+    minX.clear();
+    minY.clear();
+    minZ.clear();
+    maxX.clear();
+    maxY.clear();
+    maxZ.clear();
+    positionX.clear();
+    positionY.clear();
+    positionZ.clear();
+    volumes.clear();
+    masks.clear();
+}
+
+void VisibilityBatch::reserve(size_t objectCount) {
+    size_t paddedCount = (objectCount + 3) & ~(size_t)3;
+    std::vector<float> *components[9] = {&minX, &minY, &minZ, &maxX, &maxY, &maxZ,
+                                         &positionX, &positionY, &positionZ};
+    for (std::vector<float> *component : components) {
+        component->reserve(paddedCount);
+    }
+    masks.reserve(paddedCount);
+}
+
+size_t VisibilityBatch::addObject(const glm::vec3 &aabbMin, const glm::vec3 &aabbMax, const glm::vec3 &position) {
+    assert(minX.size() == objectCount);//cull pads the arrays, clear is required before adding again
+    minX.push_back(aabbMin.x);
+    minY.push_back(aabbMin.y);
+    minZ.push_back(aabbMin.z);
+    maxX.push_back(aabbMax.x);
+    maxY.push_back(aabbMax.y);
+    maxZ.push_back(aabbMax.z);
+    positionX.push_back(position.x);
+    positionY.push_back(position.y);
+    positionZ.push_back(position.z);
+    return objectCount++;
+}
+
+uint32_t VisibilityBatch::addFrustum(const std::vector<glm::vec4> &planes) {
+    assert(volumes.size() < MAX_VOLUMES);
+    assert(planes.size() >= 6);
+    Volume volume{};
+    volume.isFrustum = true;
+    for (int i = 0; i < 6; ++i) {
+        volume.planes[i] = planes[i];
+    }
+    volumes.push_back(volume);
+    return (uint32_t)volumes.size() - 1;
+}
+
+uint32_t VisibilityBatch::addRange(const glm::vec3 &center, float distance) {
+    assert(volumes.size() < MAX_VOLUMES);
+    Volume volume{};
+    volume.isFrustum = false;
+    volume.center = center;
+    volume.distanceSquared = distance * distance;
+    volumes.push_back(volume);
+    return (uint32_t)volumes.size() - 1;
+}
+
+void VisibilityBatch::cullScalar() {
+    masks.assign(objectCount, 0);
+    for (size_t i = 0; i < objectCount; ++i) {
+        uint32_t mask = 0;
+        for (size_t volumeIndex = 0; volumeIndex < volumes.size(); ++volumeIndex) {
+            const Volume &volume = volumes[volumeIndex];
+            bool inside = true;
+            if (volume.isFrustum) {
+                for (int j = 0; j < 6; ++j) {
+                    //pick the corner furthest along plane normal, if it is behind the plane, object is outside
+                    const glm::vec4 &plane = volume.planes[j];
+                    float d = std::fmax(minX[i] * plane.x, maxX[i] * plane.x)
+                              + std::fmax(minY[i] * plane.y, maxY[i] * plane.y)
+                              + std::fmax(minZ[i] * plane.z, maxZ[i] * plane.z)
+                              + plane.w;
+                    inside &= d > 0;
+                }
+            } else {
+                float x = volume.center.x - positionX[i];
+                float y = volume.center.y - positionY[i];
+                float z = volume.center.z - positionZ[i];
+                inside = x * x + y * y + z * z < volume.distanceSquared;
+            }
+            if (inside) {
+                mask |= 1u << volumeIndex;
+            }
+        }
+        masks[i] = mask;
+    }
+}
+
+#ifdef LIMON_VISIBILITY_BATCH_SSE
+
+void VisibilityBatch::cull() {
+    size_t paddedCount = (objectCount + 3) & ~(size_t)3;
+    std::vector<float> *components[9] = {&minX, &minY, &minZ, &maxX, &maxY, &maxZ,
+                                         &positionX, &positionY, &positionZ};
+    for (std::vector<float> *component : components) {
+        component->resize(paddedCount, 0.0f);
+    }
+    masks.assign(paddedCount, 0);
+
+    const __m128 zero = _mm_setzero_ps();
+    //all volumes are tested while the group is loaded, so object data is read once
+    for (size_t i = 0; i < paddedCount; i += 4) {
+        __m128 minX4 = _mm_loadu_ps(&minX[i]);
+        __m128 minY4 = _mm_loadu_ps(&minY[i]);
+        __m128 minZ4 = _mm_loadu_ps(&minZ[i]);
+        __m128 maxX4 = _mm_loadu_ps(&maxX[i]);
+        __m128 maxY4 = _mm_loadu_ps(&maxY[i]);
+        __m128 maxZ4 = _mm_loadu_ps(&maxZ[i]);
+        __m128 positionX4 = _mm_loadu_ps(&positionX[i]);
+        __m128 positionY4 = _mm_loadu_ps(&positionY[i]);
+        __m128 positionZ4 = _mm_loadu_ps(&positionZ[i]);
+        for (size_t volumeIndex = 0; volumeIndex < volumes.size(); ++volumeIndex) {
+            const Volume &volume = volumes[volumeIndex];
+            __m128 inside;
+            if (volume.isFrustum) {
+                inside = _mm_cmpeq_ps(zero, zero);//all bits set
+                for (int j = 0; j < 6; ++j) {
+                    const glm::vec4 &plane = volume.planes[j];
+                    __m128 planeX = _mm_set1_ps(plane.x);
+                    __m128 planeY = _mm_set1_ps(plane.y);
+                    __m128 planeZ = _mm_set1_ps(plane.z);
+                    __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                            _mm_max_ps(_mm_mul_ps(minX4, planeX), _mm_mul_ps(maxX4, planeX)),
+                            _mm_max_ps(_mm_mul_ps(minY4, planeY), _mm_mul_ps(maxY4, planeY))),
+                            _mm_max_ps(_mm_mul_ps(minZ4, planeZ), _mm_mul_ps(maxZ4, planeZ))),
+                            _mm_set1_ps(plane.w));
+                    inside = _mm_and_ps(inside, _mm_cmpgt_ps(d, zero));
+                }
+            } else {
+                __m128 x = _mm_sub_ps(_mm_set1_ps(volume.center.x), positionX4);
+                __m128 y = _mm_sub_ps(_mm_set1_ps(volume.center.y), positionY4);
+                __m128 z = _mm_sub_ps(_mm_set1_ps(volume.center.z), positionZ4);
+                __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+                inside = _mm_cmplt_ps(distanceSquared, _mm_set1_ps(volume.distanceSquared));
+            }
+            int insideBits = _mm_movemask_ps(inside);
+            if (insideBits == 0) {
+                continue;
+            }
+            uint32_t volumeBit = 1u << volumeIndex;
+            for (int lane = 0; lane < 4; ++lane) {
+                if (insideBits & (1 << lane)) {
+                    masks[i + lane] |= volumeBit;
+                }
+            }
+        }
+    }
+}
+
+#else
+
+void VisibilityBatch::cull() {
+    cullScalar();
+}
+
+#endif
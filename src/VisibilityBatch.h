@@ -0,0 +1,93 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#ifndef LIMONENGINE_VISIBILITYBATCH_H
+#define LIMONENGINE_VISIBILITYBATCH_H
+
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+/**
+ * Tests a list of objects against multiple frusta and ranges in a single pass over the objects.
+ *
+ * Object AABBs and positions are kept with each component in its own array, so 4 objects are tested with a single SSE
+ * instruction. Arrays are padded to a multiple of 4, results of padding are ignored.
+ *
+ * Each added volume is assigned a bit, and cull sets that bit in the mask of each object inside the volume:
+ *  - frustum test is the same as GLHelper::isInFrustum
+ *  - range test is the same as point light check of Light::isShadowCaster, it uses object position, not AABB
+ *
+ * cullScalar is the reference implementation, cull uses SSE if the target supports it, and falls back to cullScalar
+ * otherwise. Both use the same operations in the same order, so they give the same results.
+ */
+class VisibilityBatch {
+public:
+    static const uint32_t MAX_VOLUMES = 32;
+
+private:
+    struct Volume {
+        bool isFrustum;
+        glm::vec4 planes[6];//if frustum
+        glm::vec3 center;//if range
+        float distanceSquared;//if range
+    };
+
+    size_t objectCount = 0;
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<Volume> volumes;
+    std::vector<uint32_t> masks;
+
+public:
+    /**
+     * Removes objects and volumes, keeps allocated memory.
+     */
+    void clear();
+
+    void reserve(size_t objectCount);
+
+    /**
+     * Objects can't be added after cull, until clear.
+     * @return index of the object, to get its mask after cull
+     */
+    size_t addObject(const glm::vec3 &aabbMin, const glm::vec3 &aabbMax, const glm::vec3 &position);
+
+    /**
+     * @param planes 6 planes, pointing inside
+     * @return bit of the frustum in the masks
+     */
+    uint32_t addFrustum(const std::vector<glm::vec4> &planes);
+
+    /**
+     * @return bit of the range in the masks
+     */
+    uint32_t addRange(const glm::vec3 &center, float distance);
+
+    void cullScalar();
+
+    void cull();
+
+    uint32_t getMask(size_t objectIndex) const {
+        return masks[objectIndex];
+    }
+
+    bool isVisible(size_t objectIndex, uint32_t volumeBit) const {
+        return (masks[objectIndex] & (1u << volumeBit)) != 0;
+    }
+
+    size_t getObjectCount() const {
+        return objectCount;
+    }
+
+    size_t getVolumeCount() const {
+        return volumes.size();
+    }
+};
+
+
+#endif //LIMONENGINE_VISIBILITYBATCH_H
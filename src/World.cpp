@@ -36,6 +36,7 @@
 #include "PostProcess/SSAOPostProcess.h"
 #include "PostProcess/SSAOBlurPostProcess.h"
 #include "SDL2Helper.h"
+#include "Utils/MappedFile.h"
 
 
    const std::map<World::PlayerInfo::Types, std::string> World::PlayerInfo::typeNames =
@@ -47,8 +48,8 @@
     };
 
 World::World(const std::string &name, PlayerInfo startingPlayerType, InputHandler *inputHandler,
-             AssetManager *assetManager, Options *options)
-        : assetManager(assetManager),options(options), glHelper(assetManager->getGlHelper()), alHelper(assetManager->getAlHelper()), name(name), fontManager(glHelper), startingPlayer(startingPlayerType) {
+             AssetManager *assetManager, JobSystem *jobSystem, Options *options)
+        : assetManager(assetManager), jobSystem(jobSystem), options(options), glHelper(assetManager->getGlHelper()), alHelper(assetManager->getAlHelper()), name(name), fontManager(glHelper), startingPlayer(startingPlayerType) {
 
     strncpy(worldSaveNameBuffer, name.c_str(), sizeof(worldSaveNameBuffer) -1 );
 
@@ -86,7 +87,7 @@ World::World(const std::string &name, PlayerInfo startingPlayerType, InputHandle
 
     renderCounts = new GUIText(glHelper, getNextObjectID(), "Render Counts",
                                fontManager.getFont("./Data/Fonts/Helvetica-Normal.ttf", 16), "0", glm::vec3(204, 204, 0));
-    renderCounts->set2dWorldTransform(glm::vec2(options->getScreenWidth() - 170, options->getScreenHeight() - 36), 0);
+    renderCounts->set2dWorldTransform(glm::vec2(options->getScreenWidth() - 250, options->getScreenHeight() - 36), 0);
 
     cursor = new GUICursor(glHelper, assetManager, "./Data/Textures/crosshair.png");
 
@@ -152,9 +153,9 @@ World::World(const std::string &name, PlayerInfo startingPlayerType, InputHandle
 
     onLoadActions.push_back(new ActionForOnload());//this is here for editor, as if no action is added, editor would fail to allow setting the first one.
 
-    modelIndicesBuffer.reserve(NR_MAX_MODELS);
     modelsInLightFrustum.resize(NR_TOTAL_LIGHTS);
     animatedModelsInLightFrustum.resize(NR_TOTAL_LIGHTS);
+    pointShadowCaches.resize(NR_TOTAL_LIGHTS);
     activeLights.reserve(NR_TOTAL_LIGHTS);
 
     /************ ImGui *****************************/
@@ -250,14 +251,14 @@ World::World(const std::string &name, PlayerInfo startingPlayerType, InputHandle
                  updatedModels.push_back(model);
              }
          }
-         for (auto modelAssetIterator = modelsInCameraFrustum.begin(); modelAssetIterator != modelsInCameraFrustum.end(); ++modelAssetIterator) {
-             for (auto modelIterator = modelAssetIterator->second.begin(); modelIterator != modelAssetIterator->second.end(); ++modelIterator) {
-                 (*modelIterator)->setupForTime(gameTime);
+         const std::map<uint32_t, InstancedRenderList::Batch>& cameraBatches = modelsInCameraFrustum.getBatches();
+         for (auto batchIterator = cameraBatches.begin(); batchIterator != cameraBatches.end(); ++batchIterator) {
+             const std::vector<Model*>& models = batchIterator->second.models;
+             for (size_t i = 0; i < models.size(); ++i) {
+                 models[i]->setupForTime(gameTime);
              }
          }
-         for (auto modelIt = animatedModelsInAnyFrustum.begin(); modelIt != animatedModelsInAnyFrustum.end(); ++modelIt) {
-             (*modelIt)->setupForTime(gameTime);
-         }
+         setupAnimatedModelsForTime(gameTime);
      }
 
      for (size_t j = 0; j < activeLights.size(); ++j) {
@@ -372,55 +373,291 @@ World::World(const std::string &name, PlayerInfo startingPlayerType, InputHandle
    }
 
    void World::fillVisibleObjects(){
+    //objects added or moved by editor are in updatedModels, anything else that changed AABB marked itself
+    for (size_t i = 0; i < updatedModels.size(); ++i) {
+        cullingTree.markMoved(updatedModels[i]);
+    }
+
+    /*
+     * Each changed frustum is a pass, culled from scratch with candidates from the tree. Objects that moved are a
+     * single pass, tested against all frusta that didn't change.
+     */
+    size_t passCount = 0;
+    //passes and jobs are never shrunk, so their buffers are reused
+    auto addPass = [this, &passCount]() -> CullingPass& {
+        if(cullingPasses.size() <= passCount) {
+            cullingPasses.resize(passCount + 1);
+        }
+        return cullingPasses[passCount++];
+    };
     if(camera->isDirty()) {
-        modelsInCameraFrustum.clear();
-        animatedModelsInFrustum.clear();
-        for (auto objectIt = objects.begin(); objectIt != objects.end(); ++objectIt) {
-            setVisibilityAndPutToSets(objectIt->second, false);
+        CullingPass& cameraPass = addPass();
+        cameraPass.isCameraTested = true;
+        cameraPass.lightIndexes.clear();
+        cameraPass.removePossible = false;
+    }
+    for (uint32_t currentLightIndex = 0; currentLightIndex < activeLights.size(); ++currentLightIndex) {
+        if(activeLights[currentLightIndex]->isFrustumChanged()) {
+            CullingPass& lightPass = addPass();
+            lightPass.isCameraTested = false;
+            lightPass.lightIndexes.assign(1, currentLightIndex);
+            lightPass.removePossible = false;
+        }
+    }
+    size_t changedPassCount = passCount;
+    CullingPass& movedPass = addPass();
+    movedPass.objects.clear();
+    cullingTree.refit(movedPass.objects);
+    //light sets are not updated yet, so both old and new ranges are checked
+    for (size_t i = 0; i < movedPass.objects.size(); ++i) {
+        Model* movedModel = dynamic_cast<Model*>(movedPass.objects[i]);
+        if(movedModel != nullptr) {
+            markPointShadowsDirty(movedModel);
+        }
+    }
+    movedPass.isCameraTested = !camera->isDirty();
+    movedPass.lightIndexes.clear();
+    for (uint32_t currentLightIndex = 0; currentLightIndex < activeLights.size(); ++currentLightIndex) {
+        if(!activeLights[currentLightIndex]->isFrustumChanged()) {
+            movedPass.lightIndexes.push_back(currentLightIndex);
+        }
+    }
+    movedPass.removePossible = true;
+    if(!movedPass.isCameraTested && movedPass.lightIndexes.empty()) {
+        movedPass.objects.clear();
+    }
+
+    //tree is only read, changed frusta can be queried concurrently
+    if(changedPassCount <= 1 || jobSystem->getWorkerCount() <= 1) {
+        for (size_t i = 0; i < changedPassCount; ++i) {
+            queryCullingCandidates(cullingPasses[i]);
         }
     } else {
-        //if camera frustum not changed, but object itself changed case
-        for (size_t i = 0; i < updatedModels.size(); ++i) {
-            setVisibilityAndPutToSets(updatedModels[i], true);
+        std::vector<JobSystem::Future<bool>> queryJobs;
+        for (size_t i = 0; i < changedPassCount; ++i) {
+            queryJobs.push_back(jobSystem->submit([this, i]() {
+                queryCullingCandidates(cullingPasses[i]);
+                return true;
+            }, JobSystem::FRAME_GROUP));
+        }
+        for (size_t i = 0; i < queryJobs.size(); ++i) {
+            queryJobs[i].get();
+        }
+    }
+
+    //passes are split to chunks, so large passes are spread to all workers
+    size_t totalObjectCount = 0;
+    for (size_t i = 0; i < passCount; ++i) {
+        totalObjectCount += cullingPasses[i].objects.size();
+    }
+    size_t chunkSize = std::max((size_t)MINIMUM_OBJECTS_PER_CULLING_JOB,
+                                (totalObjectCount + jobSystem->getWorkerCount() - 1) / jobSystem->getWorkerCount());
+    size_t jobCount = 0;
+    for (size_t i = 0; i < passCount; ++i) {
+        for (size_t begin = 0; begin < cullingPasses[i].objects.size(); begin += chunkSize) {
+            if(cullingJobs.size() <= jobCount) {
+                cullingJobs.resize(jobCount + 1);
+            }
+            CullingJob& job = cullingJobs[jobCount++];
+            job.passIndex = i;
+            job.begin = begin;
+            job.end = std::min(cullingPasses[i].objects.size(), begin + chunkSize);
+        }
+    }
+    if(jobCount <= 1) {
+        for (size_t i = 0; i < jobCount; ++i) {
+            runCullingJob(cullingJobs[i]);
+        }
+    } else {
+        std::vector<JobSystem::Future<bool>> chunkJobs;
+        for (size_t i = 0; i < jobCount; ++i) {
+            chunkJobs.push_back(jobSystem->submit([this, i]() {
+                runCullingJob(cullingJobs[i]);
+                return true;
+            }, JobSystem::FRAME_GROUP));
+        }
+        for (size_t i = 0; i < chunkJobs.size(); ++i) {
+            chunkJobs[i].get();
         }
     }
 
+    //render lists are not thread safe, results are merged here, in pass order
+    if(camera->isDirty()) {
+        modelsInCameraFrustum.clear();
+        animatedModelsInFrustum.clear();
+    }
     for (size_t currentLightIndex = 0; currentLightIndex < activeLights.size(); ++currentLightIndex) {
         if(activeLights[currentLightIndex]->isFrustumChanged()) {
             modelsInLightFrustum[currentLightIndex].clear();
             animatedModelsInLightFrustum[currentLightIndex].clear();
-            for (auto objectIt = objects.begin(); objectIt != objects.end(); ++objectIt) {
-                setLightVisibilityAndPutToSets(currentLightIndex, objectIt->second, false);
+        }
+    }
+    for (size_t i = 0; i < jobCount; ++i) {
+        const CullingJob& job = cullingJobs[i];
+        const CullingPass& pass = cullingPasses[job.passIndex];
+        uint32_t firstLightBit = pass.isCameraTested ? 1 : 0;
+        for (size_t j = job.begin; j < job.end; ++j) {
+            size_t batchIndex = j - job.begin;
+            if(pass.isCameraTested) {
+                setVisibilityAndPutToSets(pass.objects[j], job.batch.isVisible(batchIndex, 0), pass.removePossible);
             }
-            activeLights[currentLightIndex]->setFrustumChanged(false);
-        } else {
-            //if camera frustum not changed, but object itself changed case
-            for (size_t i = 0; i < updatedModels.size(); ++i) {
-                setLightVisibilityAndPutToSets(currentLightIndex, updatedModels[i], true);
+            for (uint32_t k = 0; k < pass.lightIndexes.size(); ++k) {
+                setLightVisibilityAndPutToSets(pass.lightIndexes[k], pass.objects[j],
+                                               job.batch.isVisible(batchIndex, firstLightBit + k), pass.removePossible);
             }
         }
     }
 
+    for (size_t currentLightIndex = 0; currentLightIndex < activeLights.size(); ++currentLightIndex) {
+        activeLights[currentLightIndex]->setFrustumChanged(false);
+    }
     updatedModels.clear();
 }
 
-void World::setLightVisibilityAndPutToSets(size_t currentLightIndex, PhysicalRenderable *PhysicalRenderable, bool removePossible) {
+void World::queryCullingCandidates(CullingPass &pass) const {
+    pass.objects.clear();
+    if(pass.isCameraTested) {
+        cullingTree.queryFrustum(glHelper->getFrustumPlanes(), pass.objects);
+        return;
+    }
+    const Light* light = activeLights[pass.lightIndexes[0]];
+    if(light->getLightType() == Light::DIRECTIONAL) {
+        cullingTree.queryFrustum(light->getFrustumPlanes(), pass.objects);
+    } else {
+        glm::vec3 range(light->getActiveDistance());
+        cullingTree.queryAABB(light->getPosition() - range, light->getPosition() + range, pass.objects);
+    }
+}
+
+bool World::isStaticShadowCaster(const Model *model) {
+    return !model->isAnimated() && model->getMass() == 0;
+}
+
+void World::markPointShadowsDirty(Model *model) {
+    bool isStatic = isStaticShadowCaster(model);
+    for (size_t i = 0; i < activeLights.size(); ++i) {
+        if(activeLights[i]->getLightType() != Light::POINT) {
+            continue;
+        }
+        bool wasInRange = model->isAnimated() ? animatedModelsInLightFrustum[i].contains(model) :
+                                                modelsInLightFrustum[i].contains(model);
+        if(!wasInRange && !activeLights[i]->isShadowCaster(model->getAabbMin(), model->getAabbMax(),
+                                                           model->getTransformation()->getTranslate())) {
+            continue;
+        }
+        if(isStatic) {
+            pointShadowCaches[i].staticDirty = true;
+        } else {
+            pointShadowCaches[i].dynamicDirty = true;
+        }
+    }
+}
+
+void World::renderPointShadowCasters(const InstancedRenderList &renderList, bool isStatic) {
+    for (auto batchIterator = renderList.getBatches().begin(); batchIterator != renderList.getBatches().end(); ++batchIterator) {
+        const InstancedRenderList::Batch& batch = batchIterator->second;
+        shadowCasterIndices.clear();
+        for (size_t i = 0; i < batch.models.size(); ++i) {
+            if(isStaticShadowCaster(batch.models[i]) == isStatic) {
+                shadowCasterIndices.push_back(batch.modelIndices[i]);
+            }
+        }
+        if(!shadowCasterIndices.empty()) {
+            batch.models[0]->renderWithProgramInstanced(shadowCasterIndices, *shadowMapProgramPoint);
+        }
+    }
+}
+
+void World::runCullingJob(CullingJob &job) const {
+    const CullingPass& pass = cullingPasses[job.passIndex];
+    job.batch.clear();
+    job.batch.reserve(job.end - job.begin);
+    for (size_t i = job.begin; i < job.end; ++i) {
+        job.batch.addObject(pass.objects[i]->getAabbMin(), pass.objects[i]->getAabbMax(),
+                            pass.objects[i]->getTransformation()->getTranslate());
+    }
+    if(pass.isCameraTested) {
+        job.batch.addFrustum(glHelper->getFrustumPlanes());
+    }
+    for (size_t i = 0; i < pass.lightIndexes.size(); ++i) {
+        activeLights[pass.lightIndexes[i]]->addToVisibilityBatch(job.batch);
+    }
+    job.batch.cull();
+}
+
+void World::setAnimationLOD(Model *model, const glm::vec3 &cameraPosition) const {
+    float distanceSquared = glm::length2(model->getTransformation()->getTranslate() - cameraPosition);
+    float halfRateDistance = options->getAnimationLODHalfRateDistance();
+    float quarterRateDistance = options->getAnimationLODQuarterRateDistance();
+    float leafBoneDistance = options->getAnimationLODLeafBoneDistance();
+
+    uint32_t updateInterval = 1;
+    if(quarterRateDistance > 0 && distanceSquared > quarterRateDistance * quarterRateDistance) {
+        updateInterval = 4;
+    } else if(halfRateDistance > 0 && distanceSquared > halfRateDistance * halfRateDistance) {
+        updateInterval = 2;
+    }
+    uint32_t skippedBoneLevels = 0;
+    if(leafBoneDistance > 0 && distanceSquared > leafBoneDistance * leafBoneDistance) {
+        skippedBoneLevels = options->getAnimationLODLeafBoneLevels();
+    }
+    model->setAnimationLOD(updateInterval, skippedBoneLevels, animationTick);
+}
+
+void World::setupAnimatedModelsForTime(long gameTime) {
+    animationStageModels.assign(animatedModelsInAnyFrustum.begin(), animatedModelsInAnyFrustum.end());
+    animationStagePoseUpdates.resize(animationStageModels.size());
+    size_t modelCount = animationStageModels.size();
+    //models that are not in any frustum are not updated at all, they catch up when they become visible again
+    ++animationTick;
+    glm::vec3 cameraPosition = camera->getPosition();
+    for (size_t i = 0; i < modelCount; ++i) {
+        setAnimationLOD(animationStageModels[i], cameraPosition);
+    }
+    size_t chunkCount = std::min((size_t)jobSystem->getWorkerCount(),
+                                 (modelCount + MINIMUM_MODELS_PER_ANIMATION_JOB - 1) / MINIMUM_MODELS_PER_ANIMATION_JOB);
+    if(chunkCount <= 1) {
+        for (size_t i = 0; i < modelCount; ++i) {
+            animationStagePoseUpdates[i] = animationStageModels[i]->updatePose(gameTime);
+        }
+    } else {
+        //each model only writes its own pose, so models can be evaluated in any order
+        size_t chunkSize = (modelCount + chunkCount - 1) / chunkCount;
+        std::vector<JobSystem::Future<bool>> chunkJobs;
+        for (size_t i = 0; i < chunkCount; ++i) {
+            size_t begin = i * chunkSize;
+            size_t end = std::min(modelCount, begin + chunkSize);
+            if(begin >= end) {
+                break;
+            }
+            chunkJobs.push_back(jobSystem->submit([this, begin, end, gameTime]() {
+                for (size_t j = begin; j < end; ++j) {
+                    animationStagePoseUpdates[j] = animationStageModels[j]->updatePose(gameTime);
+                }
+                return true;
+            }, JobSystem::FRAME_GROUP));
+        }
+        for (size_t i = 0; i < chunkJobs.size(); ++i) {
+            chunkJobs[i].get();
+        }
+    }
+    //physics is not thread safe, compound shapes are updated here in set order
+    for (size_t i = 0; i < modelCount; ++i) {
+        animationStageModels[i]->finishSetupForTime(gameTime, animationStagePoseUpdates[i] != 0);
+        animationPosesEvaluated += animationStagePoseUpdates[i];
+    }
+}
+
+void World::setLightVisibilityAndPutToSets(size_t currentLightIndex, PhysicalRenderable *PhysicalRenderable, bool isVisible, bool removePossible) {
     Model* currentModel = dynamic_cast<Model*>(PhysicalRenderable);
     assert(currentModel != nullptr);
-    currentModel->setIsInLightFrustum(currentLightIndex,
-                                      activeLights[currentLightIndex]->isShadowCaster(currentModel->getAabbMin(),
-                                                                                            currentModel->getAabbMax(),
-                                                                                            currentModel->getTransformation()->getTranslate()));
+    currentModel->setIsInLightFrustum(currentLightIndex, isVisible);
     if(currentModel->isInLightFrustum(currentLightIndex)) {
         if(currentModel->isAnimated()) {
             animatedModelsInLightFrustum[currentLightIndex].insert(currentModel);
             animatedModelsInAnyFrustum.insert(currentModel);
         } else {
-            if (modelsInLightFrustum[currentLightIndex].find(currentModel->getAssetID()) ==
-                modelsInLightFrustum[currentLightIndex].end()) {
-                modelsInLightFrustum[currentLightIndex][currentModel->getAssetID()] = std::set<Model *>();
-            }
-            modelsInLightFrustum[currentLightIndex][currentModel->getAssetID()].insert(currentModel);
+            modelsInLightFrustum[currentLightIndex].insert(currentModel);
         }
     } else if(removePossible) {
         //if remove possible, and not in light frustum, search for the model, and remove
@@ -428,9 +665,9 @@ void World::setLightVisibilityAndPutToSets(size_t currentLightIndex, PhysicalRen
             bool isInAnyFrustum = false;
             animatedModelsInLightFrustum[currentLightIndex].erase(currentModel);
             //now check if it is in any other frustums
-            if(animatedModelsInFrustum.find(currentModel) == animatedModelsInFrustum.end()) {
+            if(!animatedModelsInFrustum.contains(currentModel)) {
                 for (uint32_t i = 0; i < animatedModelsInLightFrustum.size(); ++i) {
-                    if(animatedModelsInLightFrustum[i].find(currentModel) != animatedModelsInLightFrustum[i].end()) {
+                    if(animatedModelsInLightFrustum[i].contains(currentModel)) {
                         isInAnyFrustum = true;
                         break;
                     }
@@ -441,24 +678,21 @@ void World::setLightVisibilityAndPutToSets(size_t currentLightIndex, PhysicalRen
             }
         } else {
             //if not animated
-            modelsInLightFrustum[currentLightIndex][currentModel->getAssetID()].erase(currentModel);
+            modelsInLightFrustum[currentLightIndex].erase(currentModel);
         }
     }
 }
 
-void World::setVisibilityAndPutToSets(PhysicalRenderable *PhysicalRenderable, bool removePossible) {
+void World::setVisibilityAndPutToSets(PhysicalRenderable *PhysicalRenderable, bool isVisible, bool removePossible) {
     Model* currentModel = dynamic_cast<Model*>(PhysicalRenderable);
     assert(currentModel != nullptr);
-    currentModel->setIsInFrustum(glHelper->isInFrustum(currentModel->getAabbMin(), currentModel->getAabbMax()));
+    currentModel->setIsInFrustum(isVisible);
     if(currentModel->isIsInFrustum()) {
         if(currentModel->isAnimated()) {
             animatedModelsInFrustum.insert(currentModel);
             animatedModelsInAnyFrustum.insert(currentModel);
         } else {
-            if (modelsInCameraFrustum.find(currentModel->getAssetID()) == modelsInCameraFrustum.end()) {
-                modelsInCameraFrustum[currentModel->getAssetID()] = std::set<Model *>();
-            }
-            modelsInCameraFrustum[currentModel->getAssetID()].insert(currentModel);
+            modelsInCameraFrustum.insert(currentModel);
         }
     } else if(removePossible) {
         //if remove possible, and not in frustum, search for the model, and remove
@@ -467,7 +701,7 @@ void World::setVisibilityAndPutToSets(PhysicalRenderable *PhysicalRenderable, bo
             animatedModelsInFrustum.erase(currentModel);
             //now check if it is in any other frustums
             for (uint32_t i = 0; i < animatedModelsInLightFrustum.size(); ++i) {
-                if(animatedModelsInLightFrustum[i].find(currentModel) != animatedModelsInLightFrustum[i].end()) {
+                if(animatedModelsInLightFrustum[i].contains(currentModel)) {
                     isInAnyFrustum = true;
                     break;
                 }
@@ -477,7 +711,7 @@ void World::setVisibilityAndPutToSets(PhysicalRenderable *PhysicalRenderable, bo
             }
         } else {
             //if not animated
-            modelsInCameraFrustum[currentModel->getAssetID()].erase(currentModel);
+            modelsInCameraFrustum.erase(currentModel);
         }
     }
 }
@@ -534,31 +768,35 @@ ActorInterface::ActorInformation World::fillActorInformation(ActorInterface *act
             information.isPlayerDown = false;
         }
         ActorInterface::InformationRequest requests = actor->getRequests();
-        if (requests.routeToPlayer == true && routeThreads.find(actor->getWorldID()) == routeThreads.end()) {//if no thread is working for route to player
-            std::vector<LimonAPI::ParameterRequest> parameters;
-            parameters.push_back(LimonAPI::ParameterRequest());
-
-            parameters[0].value.vectorValue = GLMConverter::GLMToLimon(
-                    actor->getPosition() + glm::vec3(0, AIMovementGrid::floatingHeight, 0));
-            parameters.push_back(LimonAPI::ParameterRequest());
-            parameters[1].value.longValues[0] = 2;
-            parameters[1].value.longValues[1] = actor->getWorldID();
-            parameters[1].value.longValues[2] = information.maximumRouteDistance;
-
-            std::function<std::vector<LimonAPI::ParameterRequest>(
-                    std::vector<LimonAPI::ParameterRequest>)> functionToRun =
-                    std::bind(&World::fillRouteInformation, this, std::placeholders::_1);
-            routeThreads[actor->getWorldID()] = new SDL2Helper::Thread("FillRouteForActor", functionToRun, parameters);
-            routeThreads[actor->getWorldID()]->run();
+        if (requests.routeToPlayer == true && navigationSnapshot != nullptr &&
+            routeRequests.find(actor->getWorldID()) == routeRequests.end()) {//if no job is working for route to player
+            //everything the job needs is copied here, so the job doesn't touch world state
+            AINavigationSnapshot::RouteRequest routeRequest;
+            routeRequest.from = actor->getPosition() + glm::vec3(0, AIMovementGrid::floatingHeight, 0);
+            routeRequest.to = currentPlayer->getPosition();
+            routeRequest.maximumNumberOfNodes = information.maximumRouteDistance;
+            auto lastNodeIt = actorLastNavigationNodes.find(actor->getWorldID());
+            if(lastNodeIt != actorLastNavigationNodes.end()) {
+                routeRequest.startNodeHint = lastNodeIt->second;
+            }
+
+            std::shared_ptr<const AINavigationSnapshot> snapshot = navigationSnapshot;
+            routeRequests[actor->getWorldID()] = jobSystem->submit([snapshot, routeRequest]() mutable {
+                if (!snapshot->setProperHeight(&routeRequest.to, AIMovementGrid::floatingHeight)) {
+                    return AINavigationSnapshot::RouteResult();
+                }
+                return snapshot->coursePath(routeRequest);
+            });
         }
 
-        if (routeThreads.find(actor->getWorldID()) != routeThreads.end() && routeThreads[actor->getWorldID()]->isThreadDone()) {
-            const std::vector<LimonAPI::ParameterRequest>* route = routeThreads[actor->getWorldID()]->getResult();
-            for (size_t i = 0; i < route->size(); ++i) {
-                information.routeToRequest.push_back(glm::vec3(GLMConverter::LimonToGLM(route->at(i).value.vectorValue)));
+        auto routeRequestIt = routeRequests.find(actor->getWorldID());
+        if (routeRequestIt != routeRequests.end() && routeRequestIt->second.isReady()) {
+            const AINavigationSnapshot::RouteResult& routeResult = routeRequestIt->second.get();
+            information.routeToRequest = routeResult.route;
+            if (routeResult.lastNode != AINavigationSnapshot::NO_NODE) {
+                actorLastNavigationNodes[actor->getWorldID()] = routeResult.lastNode;
             }
-            delete routeThreads[actor->getWorldID()];
-            routeThreads.erase(actor->getWorldID());
+            routeRequests.erase(routeRequestIt);
 
             if (information.routeToRequest.empty()) {
                 information.routeFound = false;
@@ -572,32 +810,6 @@ ActorInterface::ActorInformation World::fillActorInformation(ActorInterface *act
 }
 
 
-   //std::function<std::vector<LimonAPI::ParameterRequest>(std::vector<LimonAPI::ParameterRequest>)> functionToRun
-
-std::vector<LimonAPI::ParameterRequest>
-World::fillRouteInformation(std::vector<LimonAPI::ParameterRequest> parameters) const {
-    glm::vec3 fromPosition = glm::vec3(GLMConverter::LimonToGLM(parameters[0].value.vectorValue));
-    uint32_t actorID = (uint32_t)parameters[1].value.longValues[1];
-    uint32_t maximumDistance = (uint32_t)parameters[1].value.longValues[2];
-    std::vector<glm::vec3> route;
-    glm::vec3 playerPosWithGrid = currentPlayer->getPosition();
-    bool isPlayerReachable = grid->setProperHeight(&playerPosWithGrid, AIMovementGrid::floatingHeight, 0.0f,
-                                                      dynamicsWorld);
-    if (isPlayerReachable && grid->coursePath(fromPosition, playerPosWithGrid, actorID, maximumDistance, &route)) {
-        if (!route.empty()) {             
-            //Normally, this information should be used for straightening the path, but not yet.             
-            reverse(std::begin(route), std::end(route));
-            }
-       }
-    std::vector<LimonAPI::ParameterRequest> routeList;
-    for (size_t i = 0; i < route.size(); ++i) {
-        LimonAPI::ParameterRequest pr;
-        pr.value.vectorValue = GLMConverter::GLMToLimon(route[i]);
-        routeList.push_back(pr);
-    }
-    return routeList;
-}
-
    bool World::handlePlayerInput(InputHandler &inputHandler) {
     if(inputHandler.getInputEvents(inputHandler.MOUSE_BUTTON_LEFT)) {
         if(inputHandler.getInputStatus(inputHandler.MOUSE_BUTTON_LEFT)) {
@@ -652,6 +864,9 @@ World::fillRouteInformation(std::vector<LimonAPI::ParameterRequest> parameters)
 }
 
 void World::render() {
+    glHelper->flushModelTransforms();//upload transforms changed by play, before any pass uses them
+    updateLightClusters();
+
     for (unsigned int i = 0; i < activeLights.size(); ++i) {
         if(activeLights[i]->getLightType() != Light::DIRECTIONAL) {
             continue;
@@ -661,78 +876,70 @@ void World::render() {
         //FIXME why are these set here?
         shadowMapProgramDirectional->setUniform("renderLightIndex", (int)i);
 
-        for (auto modelIterator = modelsInLightFrustum[i].begin(); modelIterator != modelsInLightFrustum[i].end(); ++modelIterator) {
-            //each iterator has a vector. each vector is a model that can be rendered instanced. They share is animated
-            std::set<Model*> modelSet = modelIterator->second;
-            modelIndicesBuffer.clear();
-            Model* sampleModel = nullptr;
-            for (auto model = modelSet.begin(); model != modelSet.end(); ++model) {
-                sampleModel = *model;
-                //all of these models will be rendered
-                modelIndicesBuffer.push_back((*model)->getWorldObjectID());
-            }
-            if(sampleModel != nullptr) {
-                sampleModel->renderWithProgramInstanced(modelIndicesBuffer, *shadowMapProgramDirectional);
+        for (auto batchIterator = modelsInLightFrustum[i].getBatches().begin(); batchIterator != modelsInLightFrustum[i].getBatches().end(); ++batchIterator) {
+            //each batch contains models of same asset, they can be rendered instanced.
+            const InstancedRenderList::Batch& batch = batchIterator->second;
+            if(!batch.empty()) {
+                batch.models[0]->renderWithProgramInstanced(batch.modelIndices, *shadowMapProgramDirectional);
             }
         }
 
-        for (auto animatedModelIterator = animatedModelsInLightFrustum[i].begin(); animatedModelIterator != animatedModelsInLightFrustum[i].end(); ++animatedModelIterator) {
-            std::vector<uint32_t > temp;
-            temp.push_back((*animatedModelIterator)->getWorldObjectID());
-            (*animatedModelIterator)->renderWithProgramInstanced(temp,*shadowMapProgramDirectional);
+        for (auto batchIterator = animatedModelsInLightFrustum[i].getBatches().begin(); batchIterator != animatedModelsInLightFrustum[i].getBatches().end(); ++batchIterator) {
+            //bone palettes are found per instance, so animated models are instanced too
+            const InstancedRenderList::Batch& batch = batchIterator->second;
+            if(!batch.empty()) {
+                batch.models[0]->renderWithProgramInstanced(batch.modelIndices, *shadowMapProgramDirectional);
+            }
         }
     }
 
-    glHelper->switchRenderToShadowMapPoint();
     for (unsigned int i = 0; i < activeLights.size(); ++i) {
         if(activeLights[i]->getLightType() != Light::POINT) {
             continue;
         }
+        PointShadowCache& shadowCache = pointShadowCaches[i];
+        if(shadowCache.light != activeLights[i] || shadowCache.position != activeLights[i]->getPosition() ||
+           shadowCache.range != activeLights[i]->getActiveDistance()) {
+            shadowCache.light = activeLights[i];
+            shadowCache.position = activeLights[i]->getPosition();
+            shadowCache.range = activeLights[i]->getActiveDistance();
+            shadowCache.staticDirty = true;
+        }
+        //poses can change without moving the model, so animated models are rendered every frame
+        if(!animatedModelsInLightFrustum[i].empty()) {
+            shadowCache.dynamicDirty = true;
+        }
+        if(!shadowCache.staticDirty && !shadowCache.dynamicDirty) {
+            continue;
+        }
         //FIXME why are these set here?
         shadowMapProgramPoint->setUniform("renderLightIndex", (int)i);
-        for (auto modelIterator = modelsInLightFrustum[i].begin(); modelIterator != modelsInLightFrustum[i].end(); ++modelIterator) {
-            //each iterator has a vector. each vector is a model that can be rendered instanced. They share is animated
-            std::set<Model*> modelSet = modelIterator->second;
-            modelIndicesBuffer.clear();
-            Model* sampleModel = nullptr;
-            for (auto model = modelSet.begin(); model != modelSet.end(); ++model) {
-                //all of these models will be rendered
-                modelIndicesBuffer.push_back((*model)->getWorldObjectID());
-                sampleModel = *model;
-            }
-            if(sampleModel != nullptr) {
-                sampleModel->renderWithProgramInstanced(modelIndicesBuffer, *shadowMapProgramPoint);
-            }
-        }
-
-        for (auto animatedModelIterator = animatedModelsInLightFrustum[i].begin(); animatedModelIterator != animatedModelsInLightFrustum[i].end(); ++animatedModelIterator) {
-            std::vector<uint32_t > temp;
-            temp.push_back((*animatedModelIterator)->getWorldObjectID());
-            (*animatedModelIterator)->renderWithProgramInstanced(temp,*shadowMapProgramPoint);
+        if(shadowCache.staticDirty) {
+            glHelper->switchRenderToShadowMapPointStatic(i);
+            renderPointShadowCasters(modelsInLightFrustum[i], true);
         }
+        glHelper->switchRenderToShadowMapPoint(i);
+        renderPointShadowCasters(modelsInLightFrustum[i], false);
+        renderPointShadowCasters(animatedModelsInLightFrustum[i], false);
+        shadowCache.staticDirty = false;
+        shadowCache.dynamicDirty = false;
     }
     /**************** SSAO ********************************************************/
 
     glHelper->switchRenderToDepthPrePass();
-    for (auto modelIterator = modelsInCameraFrustum.begin(); modelIterator != modelsInCameraFrustum.end(); ++modelIterator) {
-        //each iterator has a vector. each vector is a model that can be rendered instanced. They share is animated
-        std::set<Model*> modelSet = modelIterator->second;
-        modelIndicesBuffer.clear();
-        Model* sampleModel = nullptr;
-        for (auto model = modelSet.begin(); model != modelSet.end(); ++model) {
-            //all of these models will be rendered
-            modelIndicesBuffer.push_back((*model)->getWorldObjectID());
-            sampleModel = *model;
-        }
-        if(sampleModel != nullptr) {
-            sampleModel->renderWithProgramInstanced(modelIndicesBuffer, *depthBufferProgram);
+    for (auto batchIterator = modelsInCameraFrustum.getBatches().begin(); batchIterator != modelsInCameraFrustum.getBatches().end(); ++batchIterator) {
+        //each batch contains models of same asset, they can be rendered instanced.
+        const InstancedRenderList::Batch& batch = batchIterator->second;
+        if(!batch.empty()) {
+            batch.models[0]->renderWithProgramInstanced(batch.modelIndices, *depthBufferProgram);
         }
     }
 
-    for (auto modelIterator = animatedModelsInFrustum.begin(); modelIterator != animatedModelsInFrustum.end(); ++modelIterator) {
-        std::vector<uint32_t > temp;
-        temp.push_back((*modelIterator)->getWorldObjectID());
-        (*modelIterator)->renderWithProgramInstanced(temp, *depthBufferProgram);
+    for (auto batchIterator = animatedModelsInFrustum.getBatches().begin(); batchIterator != animatedModelsInFrustum.getBatches().end(); ++batchIterator) {
+        const InstancedRenderList::Batch& batch = batchIterator->second;
+        if(!batch.empty()) {
+            batch.models[0]->renderWithProgramInstanced(batch.modelIndices, *depthBufferProgram);
+        }
     }
 
     if(!currentPlayer->isDead() && startingPlayer.attachedModel != nullptr) {//don't render attched model if dead
@@ -747,33 +954,27 @@ void World::render() {
         sky->render();//this is moved to the top, because transparency can create issues if this is at the end
     }
 
-    for (auto modelIterator = modelsInCameraFrustum.begin(); modelIterator != modelsInCameraFrustum.end(); ++modelIterator) {
-        //each iterator has a vector. each vector is a model that can be rendered instanced. They share is animated
-        std::set<Model*> modelSet = modelIterator->second;
-        modelIndicesBuffer.clear();
-        Model* sampleModel = nullptr;
-        for (auto model = modelSet.begin(); model != modelSet.end(); ++model) {
-            //all of these models will be rendered
-            modelIndicesBuffer.push_back((*model)->getWorldObjectID());
-            sampleModel = *model;
-        }
-        if(sampleModel != nullptr) {
-            sampleModel->renderInstanced(modelIndicesBuffer);
+    for (auto batchIterator = modelsInCameraFrustum.getBatches().begin(); batchIterator != modelsInCameraFrustum.getBatches().end(); ++batchIterator) {
+        //each batch contains models of same asset, they can be rendered instanced.
+        const InstancedRenderList::Batch& batch = batchIterator->second;
+        if(!batch.empty()) {
+            batch.models[0]->renderInstanced(batch.modelIndices);
         }
     }
 
-    for (auto modelIterator = animatedModelsInFrustum.begin(); modelIterator != animatedModelsInFrustum.end(); ++modelIterator) {
-        std::vector<uint32_t > temp;
-        temp.push_back((*modelIterator)->getWorldObjectID());
-        (*modelIterator)->renderInstanced(temp);
+    for (auto batchIterator = animatedModelsInFrustum.getBatches().begin(); batchIterator != animatedModelsInFrustum.getBatches().end(); ++batchIterator) {
+        const InstancedRenderList::Batch& batch = batchIterator->second;
+        if(!batch.empty()) {
+            batch.models[0]->renderInstanced(batch.modelIndices);
+        }
     }
 
     dynamicsWorld->debugDrawWorld();
     if (this->dynamicsWorld->getDebugDrawer()->getDebugMode() != btIDebugDraw::DBG_NoDebug) {
         debugDrawer->drawLine(btVector3(0, 0, 0), btVector3(0, 250, 0), btVector3(1, 1, 1));
         //draw the ai-grid
-        if(grid != nullptr) {
-            grid->debugDraw(debugDrawer);
+        if(navigationSnapshot != nullptr) {
+            navigationSnapshot->debugDraw(debugDrawer);
         }
     }
 
@@ -795,9 +996,12 @@ void World::render() {
 
             playerPlaceHolder->getTransformation()->setTranslate(physicalPlayer->getPosition());
             playerPlaceHolder->getTransformation()->setOrientation(physicalPlayer->getLookDirectionQuaternion());
-            std::vector<uint32_t > temp;
-            temp.push_back(playerPlaceHolder->getWorldObjectID());
-            playerPlaceHolder->renderInstanced(temp);
+            glHelper->flushModelTransforms();
+            if(playerPlaceHolder->getTransformHandle() != GLHelper::INVALID_HANDLE) {
+                std::vector<uint32_t > temp;
+                temp.push_back(playerPlaceHolder->getTransformHandle());
+                playerPlaceHolder->renderInstanced(temp);
+            }
         }
     }
 
@@ -834,9 +1038,20 @@ void World::render() {
     //render API gui layer
     apiGUILayer->render();
 
-    uint32_t triangle, line;
+    uint32_t triangle, line, transformUploads, transformUploadCalls, pointShadowRenders, staticPointShadowRenders;
     glHelper->getRenderTriangleAndLineCount(triangle, line);
-    renderCounts->updateText("Tris: " + std::to_string(triangle) + ", lines: " + std::to_string(line));
+    glHelper->getModelTransformUploadCount(transformUploads, transformUploadCalls);
+    glHelper->getPointShadowMapRenderCount(pointShadowRenders, staticPointShadowRenders);
+    renderCounts->updateText("Tris: " + std::to_string(triangle) + ", lines: " + std::to_string(line) +
+                             ", uploads: " + std::to_string(transformUploads) + "/" + std::to_string(transformUploadCalls) +
+                             ", palettes: " + std::to_string(glHelper->getBonePaletteUploadCount()) +
+                             ", lights: " + std::to_string(activeLights.size()) + "+" +
+                             std::to_string(glHelper->getClusteredLightCount()) +
+                             ", shadows: " + std::to_string(pointShadowRenders) + "/" +
+                             std::to_string(staticPointShadowRenders) +
+                             ", poses: " + std::to_string(animationPosesEvaluated) + "/" +
+                             std::to_string(animatedModelsInAnyFrustum.size()));
+    animationPosesEvaluated = 0;
     if(currentPlayersSettings->editorShown) {
         ImGuiFrameSetup();
     }
@@ -846,9 +1061,11 @@ void World::render() {
      if(attachment->getTypeID() == GameObject::MODEL) {
          Model* attachedModel = static_cast<Model*>(attachment);
          attachedModel->setupForTime(gameTime);
-         std::vector<uint32_t> temp;
-         temp.push_back(attachedModel->getWorldObjectID());
-         attachedModel->renderInstanced(temp);
+         if(attachedModel->getTransformHandle() != GLHelper::INVALID_HANDLE) {
+             std::vector<uint32_t> temp;
+             temp.push_back(attachedModel->getTransformHandle());
+             attachedModel->renderInstanced(temp);
+         }
          if (attachedModel->hasChildren()) {
              const std::vector<PhysicalRenderable *> &children = attachedModel->getChildren();
              for (auto iterator = children.begin(); iterator != children.end(); ++iterator) {
@@ -1283,9 +1500,10 @@ void World::ImGuiFrameSetup() {//TODO not const because it removes the object. S
             }
         }
         if(ImGui::Button("Save AI walk Grid")) {
-            if(this->grid != nullptr) {
-                std::string AIWalkName = this->name.substr(0, this->name.find_last_of(".")) + ".aiwalk";
-                this->grid->serialize(AIWalkName);
+            if(this->navigationSnapshot != nullptr) {
+                std::string AIWalkName = this->name.substr(0, this->name.find_last_of("."));
+                this->navigationSnapshot->serializeXML(AIWalkName + ".aiwalk");
+                this->navigationSnapshot->serialize(AIWalkName + ".aiwalkbin");
             }
         }
         ImGui::End();
@@ -1340,6 +1558,7 @@ void World::ImGuiFrameSetup() {//TODO not const because it removes the object. S
                     if (dynamic_cast<Model *>(pickedObject)->getAIID() != 0) {
                         removedActorID = dynamic_cast<Model *>(pickedObject)->getAIID();
                         actors.erase(dynamic_cast<Model *>(pickedObject)->getAIID());
+                        removeActorRouteState(removedActorID);
                         dynamic_cast<Model *>(pickedObject)->detachAI();
                     }
                 }
@@ -1551,12 +1770,12 @@ void World::addAnimationDefinitionToEditor() {
 
 World::~World() {
 
-    if(routeThreads.empty()) {
-        std::cout << "Waiting for AI route threads to finish. " << std::endl;
-        for (auto threadIt = routeThreads.begin(); threadIt != routeThreads.end(); ++threadIt) {
-            threadIt->second->waitUntilDone();
+    if(!routeRequests.empty()) {
+        std::cout << "Waiting for AI route jobs to finish. " << std::endl;
+        for (auto requestIt = routeRequests.begin(); requestIt != routeRequests.end(); ++requestIt) {
+            requestIt->second.get();
         }
-        std::cout << "AI route threads to finished." << std::endl;
+        std::cout << "AI route jobs finished." << std::endl;
     }
 
     delete dynamicsWorld;
@@ -1593,7 +1812,6 @@ World::~World() {
     delete broadphase;
     delete ghostPairCallback;
 
-    delete grid;
     delete camera;
     delete physicalPlayer;
     delete debugPlayer;
@@ -1622,6 +1840,7 @@ bool World::addModelToWorld(Model *xmlModel) {
     xmlModel->getRigidBody()->getAabb(aabbMin, aabbMax);
 
     updateWorldAABB(GLMConverter::BltToGLM(aabbMin), GLMConverter::BltToGLM(aabbMax));
+    cullingTree.insert(xmlModel);
     updatedModels.push_back(xmlModel);
     return true;
 
@@ -1652,15 +1871,37 @@ void World::addActor(ActorInterface *actor) {
 }
 
 void World::createGridFrom(const glm::vec3 &aiGridStartPoint) {
-    if(grid != nullptr) {
+    std::string AIWalkName = this->name.substr(0, this->name.find_last_of("."));
+    navigationSnapshot = nullptr;
+    Uint32 loadStartTime = SDL_GetTicks();
+    std::string source = "binary";
+    //binary is only a cache of the xml, if the xml is edited or regenerated after it, the xml is used
+    if(!MappedFile::isOutdated(AIWalkName + ".aiwalkbin", AIWalkName + ".aiwalk")) {
+        navigationSnapshot = AINavigationSnapshot::deserialize(AIWalkName + ".aiwalkbin");
+    }
+    if(navigationSnapshot == nullptr) {
+        //binary is missing or outdated, use the xml or generate
+        loadStartTime = SDL_GetTicks();
+        AIMovementGrid *grid = AIMovementGrid::deserialize(AIWalkName + ".aiwalk");
+        if(grid != nullptr) {
+            source = "xml";
+            navigationSnapshot = grid->createNavigationSnapshot();
+            navigationSnapshot->serialize(AIWalkName + ".aiwalkbin");
+        } else {
+            source = "generation";
+            grid = new AIMovementGrid(aiGridStartPoint, dynamicsWorld, worldAABBMin, worldAABBMax, COLLIDE_PLAYER,
+                                      COLLIDE_MODELS | COLLIDE_TRIGGER_VOLUME | COLLIDE_EVERYTHING, jobSystem);
+            navigationSnapshot = grid->createNavigationSnapshot();
+        }
         delete grid;
     }
-    std::string AIWalkName = this->name.substr(0, this->name.find_last_of(".")) + ".aiwalk";
-    grid = AIMovementGrid::deserialize(AIWalkName);
-    if(grid == nullptr) {
-        grid = new AIMovementGrid(aiGridStartPoint, dynamicsWorld, worldAABBMin, worldAABBMax, COLLIDE_PLAYER,
-                                  COLLIDE_MODELS | COLLIDE_TRIGGER_VOLUME | COLLIDE_EVERYTHING);
-    }
+    options->getLogger()->log(Logger::log_Subsystem_AI, Logger::log_level_INFO,
+                              "AI navigation loaded from " + source + " with " + std::to_string(navigationSnapshot->getNodeCount()) +
+                              " nodes in " + std::to_string(SDL_GetTicks() - loadStartTime) + " ms, hierarchy has " +
+                              std::to_string(navigationSnapshot->getClusterCount()) + " clusters and " +
+                              std::to_string(navigationSnapshot->getEntranceCount()) + " entrances, built in " +
+                              std::to_string(navigationSnapshot->getHierarchyBuildTime()) + " ms.");
+    actorLastNavigationNodes.clear();//hints are node indexes of the old snapshot
 }
 
 void World::setSky(SkyBox *skyBox) {
@@ -2059,6 +2300,7 @@ bool World::removeObject(uint32_t objectID) {
     if (modelToRemove!= nullptr && modelToRemove->getAIID() != 0) {
         unusedIDs.push(modelToRemove->getAIID());
         actors.erase(modelToRemove->getAIID());
+        removeActorRouteState(modelToRemove->getAIID());
     }
     //remove any active animations
     if(activeAnimations.find(modelToRemove) != activeAnimations.end()) {
@@ -2067,6 +2309,8 @@ bool World::removeObject(uint32_t objectID) {
     }
     onLoadAnimations.erase(modelToRemove);
 
+    //shadows it was casting should be removed from cached shadow maps
+    markPointShadowsDirty(modelToRemove);
     //we need to remove from ligth frustum lists, and camera frustum lists
     if(modelToRemove->isAnimated()) {
         animatedModelsInFrustum.erase(modelToRemove);
@@ -2076,13 +2320,14 @@ bool World::removeObject(uint32_t objectID) {
 
         animatedModelsInAnyFrustum.erase(modelToRemove);
     } else {
-        modelsInCameraFrustum[modelToRemove->getAssetID()].erase(modelToRemove);
+        modelsInCameraFrustum.erase(modelToRemove);
         for (size_t i = 0; i < activeLights.size(); ++i) {
-            modelsInLightFrustum[i][modelToRemove->getAssetID()].erase(modelToRemove);
+            modelsInLightFrustum[i].erase(modelToRemove);
         }
     }
 
 
+    cullingTree.remove(modelToRemove);
     //delete object itself
     delete modelToRemove;
     objects.erase(objectID);
@@ -2093,6 +2338,13 @@ bool World::removeObject(uint32_t objectID) {
 
 }
 
+void World::removeActorRouteState(uint32_t actorID) {
+    //a running job keeps its own copy of the snapshot and the request, so its future can be dropped
+    routeRequests.erase(actorID);
+    //IDs are reused, a new actor shouldn't start from the node of the removed one
+    actorLastNavigationNodes.erase(actorID);
+}
+
 void World::afterLoadFinished() {
     for (size_t i = 0; i < onLoadActions.size(); ++i) {
         if(onLoadActions[i]->enabled) {
@@ -3181,6 +3433,10 @@ void World::updateActiveLights(bool forceUpdate) {
     }
 
     lastLightUpdatePlayerPosition = currentPlayer->getPosition();
+    Light* previousActiveLights[NR_TOTAL_LIGHTS] = {nullptr};
+    for (size_t lightIndex = 0; lightIndex < activeLights.size(); ++lightIndex) {
+        previousActiveLights[lightIndex] = activeLights[lightIndex];
+    }
     activeLights.clear();
 
     // we have NR_POINT lights, and directional lights. we should have 1 directional light, and rest point lights.
@@ -3213,6 +3469,39 @@ void World::updateActiveLights(bool forceUpdate) {
         }
     }
 
+    //lights that stay active keep their index, so their cached shadow maps are reused
+    Light* orderedLights[NR_TOTAL_LIGHTS] = {nullptr};
+    size_t notPlacedCount = 0;
+    for (size_t lightIndex = 0; lightIndex < activeLights.size(); ++lightIndex) {
+        bool isPlaced = false;
+        for (size_t previousIndex = 0; previousIndex < activeLights.size(); ++previousIndex) {
+            if(previousActiveLights[previousIndex] == activeLights[lightIndex]) {
+                orderedLights[previousIndex] = activeLights[lightIndex];
+                isPlaced = true;
+                break;
+            }
+        }
+        if(!isPlaced) {
+            activeLights[notPlacedCount++] = activeLights[lightIndex];//never ahead of lightIndex, so nothing unread is overwritten
+        }
+    }
+    size_t notPlacedIndex = 0;
+    for (size_t lightIndex = 0; lightIndex < activeLights.size(); ++lightIndex) {
+        if(orderedLights[lightIndex] == nullptr) {
+            orderedLights[lightIndex] = activeLights[notPlacedIndex++];
+        }
+    }
+    for (size_t lightIndex = 0; lightIndex < activeLights.size(); ++lightIndex) {
+        activeLights[lightIndex] = orderedLights[lightIndex];
+    }
+    //casters of inactive lights are not tracked, so a light that leaves its index can't reuse the cache when it returns
+    for (size_t lightIndex = 0; lightIndex < NR_TOTAL_LIGHTS; ++lightIndex) {
+        if(previousActiveLights[lightIndex] != nullptr &&
+           (lightIndex >= activeLights.size() || activeLights[lightIndex] != previousActiveLights[lightIndex])) {
+            pointShadowCaches[lightIndex].light = nullptr;
+        }
+    }
+
     //at this point, add the directional light to the end
     if(directionalLightIndex != -1) {
         activeLights.push_back(lights[directionalLightIndex]);
@@ -3229,10 +3518,27 @@ void World::updateActiveLights(bool forceUpdate) {
 
 }
 
+void World::updateLightClusters() {
+    //point lights with shadows are in active lights, all other point lights are lit through clusters
+    lightClusters.clear();
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const Light* light = lights[i];
+        if(light->getLightType() != Light::POINT ||
+           std::find(activeLights.begin(), activeLights.end(), light) != activeLights.end()) {
+            continue;
+        }
+        lightClusters.addLight(light->getPosition(), light->getActiveDistance(), light->getColor(),
+                               light->getAttenuation(), light->getAmbientColor());
+    }
+    lightClusters.build(glHelper->getCameraMatrix(), glHelper->getProjectionMatrix());
+    glHelper->setLightClusters(lightClusters);
+}
+
    void World::clearWorldRefsBeforeAttachment(PhysicalRenderable *attachment) {
        GameObject* gameObject = dynamic_cast<GameObject*>(attachment);
        if(gameObject != nullptr) {
            objects.erase(gameObject->getWorldObjectID());
+           cullingTree.remove(attachment);
            dynamicsWorld->removeRigidBody(attachment->getRigidBody());
            for (auto iterator = rigidBodies.begin(); iterator != rigidBodies.end(); ++iterator) {
                if ((*iterator) == attachment->getRigidBody()) {
@@ -19,6 +19,15 @@
 #include "ALHelper.h"
 #include "GameObjects/Players/Player.h"
 #include "SDL2Helper.h"
+#include "InstancedRenderList.h"
+#include "CullingTree.h"
+#include "VisibilityBatch.h"
+#include "LightClusters.h"
+#include "JobSystem.h"
+#include "AI/AINavigationSnapshot.h"
+
+#define MINIMUM_MODELS_PER_ANIMATION_JOB 4
+#define MINIMUM_OBJECTS_PER_CULLING_JOB 256
 
 
 class btGhostPairCallback;
@@ -164,8 +173,8 @@ private:
     friend class WorldLoader;
     friend class WorldSaver; //Those classes require direct access to some of the internal data
 
-    std::vector<uint32_t > modelIndicesBuffer;
     AssetManager* assetManager;
+    JobSystem* jobSystem;
     Options* options;
     uint32_t nextWorldID = 2;
     std::queue<uint32_t> unusedIDs;
@@ -179,14 +188,54 @@ private:
      * The variables below are redundant, but they allow instanced rendering, and saving frustum occlusion results.
      */
     std::vector<Model*> updatedModels;
-    std::vector<std::map<uint32_t , std::set<Model*>>> modelsInLightFrustum;
-    std::vector<std::set<Model*>> animatedModelsInLightFrustum; //since animated models can't be instanced, they don't need to be in a map etc.
+    CullingTree cullingTree;
+    /**
+     * Objects tested against the same frusta. Volume bits are camera first if tested, then lights in lightIndexes order.
+     */
+    struct CullingPass {
+        std::vector<PhysicalRenderable*> objects;
+        bool isCameraTested;
+        std::vector<uint32_t> lightIndexes;
+        bool removePossible;//false if the frusta are culled from scratch
+    };
+    /**
+     * Part of a pass, run by a single thread. Only the job writes to its batch.
+     */
+    struct CullingJob {
+        size_t passIndex;
+        size_t begin, end;
+        VisibilityBatch batch;
+    };
+    //reused by fillVisibleObjects each frame
+    std::vector<CullingPass> cullingPasses;
+    std::vector<CullingJob> cullingJobs;
+    std::vector<InstancedRenderList> modelsInLightFrustum;
+    std::vector<InstancedRenderList> animatedModelsInLightFrustum;
+    /**
+     * What the cached point shadow map of an active light index was rendered for. Static casters are rendered again
+     * only if the light changes or a static caster in range moves, dynamic casters if any of them moves in, out or
+     * within the range.
+     */
+    struct PointShadowCache {
+        const Light* light = nullptr;
+        glm::vec3 position;
+        float range = 0;
+        bool staticDirty = true;
+        bool dynamicDirty = true;
+    };
+    std::vector<PointShadowCache> pointShadowCaches;
+    std::vector<uint32_t> shadowCasterIndices;//reused by renderPointShadowCasters
 
-    std::map<uint32_t , std::set<Model*>> modelsInCameraFrustum;
-    std::set<Model*> animatedModelsInFrustum; //since animated models can't be instanced, they don't need to be in a map etc.
+    InstancedRenderList modelsInCameraFrustum;
+    InstancedRenderList animatedModelsInFrustum;
     std::set<Model*> animatedModelsInAnyFrustum;
 
     /************************* End of redundant variables ******************************************/
+    //reused by setupAnimatedModelsForTime each frame
+    std::vector<Model*> animationStageModels;
+    std::vector<uint8_t> animationStagePoseUpdates;
+    uint32_t animationTick = 0;
+    uint32_t animationPosesEvaluated = 0;//since last render, for stats
     std::priority_queue<TimedEvent, std::vector<TimedEvent>, std::greater<TimedEvent>> timedEvents;
 
 
@@ -201,10 +250,12 @@ private:
     std::vector<Light *> lights;
     int32_t directionalLightIndex = -1;
     glm::vec3 lastLightUpdatePlayerPosition = glm::vec3(0,0,0);
+    LightClusters lightClusters;//reused by updateLightClusters each frame
     std::vector<Light *> activeLights; //this contains redundant pointers at most MAX_LIGHT elements, from lights array.
     std::vector<GUILayer *> guiLayers;
     std::unordered_map<uint32_t, ActorInterface*> actors;
-    AIMovementGrid *grid = nullptr;
+    std::shared_ptr<const AINavigationSnapshot> navigationSnapshot;//route jobs hold their own reference, it can be replaced while they run
+    std::map<uint32_t, uint32_t> actorLastNavigationNodes;//actorID -> last node returned for the actor, only used from main thread
     SkyBox *sky = nullptr;
     GLHelper *glHelper;
     ALHelper *alHelper;
@@ -261,7 +312,7 @@ private:
     CombinePostProcess* combiningObject;
     SSAOPostProcess* ssaoPostProcess;
     SSAOBlurPostProcess* ssaoBlurPostProcess;
-    std::map<uint32_t, SDL2Helper::Thread*> routeThreads;
+    std::map<uint32_t, JobSystem::Future<AINavigationSnapshot::RouteResult>> routeRequests;//actorID -> route job
 
     bool guiPickMode = false;
     enum class QuitResponse
@@ -294,6 +345,17 @@ private:
 
     void fillVisibleObjects();
 
+    /**
+     * Evaluates poses of animated models in any frustum on worker threads, then applies them to physics on the calling
+     * thread, in the same order serial setupForTime calls would.
+     */
+    void setupAnimatedModelsForTime(long gameTime);
+
+    /**
+     * Selects the animation level of detail of model by its distance to camera, using thresholds from options.
+     */
+    void setAnimationLOD(Model *model, const glm::vec3 &cameraPosition) const;
+
     GameObject *getPointedObject(int collisionType, int filterMask,
                                  glm::vec3 *collisionPosition = nullptr, glm::vec3 *collisionNormal = nullptr) const;
 
@@ -306,7 +368,7 @@ private:
     void addLight(Light *light);
 
     World(const std::string &name, PlayerInfo startingPlayerType, InputHandler *inputHandler,
-              AssetManager *assetManager, Options *options);
+              AssetManager *assetManager, JobSystem *jobSystem, Options *options);
 
     void afterLoadFinished();
 
@@ -314,9 +376,25 @@ private:
 
     void ImGuiFrameSetup();
 
-    void setVisibilityAndPutToSets(PhysicalRenderable *PhysicalRenderable, bool removePossible);
+    void setVisibilityAndPutToSets(PhysicalRenderable *PhysicalRenderable, bool isVisible, bool removePossible);
+
+    void setLightVisibilityAndPutToSets(size_t currentLightIndex, PhysicalRenderable *PhysicalRenderable, bool isVisible, bool removePossible);
+
+    void queryCullingCandidates(CullingPass &pass) const;
+
+    void runCullingJob(CullingJob &job) const;
 
-    void setLightVisibilityAndPutToSets(size_t currentLightIndex, PhysicalRenderable *PhysicalRenderable, bool removePossible);
+    /**
+     * Static casters are kept in cached point shadow maps, anything else is rendered every time the map is rendered.
+     */
+    static bool isStaticShadowCaster(const Model *model);
+
+    /**
+     * Marks point shadow maps the model was or is in range of, so they are rendered again.
+     */
+    void markPointShadowsDirty(Model *model);
+
+    void renderPointShadowCasters(const InstancedRenderList &renderList, bool isStatic);
 
     bool handleQuitRequest();
 
@@ -332,9 +410,6 @@ private:
     Model* findModelByID(uint32_t modelID) const;
     Model* findModelByIDChildren(PhysicalRenderable* parent ,uint32_t modelID) const;
 
-    std::vector<LimonAPI::ParameterRequest>
-    fillRouteInformation(std::vector<LimonAPI::ParameterRequest> parameters) const;
-
     void renderPlayerAttachments(GameObject *attachment) const;
     void clearWorldRefsBeforeAttachment(PhysicalRenderable *attachment);
 
@@ -462,6 +537,13 @@ public:
                                        std::vector<uint32_t> parentage);
 
     void updateActiveLights(bool forceUpdate = false);
+
+    /**
+     * Drops the pending route request and the last node hint of the actor.
+     */
+    void removeActorRouteState(uint32_t actorID);
+
+    void updateLightClusters();
 };
 
 #endif //LIMONENGINE_WORLD_H
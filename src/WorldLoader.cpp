@@ -26,12 +26,13 @@
 #include "GameObjects/GUIAnimation.h"
 #include "GameObjects/ModelGroup.h"
 
-WorldLoader::WorldLoader(AssetManager *assetManager, InputHandler *inputHandler, Options *options) :
+WorldLoader::WorldLoader(AssetManager *assetManager, InputHandler *inputHandler, JobSystem *jobSystem, Options *options) :
         options(options),
         glHelper(assetManager->getGlHelper()),
         alHelper(assetManager->getAlHelper()),
         assetManager(assetManager),
-        inputHandler(inputHandler)
+        inputHandler(inputHandler),
+        jobSystem(jobSystem)
 {}
 
 World * WorldLoader::loadWorld(const std::string &worldFile, LimonAPI *limonAPI) const {
@@ -172,7 +173,7 @@ World * WorldLoader::loadMapFromXML(const std::string &worldFileName, LimonAPI *
         }
     }
 
-    World* world = new World(std::string(worldName->GetText()), startingPlayer, inputHandler, assetManager, options);
+    World* world = new World(std::string(worldName->GetText()), startingPlayer, inputHandler, assetManager, jobSystem, options);
 
     attachedAPIMethodsToWorld(world, limonAPI);
 
@@ -23,6 +23,7 @@ class GLHelper;
 class ALHelper;
 class InputHandler;
 class Model;
+class JobSystem;
 
 class WorldLoader {
 public:
@@ -40,6 +41,7 @@ private:
     ALHelper *alHelper;
     AssetManager *assetManager;
     InputHandler* inputHandler;
+    JobSystem* jobSystem;
 
     World *loadMapFromXML(const std::string &worldFileName, LimonAPI *limonAPI) const;
     bool loadObjectGroupsFromXML(tinyxml2::XMLNode *worldNode, World *world, LimonAPI *limonAPI,
@@ -58,7 +60,7 @@ private:
     void attachedAPIMethodsToWorld(World *world, LimonAPI *limonAPI) const;
 
 public:
-    WorldLoader(AssetManager *assetManager, InputHandler *inputHandler, Options *options);
+    WorldLoader(AssetManager *assetManager, InputHandler *inputHandler, JobSystem *jobSystem, Options *options);
     World *loadWorld(const std::string &worldFile, LimonAPI *limonAPI) const;
 
     static std::vector<std::unique_ptr<ObjectInformation>> loadObject(AssetManager *assetManager, tinyxml2::XMLElement *objectNode,
@@ -9,6 +9,7 @@
 #include "WorldLoader.h"
 #include "ALHelper.h"
 #include "GameObjects/GUIImage.h"
+#include "JobSystem.h"
 
 const std::string PROGRAM_NAME = "LimonEngine";
 
@@ -105,7 +106,10 @@ GameEngine::GameEngine() {
     inputHandler = new InputHandler(sdlHelper->getWindow(), options);
     assetManager = new AssetManager(glHelper, alHelper);
 
-    worldLoader = new WorldLoader(assetManager, inputHandler, options);
+    //main thread is busy with the game loop, so workers use the remaining cores
+    jobSystem = new JobSystem(SDL2Helper::getLogicalCPUCount() - 1);
+
+    worldLoader = new WorldLoader(assetManager, inputHandler, jobSystem, options);
 
     std::function<bool(const std::string &)> limonLoadWorld =
             bind(&GameEngine::loadAndChangeWorld, this, std::placeholders::_1);
@@ -154,6 +158,7 @@ GameEngine::~GameEngine() {
 
     delete worldLoader;
     delete limonAPI;
+    delete jobSystem;
 
     delete inputHandler;
 
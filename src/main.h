@@ -20,6 +20,7 @@ class AssetManager;
 class SDL2Helper;
 class LimonAPI;
 class GUIImage;
+class JobSystem;
 
 class GameEngine {
     WorldLoader* worldLoader = nullptr;
@@ -33,6 +34,7 @@ class GameEngine {
     AssetManager* assetManager = nullptr;
     SDL2Helper* sdlHelper = nullptr;
     LimonAPI* limonAPI = nullptr;
+    JobSystem* jobSystem = nullptr;
 
     std::unordered_map<std::string, World*> loadedWorlds;
     std::vector<World*> returnWorldStack;//stack doesn't have clear, so I am using vector
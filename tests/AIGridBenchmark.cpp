@@ -0,0 +1,84 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <memory>
+#include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include "AI/AIMovementGrid.h"
+#include "JobSystem.h"
+#include "SDL2Helper.h"
+
+/**
+ * Generates the AI walk grid of a 340x340 heightfield of rolling hills, about 115k nodes, and reports nodes per second.
+ * Grid is generated once without a job system and once with a worker for each logical CPU.
+ *
+ * Generated grid is saved as AIGridBenchmark.aiwalk and AIGridBenchmark.aiwalkbin in the working directory, for the
+ * navigation benchmarks.
+ */
+
+static const int HEIGHTFIELD_SIZE = 340;
+static const uint32_t COLLIDE_STATIC = 1 << 1;
+static const uint32_t COLLIDE_WALKER = 1 << 2;
+
+static std::shared_ptr<const AINavigationSnapshot> generateGrid(const btDiscreteDynamicsWorld *world, JobSystem *jobSystem,
+                                                                const std::string &name) {
+    glm::vec3 worldMin(-HEIGHTFIELD_SIZE / 2.0f, -10, -HEIGHTFIELD_SIZE / 2.0f);
+    glm::vec3 worldMax(HEIGHTFIELD_SIZE / 2.0f, 20, HEIGHTFIELD_SIZE / 2.0f);
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    AIMovementGrid grid(glm::vec3(0.25f, 8, 0.25f), world, worldMin, worldMax, COLLIDE_WALKER, COLLIDE_STATIC, jobSystem);
+    std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+    std::shared_ptr<const AINavigationSnapshot> snapshot = grid.createNavigationSnapshot();
+    size_t nodeCount = snapshot->getNodeCount();
+    std::cout << name << ": " << nodeCount << " nodes in " << elapsedTime.count() * 1000.0 << " ms, "
+              << nodeCount / elapsedTime.count() << " nodes per second" << std::endl;
+    return snapshot;
+}
+
+int main() {
+    std::vector<float> heights(HEIGHTFIELD_SIZE * HEIGHTFIELD_SIZE);
+    for (int z = 0; z < HEIGHTFIELD_SIZE; ++z) {
+        for (int x = 0; x < HEIGHTFIELD_SIZE; ++x) {
+            heights[z * HEIGHTFIELD_SIZE + x] = 2.0f * std::sin(x * 0.05f) * std::cos(z * 0.07f);
+        }
+    }
+    //bullet centers the heightfield on its aabb, heights are between -2 and 2 so it stays at origin
+    btHeightfieldTerrainShape *shape = new btHeightfieldTerrainShape(HEIGHTFIELD_SIZE, HEIGHTFIELD_SIZE, heights.data(),
+                                                                     1.0f, -2.0f, 2.0f, 1, PHY_FLOAT, false);
+    btDefaultMotionState *motionState = new btDefaultMotionState(btTransform::getIdentity());
+    btRigidBody *body = new btRigidBody(btRigidBody::btRigidBodyConstructionInfo(0, motionState, shape));
+
+    btDbvtBroadphase broadphase;
+    btGhostPairCallback ghostPairCallback;
+    broadphase.getOverlappingPairCache()->setInternalGhostPairCallback(&ghostPairCallback);
+    btDefaultCollisionConfiguration collisionConfiguration;
+    btCollisionDispatcher dispatcher(&collisionConfiguration);
+    btSequentialImpulseConstraintSolver solver;
+    btDiscreteDynamicsWorld *world = new btDiscreteDynamicsWorld(&dispatcher, &broadphase, &solver, &collisionConfiguration);
+    world->addRigidBody(body, COLLIDE_STATIC, COLLIDE_STATIC | COLLIDE_WALKER);
+
+    std::shared_ptr<const AINavigationSnapshot> snapshot = generateGrid(world, nullptr, "Single thread");
+    {
+        JobSystem jobSystem(SDL2Helper::getLogicalCPUCount());
+        generateGrid(world, &jobSystem, "Job system with " + std::to_string(jobSystem.getWorkerCount()) + " workers");
+    }
+
+    bool isSaved = snapshot->serializeXML("AIGridBenchmark.aiwalk") && snapshot->serialize("AIGridBenchmark.aiwalkbin");
+
+    world->removeRigidBody(body);
+    delete world;
+    delete body;
+    delete motionState;
+    delete shape;
+    if (!isSaved) {
+        std::cerr << "Generated grid can't be saved to working directory." << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,487 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <glm/ext.hpp>
+#include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include "AI/AIMovementGrid.h"
+#include "JobSystem.h"
+
+/**
+ * Generates the AI walk grid of a small static world with walls, a raised platform and a ramp, three times:
+ * with the generator AIMovementGrid had before the visited node hash and AIGridCollisionQuery, with the current one
+ * without a job system, and with the current one on a job system. All three must give the same graph.
+ *
+ * Old generator is copied verbatim from the baseline commit as BaselineGrid, only moved into a class of its own and
+ * without its commented out debug prints. It removes done nodes with vector::erase while the current one swaps the
+ * last visited node in, so node indexes of the snapshots differ. Grids are compared by serializing them, and matching
+ * nodes by position: every node must have the same movability and neighbours at the same positions.
+ */
+
+static const uint32_t COLLIDE_STATIC = 1 << 1;
+static const uint32_t COLLIDE_WALKER = 1 << 2;
+
+class BaselineGrid {
+    bool inline isPositionCloseEnoughYOnly(const glm::vec3 &position1, const glm::vec3 &position2) const {
+        return ((fabs(position1.x - position2.x) < X_Z_DISTANCE) &&
+                (fabs(position1.z - position2.z) < X_Z_DISTANCE) &&
+                (((position1.y - position2.y) * (position1.y - position2.y)) <= Y_DISTANCE_SQ));
+    }
+
+    AIMovementNode *root = nullptr;
+    btCollisionShape *ghostShape = nullptr;
+    btPairCachingGhostObject *sharedGhostObject = new btPairCachingGhostObject();
+    btCollisionWorld::ClosestRayResultCallback *rayCallback = new btCollisionWorld::ClosestRayResultCallback(
+            btVector3(0, 0, 0), btVector3(0, 0, 0));
+    btManifoldArray sharedManifoldArray;
+    uint32_t nextPossibleIndex = 1;//this is to be used internal and constructor only. Not thread safe
+
+    int isThereCollisionCounter = 0;//this is only meaningful for debug
+    float capsuleHeight = 1.30f + 0.1f;
+    float capsuleRadius = 0.35f;//FIXME these should be configurable
+
+    glm::vec3 max,min;
+    std::vector<AIMovementNode *> visited;
+    std::vector<AIMovementNode *> doneNodes;
+
+    uint32_t getNextID() {
+        return nextPossibleIndex++;
+    }
+
+    static constexpr float floatingHeight = 2.0f;
+
+    //FIXME: this must be the worst way to check for a node in a graph, when you already implemented a*
+    AIMovementNode *isAlreadyVisited(const glm::vec3 &position, size_t &indexOf) {
+        if(visited.empty()) {
+            return nullptr;
+        }
+        for (size_t i = visited.size() - 1; i > 0; --i) {
+            if (isPositionCloseEnoughYOnly(position, visited[i]->getPosition())) {
+                indexOf = i;
+                return visited[i];
+            }
+        }
+        //because size_t wraps around, i>=0 is always true. Instead, = 0 case is below
+        if (isPositionCloseEnoughYOnly(position, visited[0]->getPosition())) {
+            indexOf = 0;
+            return visited[0];
+        }
+        return nullptr;
+    }
+
+    bool setProperHeight(glm::vec3 *position, float floatingHeight, float checkHeight,
+                         btDiscreteDynamicsWorld *staticWorld) {
+        rayCallback->m_rayFromWorld = GLMConverter::GLMToBlt(*position);
+        if (checkHeight == 0.0) {
+            rayCallback->m_rayToWorld = GLMConverter::GLMToBlt(
+                    *position - glm::vec3(0, 9999999, 0));//Normally, we expect world aabb min y here, but it is not passed.
+        } else {
+            rayCallback->m_rayToWorld = GLMConverter::GLMToBlt(*position - glm::vec3(0, checkHeight, 0));
+        }
+        rayCallback->m_closestHitFraction = 1;
+        rayCallback->m_collisionObject = nullptr;
+        staticWorld->rayTest(rayCallback->m_rayFromWorld, rayCallback->m_rayToWorld, *rayCallback);
+        if (rayCallback->hasHit()) {
+            if(rayCallback->m_hitPointWorld.getY() > (*position - glm::vec3(0, 1, 0)).y) {
+                return false;
+            }
+            position->y = rayCallback->m_hitPointWorld.getY() + floatingHeight;
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    AIMovementNode *
+    walkMonster(glm::vec3 walkPoint, btDiscreteDynamicsWorld *staticWorld, const glm::vec3 &min,
+                const glm::vec3 &max, uint32_t collisionGroup, uint32_t collisionMask) {
+        std::queue<AIMovementNode *> frontier;
+        if (!setProperHeight(&walkPoint, floatingHeight, -1 * min.y, staticWorld)) {
+            std::cerr << "Root node has nothing underneath, grid generation failed. " << std::endl;
+            return root;
+        }
+
+        AIMovementNode *root = new AIMovementNode(getNextID(), walkPoint);
+        staticWorld->addCollisionObject(sharedGhostObject, collisionGroup, collisionMask);
+        sharedGhostObject->setWorldTransform(
+                btTransform(btQuaternion::getIdentity(), GLMConverter::GLMToBlt(root->getPosition())));
+        btVector3 minO, maxO;
+        sharedGhostObject->getCollisionShape()->getAabb(sharedGhostObject->getWorldTransform(), minO, maxO);
+        bool isMovable = !isThereCollision(staticWorld);
+        staticWorld->removeCollisionObject(sharedGhostObject);
+        if (isMovable) {
+            root->setIsMovable(isMovable);
+            frontier.push(root);
+            visited.push_back(root);
+
+            std::cerr << "Root node " << GLMUtils::vectorToString(walkPoint) << "is movable, AI walk grid generation starts." << std::endl;
+        } else {
+            std::cerr << "Root node " << GLMUtils::vectorToString(walkPoint) << "is not movable, AI walk grid generation failed. Please check map." << std::endl;
+            return root;
+        }
+        size_t indexOfFoundNode;
+        AIMovementNode *current;
+        while (!frontier.empty()) {
+            current = frontier.front();
+            frontier.pop();
+
+            if(doneNodes.size() %10000 == 0) {
+                std::cout << "After "<< SDL_GetTicks() << " current done " << doneNodes.size() << " nodes, partial " << visited.size() << " last node: " << glm::to_string(current->getPosition()) << std::endl;
+            }
+
+            for (int i = -1; i <= 1; ++i) {
+                for (int j = -1; j <= 1; ++j) {
+                    if (i == 0 && j == 0) {
+                        continue; //skip the center, it is the self
+                    } else {
+                        int neighbourIndex = (i + 1) * 3 + (j + 1);
+                        if(current->getNeighbour(neighbourIndex) != nullptr) {
+                            continue;//already set
+                        }
+                        isMovable = true;
+                        glm::vec3 neighbourPosition = current->getPosition() + glm::vec3(i, 0, j);
+                        if (!setProperHeight(&neighbourPosition, floatingHeight, floatingHeight + 1.0f, staticWorld)) {
+                            isMovable = false;
+                        }
+
+                        if (neighbourPosition.x < min.x || neighbourPosition.y < min.y || neighbourPosition.z < min.z ||
+                            neighbourPosition.x > max.x || neighbourPosition.y > max.y || neighbourPosition.z > max.z) {
+                            //this means this position is out of whole world AABB, skip
+                            continue;
+                        }
+
+                        AIMovementNode *visitedNode = isAlreadyVisited(neighbourPosition, indexOfFoundNode);
+                        if (visitedNode != nullptr) {
+                            current->setNeighbour(neighbourIndex, visitedNode);
+                        } else {
+                            staticWorld->addCollisionObject(sharedGhostObject, collisionGroup, collisionMask);
+                            sharedGhostObject->setWorldTransform(
+                                    btTransform(btQuaternion::getIdentity(), GLMConverter::GLMToBlt(neighbourPosition)));
+                            isMovable = isMovable && !isThereCollision(staticWorld);
+                            staticWorld->removeCollisionObject(sharedGhostObject);
+
+
+                            AIMovementNode *neighbour = new AIMovementNode(getNextID(), neighbourPosition);
+                            neighbour->setIsMovable(isMovable);
+                            current->setNeighbour(neighbourIndex, neighbour);
+                            visited.push_back(neighbour);
+                            if(isMovable) {
+                                frontier.push(neighbour);
+                            }
+                        }
+                    }
+                }
+            }
+            if(isAlreadyVisited(current->getPosition(), indexOfFoundNode)) {
+                visited.erase(visited.begin() + indexOfFoundNode);
+            }
+
+            doneNodes.push_back(current);
+            if(current->getPosition().x > this->max.x) { this->max.x = current->getPosition().x;}
+            if(current->getPosition().y > this->max.y) { this->max.y = current->getPosition().y;}
+            if(current->getPosition().z > this->max.z) { this->max.z = current->getPosition().z;}
+
+            if(current->getPosition().x < this->min.x) { this->min.x = current->getPosition().x;}
+            if(current->getPosition().y < this->min.y) { this->min.y = current->getPosition().y;}
+            if(current->getPosition().z < this->min.z) { this->min.z = current->getPosition().z;}
+
+        }
+
+        std::cout << "Walk grid creation finished with " << doneNodes.size() << " nodes between " << glm::to_string(this->min) << ", " << glm::to_string(this->max) << std::endl;
+        return root;
+    }
+
+    bool isThereCollision(btDiscreteDynamicsWorld *staticWorld) {
+        isThereCollisionCounter++;
+        staticWorld->updateAabbs();//this should not be needed, but it is. I have no idea why
+        staticWorld->getDispatcher()->dispatchAllCollisionPairs(sharedGhostObject->getOverlappingPairCache(),
+                                                                staticWorld->getDispatchInfo(),
+                                                                staticWorld->getDispatcher());
+        btBroadphasePairArray &pairArray = sharedGhostObject->getOverlappingPairCache()->getOverlappingPairArray();
+        int numPairs = pairArray.size();
+
+        for (int i = 0; i < numPairs; ++i) {
+            const btBroadphasePair &pair = pairArray[i];
+
+            if (pair.m_algorithm) {
+                pair.m_algorithm->getAllContactManifolds(sharedManifoldArray);
+            }
+
+            for (int j = 0; j < sharedManifoldArray.size(); j++) {
+                btPersistentManifold *manifold = sharedManifoldArray[j];
+                for (int p = 0; p < manifold->getNumContacts(); ++p) {
+                    const btManifoldPoint &pt = manifold->getContactPoint(p);
+
+                    if (pt.getDistance() < 0.f) {
+                        // There is a collision
+                        return true;
+                    }
+                }
+            }
+            sharedManifoldArray.resize(0);
+
+        }
+        return false;
+    }
+
+public:
+    BaselineGrid(glm::vec3 startPoint, btDiscreteDynamicsWorld *staticOnlyPhysicsWorld, glm::vec3 min,
+                 glm::vec3 max, uint32_t collisionGroup, uint32_t collisionMask) {
+        //sharedGhostObject->setCollisionShape(new btBoxShape(btVector3(1.0f,1.0f,1.0f)));
+        //sharedGhostObject->setCollisionShape(new btCapsuleShape(1,1));
+        ghostShape = new btCapsuleShape(capsuleRadius, capsuleHeight);
+
+        sharedGhostObject->setCollisionShape(ghostShape);
+        sharedGhostObject->setCollisionFlags(
+                sharedGhostObject->getCollisionFlags());
+        sharedGhostObject->setWorldTransform(btTransform(btQuaternion::getIdentity(), GLMConverter::GLMToBlt(startPoint)));
+        std::cout << "Start generating AI walk grid" << std::endl;
+        doneNodes.push_back(new AIMovementNode(0, glm::vec3(0,100,0)));//0 index element should be empty
+        root = walkMonster(startPoint, staticOnlyPhysicsWorld, min, max, collisionGroup, collisionMask);
+        std::cout << "Finished generating AI walk grid, created " << visited.size() << " nodes, checked for collision "
+                  << isThereCollisionCounter << " times." << std::endl;
+        staticOnlyPhysicsWorld->removeCollisionObject(sharedGhostObject);
+    }
+
+    ~BaselineGrid() {
+        delete rayCallback;
+        delete sharedGhostObject;
+        delete ghostShape;
+        for (unsigned int i = 0; i < visited.size(); ++i) {
+            delete visited[i];
+        }
+
+        for (unsigned int i = 0; i < doneNodes.size(); ++i) {
+            delete doneNodes[i];
+        }
+
+    }
+
+    /**
+     * Not part of the old generator. Snapshot is built the way AIMovementGrid::createNavigationSnapshot does, so it
+     * can be serialized.
+     */
+    std::shared_ptr<const AINavigationSnapshot> createNavigationSnapshot() const {
+        std::unordered_map<const AIMovementNode *, uint32_t> nodeIndexes;
+        uint32_t nextIndex = 1;
+        if (root != nullptr && nodeIndexes.insert(std::make_pair(root, nextIndex)).second) {
+            nextIndex++;
+        }
+        for (size_t i = 1; i < doneNodes.size(); ++i) {
+            if (nodeIndexes.insert(std::make_pair(doneNodes[i], nextIndex)).second) {
+                nextIndex++;
+            }
+        }
+        for (size_t i = 0; i < visited.size(); ++i) {
+            if (nodeIndexes.insert(std::make_pair(visited[i], nextIndex)).second) {
+                nextIndex++;
+            }
+        }
+
+        AINavigationSnapshot::NodeArrays nodeArrays;
+        nodeArrays.resize(nextIndex);
+        for (auto nodeIt = nodeIndexes.begin(); nodeIt != nodeIndexes.end(); ++nodeIt) {
+            uint32_t index = nodeIt->second;
+            nodeArrays.positions[index] = nodeIt->first->getPosition();
+            nodeArrays.setMovable(index, nodeIt->first->isIsMovable());
+            for (int i = 0; i < 9; ++i) {
+                if (i == 4) {
+                    continue;
+                }
+                auto neighbourIt = nodeIndexes.find(nodeIt->first->getNeighbour(i));
+                if (neighbourIt != nodeIndexes.end()) {
+                    nodeArrays.neighbours[index * AINavigationSnapshot::NEIGHBOUR_COUNT +
+                                          AINavigationSnapshot::getNeighbourSlot(i)] = neighbourIt->second;
+                }
+            }
+        }
+        return std::make_shared<const AINavigationSnapshot>(std::move(nodeArrays), root == nullptr ? AINavigationSnapshot::NO_NODE : 1);
+    }
+};
+
+constexpr float BaselineGrid::floatingHeight;
+
+static void addStaticBox(btDiscreteDynamicsWorld *world, std::vector<btCollisionShape *> &shapes,
+                         std::vector<btRigidBody *> &bodies, const glm::vec3 &center, const glm::vec3 &halfExtent,
+                         const btQuaternion &orientation = btQuaternion::getIdentity()) {
+    btCollisionShape *shape = new btBoxShape(GLMConverter::GLMToBlt(halfExtent));
+    btDefaultMotionState *motionState = new btDefaultMotionState(btTransform(orientation, GLMConverter::GLMToBlt(center)));
+    btRigidBody *body = new btRigidBody(btRigidBody::btRigidBodyConstructionInfo(0, motionState, shape));
+    world->addRigidBody(body, COLLIDE_STATIC, COLLIDE_STATIC | COLLIDE_WALKER);
+    shapes.push_back(shape);
+    bodies.push_back(body);
+}
+
+static std::string positionToString(const char *positionData) {
+    float position[3];
+    memcpy(position, positionData, sizeof(position));
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%a,%a,%a", position[0], position[1], position[2]);
+    return buffer;
+}
+
+/**
+ * Serializes the snapshot, and reads it back as one line per node, sorted. A line has the position of the node, if
+ * it is movable and the root, and positions of its neighbours in slot order.
+ */
+static bool readSerializedNodes(const AINavigationSnapshot &snapshot, const std::string &fileName,
+                                std::vector<std::string> &nodeLines) {
+    if (!snapshot.serialize(fileName)) {
+        std::cerr << "Snapshot can't be serialized to " << fileName << std::endl;
+        return false;
+    }
+    std::ifstream inputFile(fileName, std::ios::in | std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+    inputFile.close();
+    std::remove(fileName.c_str());
+
+    //header is magic, version, node count and root node, then positions, movable bits and neighbours
+    uint32_t nodeCount, rootNode;
+    memcpy(&nodeCount, bytes.data() + 8, sizeof(uint32_t));
+    memcpy(&rootNode, bytes.data() + 12, sizeof(uint32_t));
+    const char *positionData = bytes.data() + 16;
+    const char *movableData = positionData + (size_t)nodeCount * 3 * sizeof(float);
+    const char *neighbourData = movableData + ((nodeCount + 31) / 32) * sizeof(uint32_t);
+    nodeLines.clear();
+    for (uint32_t node = 1; node < nodeCount; ++node) {
+        uint32_t movableWord;
+        memcpy(&movableWord, movableData + (node / 32) * sizeof(uint32_t), sizeof(uint32_t));
+        std::string line = positionToString(positionData + (size_t)node * 3 * sizeof(float)) +
+                           (((movableWord >> (node % 32)) & 1u) ? " movable" : " blocked") +
+                           (node == rootNode ? " root" : "");
+        for (uint32_t slot = 0; slot < AINavigationSnapshot::NEIGHBOUR_COUNT; ++slot) {
+            uint32_t neighbour;
+            memcpy(&neighbour, neighbourData + ((size_t)node * AINavigationSnapshot::NEIGHBOUR_COUNT + slot) * sizeof(uint32_t),
+                   sizeof(uint32_t));
+            line += neighbour == AINavigationSnapshot::NO_NODE ? " -" :
+                    " " + positionToString(positionData + (size_t)neighbour * 3 * sizeof(float));
+        }
+        nodeLines.push_back(line);
+    }
+    std::sort(nodeLines.begin(), nodeLines.end());
+    return true;
+}
+
+/**
+ * A position can be close enough to two visited nodes of the same column, if they are between 0.5 and 1 apart on y.
+ * Old generator searched visited backwards, so the most recently created node won. Checked directly, because the
+ * test world doesn't guarantee such a column.
+ */
+class AIMovementGridTest {
+public:
+    static bool checkVisitedTieBreak(bool isNewerNodeLower) {
+        AIMovementGrid grid;
+        grid.gridOrigin = glm::vec3(0, 0, 0);
+        AIMovementNode *olderNode = new AIMovementNode(grid.getNextID(), glm::vec3(0, isNewerNodeLower ? 2.9f : 2.0f, 0));
+        AIMovementNode *newerNode = new AIMovementNode(grid.getNextID(), glm::vec3(0, isNewerNodeLower ? 2.0f : 2.9f, 0));
+        grid.addVisited(olderNode);
+        grid.addVisited(newerNode);
+        glm::vec3 queryPosition(0.05f, 2.45f, 0);
+        if (grid.isAlreadyVisited(queryPosition) != newerNode) {
+            std::cerr << "Visited lookup didn't return the most recent node when newer node is "
+                      << (isNewerNodeLower ? "lower" : "higher") << std::endl;
+            return false;
+        }
+        grid.removeVisited(newerNode);
+        delete newerNode;
+        if (grid.isAlreadyVisited(queryPosition) != olderNode) {
+            std::cerr << "Visited lookup didn't return the remaining node after removal." << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+static bool isSameGrid(const std::vector<std::string> &expected, const std::vector<std::string> &actual,
+                       const std::string &name) {
+    if (expected.size() != actual.size()) {
+        std::cerr << name << " has " << actual.size() << " nodes, baseline generator has " << expected.size() << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (expected[i] != actual[i]) {
+            std::cerr << name << " is different from the baseline generator, expected node " << expected[i]
+                      << " but found " << actual[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    if (!AIMovementGridTest::checkVisitedTieBreak(true) || !AIMovementGridTest::checkVisitedTieBreak(false)) {
+        return 1;
+    }
+
+    btDbvtBroadphase broadphase;
+    btGhostPairCallback ghostPairCallback;
+    broadphase.getOverlappingPairCache()->setInternalGhostPairCallback(&ghostPairCallback);
+    btDefaultCollisionConfiguration collisionConfiguration;
+    btCollisionDispatcher dispatcher(&collisionConfiguration);
+    btSequentialImpulseConstraintSolver solver;
+    btDiscreteDynamicsWorld *world = new btDiscreteDynamicsWorld(&dispatcher, &broadphase, &solver, &collisionConfiguration);
+
+    std::vector<btCollisionShape *> shapes;
+    std::vector<btRigidBody *> bodies;
+    addStaticBox(world, shapes, bodies, glm::vec3(0, 0, 0), glm::vec3(20, 0.5f, 20));//ground, top is at 0.5
+    addStaticBox(world, shapes, bodies, glm::vec3(5, 2, -4), glm::vec3(0.5f, 1.5f, 10));//wall with a gap on +z
+    addStaticBox(world, shapes, bodies, glm::vec3(-8, 2, 6.5f), glm::vec3(6, 1.5f, 0.3f));//thin wall, not on grid
+    addStaticBox(world, shapes, bodies, glm::vec3(-10, 0.75f, -10), glm::vec3(4, 0.25f, 4));//step onto platform
+    addStaticBox(world, shapes, bodies, glm::vec3(12, 0.5f, 10), glm::vec3(4, 0.2f, 3),
+                 btQuaternion(btVector3(0, 0, 1), 0.15f));//ramp
+    addStaticBox(world, shapes, bodies, glm::vec3(-3, 2, -3), glm::vec3(0.4f, 1.5f, 0.4f));//pillar
+
+    glm::vec3 startPoint(0, 3, 0);
+    glm::vec3 worldMin(-25, -5, -25), worldMax(25, 20, 25);
+
+    std::vector<std::string> baselineNodes, serialNodes, parallelNodes;
+    bool isSerialized;
+    {
+        BaselineGrid baselineGrid(startPoint, world, worldMin, worldMax, COLLIDE_WALKER, COLLIDE_STATIC);
+        isSerialized = readSerializedNodes(*baselineGrid.createNavigationSnapshot(), "AIMovementGridTestBaseline.aiwalkbin", baselineNodes);
+    }
+    {
+        AIMovementGrid serialGrid(startPoint, world, worldMin, worldMax, COLLIDE_WALKER, COLLIDE_STATIC, nullptr);
+        isSerialized &= readSerializedNodes(*serialGrid.createNavigationSnapshot(), "AIMovementGridTestSerial.aiwalkbin", serialNodes);
+    }
+    {
+        JobSystem jobSystem(4);
+        AIMovementGrid parallelGrid(startPoint, world, worldMin, worldMax, COLLIDE_WALKER, COLLIDE_STATIC, &jobSystem);
+        isSerialized &= readSerializedNodes(*parallelGrid.createNavigationSnapshot(), "AIMovementGridTestParallel.aiwalkbin", parallelNodes);
+    }
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        world->removeRigidBody(bodies[i]);
+        delete bodies[i]->getMotionState();
+        delete bodies[i];
+        delete shapes[i];
+    }
+    delete world;
+
+    if (!isSerialized) {
+        return 1;
+    }
+    if (baselineNodes.size() < 100) {
+        std::cerr << "Baseline grid has only " << baselineNodes.size() << " nodes, world setup is wrong." << std::endl;
+        return 1;
+    }
+    bool passed = isSameGrid(baselineNodes, serialNodes, "Grid generated without job system");
+    passed &= isSameGrid(baselineNodes, parallelNodes, "Grid generated with job system");
+    if (!passed) {
+        return 1;
+    }
+    std::cout << "AI walk grids are the same with the baseline generator, " << baselineNodes.size() << " nodes." << std::endl;
+    return 0;
+}
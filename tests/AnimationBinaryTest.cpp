@@ -0,0 +1,135 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include "Assets/Animations/AnimationCustom.h"
+#include "Assets/Animations/AnimationLoader.h"
+
+/**
+ * Writes a custom animation as .animbin, loads it back and checks samples are bit identical. Then checks truncated
+ * and corrupted copies of the file are rejected instead of being read past their end.
+ *
+ * There is no XML next to the binary, so a rejected binary makes loadAnimation return nullptr.
+ */
+
+static const std::string XML_FILE_NAME = "AnimationBinaryTest.xml";
+static const std::string BINARY_FILE_NAME = "AnimationBinaryTest.animbin";
+
+static AnimationCustom *createAnimation() {
+    AnimationNode *node = new AnimationNode();
+    for (int i = 0; i < 50; i++) {
+        node->translateTimes.push_back(i * 0.1f + 1e-7f * i);
+        node->translates.push_back(glm::vec3(i * 0.3333333f, -i, 1.0f / (i + 1)));
+    }
+    for (int i = 0; i < 7; i++) {
+        node->scaleTimes.push_back(i * 0.8f);
+        node->scales.push_back(glm::vec3(1.0f + i, 2.0f, 3.0f / (i + 1)));
+    }
+    for (int i = 0; i < 31; i++) {
+        node->rotationTimes.push_back(i * 0.17f);
+        node->rotations.push_back(glm::normalize(glm::quat(1.0f, i * 0.01f, 0.2f, -0.3f)));
+    }
+    return new AnimationCustom("binary test animation", node, 5);
+}
+
+static bool writeBytes(const std::vector<char> &bytes) {
+    std::ofstream outputFile(BINARY_FILE_NAME, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outputFile.is_open()) {
+        std::cerr << "Can't write " << BINARY_FILE_NAME << std::endl;
+        return false;
+    }
+    outputFile.write(bytes.data(), bytes.size());
+    return outputFile.good();
+}
+
+static bool isRejected(const std::vector<char> &bytes, const std::string &caseName) {
+    if (!writeBytes(bytes)) {
+        return false;
+    }
+    AnimationCustom *loadedAnimation = AnimationLoader::loadAnimation(XML_FILE_NAME);
+    if (loadedAnimation != nullptr) {
+        std::cerr << "Animation file that is " << caseName << " is loaded." << std::endl;
+        delete loadedAnimation;
+        return false;
+    }
+    return true;
+}
+
+static bool checkRoundTrip(const AnimationCustom &animation) {
+    AnimationCustom *loadedAnimation = AnimationLoader::loadAnimation(XML_FILE_NAME);
+    if (loadedAnimation == nullptr) {
+        std::cerr << "Animation can't be loaded back from " << BINARY_FILE_NAME << std::endl;
+        return false;
+    }
+    bool isSame = loadedAnimation->getName() == animation.getName() &&
+                  loadedAnimation->getDuration() == animation.getDuration() &&
+                  loadedAnimation->getTicksPerSecond() == animation.getTicksPerSecond();
+    if (!isSame) {
+        std::cerr << "Loaded animation name, duration or ticks per second is different." << std::endl;
+    }
+    for (float time = -0.5f; time < 10.0f && isSame; time += 0.05f) {
+        glm::vec3 translate, scale, loadedTranslate, loadedScale;
+        glm::quat orientation, loadedOrientation;
+        animation.calculateChannelTransform(0, time, translate, scale, orientation, nullptr);
+        loadedAnimation->calculateChannelTransform(0, time, loadedTranslate, loadedScale, loadedOrientation, nullptr);
+        isSame = memcmp(&translate, &loadedTranslate, sizeof(translate)) == 0 &&
+                 memcmp(&scale, &loadedScale, sizeof(scale)) == 0 &&
+                 memcmp(&orientation, &loadedOrientation, sizeof(orientation)) == 0;
+        if (!isSame) {
+            std::cerr << "Loaded animation sample at time " << time << " is different." << std::endl;
+        }
+    }
+    delete loadedAnimation;
+    return isSame;
+}
+
+int main() {
+    std::remove(XML_FILE_NAME.c_str());
+    AnimationCustom *animation = createAnimation();
+    if (!animation->serializeAnimationBinary(BINARY_FILE_NAME)) {
+        std::cerr << "Animation can't be saved as binary." << std::endl;
+        delete animation;
+        return 1;
+    }
+    bool passed = checkRoundTrip(*animation);
+    delete animation;
+
+    std::ifstream inputFile(BINARY_FILE_NAME, std::ios::in | std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+    inputFile.close();
+
+    //header is 24 bytes and the name is padded to 24, so these cut the header, the name, the key counts, the keys,
+    //and the last byte
+    size_t truncatedSizes[] = {0, 3, 23, 29, 52, bytes.size() / 2, bytes.size() - 1};
+    for (size_t truncatedSize : truncatedSizes) {
+        std::vector<char> truncatedBytes(bytes.begin(), bytes.begin() + truncatedSize);
+        passed &= isRejected(truncatedBytes, "truncated to " + std::to_string(truncatedSize) + " bytes");
+    }
+
+    std::vector<char> extendedBytes(bytes);
+    extendedBytes.push_back(0);
+    passed &= isRejected(extendedBytes, "longer than its keys");
+
+    std::vector<char> wrongMagicBytes(bytes);
+    wrongMagicBytes[0] = 'X';
+    passed &= isRejected(wrongMagicBytes, "not starting with the magic");
+
+    //translate key count is at 48, translate keys start at 60, 50 keys of time and 3 floats
+    std::vector<char> noTranslateBytes(bytes);
+    memset(noTranslateBytes.data() + 48, 0, sizeof(uint32_t));
+    noTranslateBytes.erase(noTranslateBytes.begin() + 60, noTranslateBytes.begin() + 60 + 50 * 4 * sizeof(float));
+    passed &= isRejected(noTranslateBytes, "without translate keys");
+
+    std::remove(BINARY_FILE_NAME.c_str());
+    if (!passed) {
+        return 1;
+    }
+    std::cout << "Animation binary round trip is exact, and broken files are rejected." << std::endl;
+    return 0;
+}
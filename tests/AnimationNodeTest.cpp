@@ -0,0 +1,193 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <string>
+#include "Assets/Animations/AnimationNode.h"
+#include "Assets/Animations/AnimationCustom.h"
+#include "Assets/Animations/AnimationLoader.h"
+
+/**
+ * Checks sampling through cursors gives the same values as searching the keys linearly from the first key, which is
+ * how AnimationNode sampled before cursors. Forward playback with looping, random seeks and sampling without a cursor
+ * are all compared.
+ *
+ * Random nodes are checked first, then the nodes of animations shipped in Data/Animations. Build copies them next to
+ * the test, ctest runs it there.
+ */
+
+static const float EPSILON = 0.00001f;
+
+static uint32_t findKeyIndexLinear(const std::vector<float> &times, float timeInTicks) {
+    for (uint32_t i = 0; i + 1 < times.size(); i++) {
+        if (timeInTicks < times[i + 1]) {
+            return i;
+        }
+    }
+    return (uint32_t)times.size() - 2;
+}
+
+static glm::vec3 interpolateLinear(const std::vector<glm::vec3> &values, const std::vector<float> &times, float timeInTicks) {
+    if (values.size() == 1 || timeInTicks < times[0]) {
+        return values[0];
+    }
+    if (timeInTicks >= times[times.size() - 1]) {
+        return values[values.size() - 1];
+    }
+    uint32_t index = findKeyIndexLinear(times, timeInTicks);
+    float factor = (timeInTicks - times[index]) / (times[index + 1] - times[index]);
+    return values[index] + factor * (values[index + 1] - values[index]);
+}
+
+static glm::quat interpolateLinear(const std::vector<glm::quat> &values, const std::vector<float> &times, float timeInTicks) {
+    if (values.size() == 1 || timeInTicks < times[0]) {
+        return values[0];
+    }
+    if (timeInTicks >= times[times.size() - 1]) {
+        return values[values.size() - 1];
+    }
+    uint32_t index = findKeyIndexLinear(times, timeInTicks);
+    float factor = (timeInTicks - times[index]) / (times[index + 1] - times[index]);
+    return glm::normalize(glm::slerp(values[index], values[index + 1], factor));
+}
+
+static std::vector<float> createKeyTimes(std::mt19937 &generator, size_t keyCount, float duration) {
+    std::uniform_real_distribution<float> gap(0.1f, 1.0f);
+    std::vector<float> times;
+    float time = 0;
+    for (size_t i = 0; i < keyCount; ++i) {
+        times.push_back(time);
+        time += gap(generator);
+    }
+    //scale to duration, so channels with different key counts span the same time
+    if (keyCount > 1) {
+        float scale = duration / times[keyCount - 1];
+        for (size_t i = 0; i < keyCount; ++i) {
+            times[i] *= scale;
+        }
+    }
+    return times;
+}
+
+static AnimationNode createNode(std::mt19937 &generator, size_t keyCount, float duration) {
+    std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    AnimationNode node;
+    node.translateTimes = createKeyTimes(generator, keyCount, duration);
+    for (size_t i = 0; i < keyCount; ++i) {
+        node.translates.push_back(glm::vec3(value(generator), value(generator), value(generator)));
+    }
+    //scales and rotations have different key counts, so each channel has its own cursor index
+    node.scaleTimes = createKeyTimes(generator, keyCount / 2 + 1, duration);
+    for (size_t i = 0; i < node.scaleTimes.size(); ++i) {
+        node.scales.push_back(glm::vec3(value(generator), value(generator), value(generator)));
+    }
+    node.rotationTimes = createKeyTimes(generator, keyCount * 2, duration);
+    for (size_t i = 0; i < node.rotationTimes.size(); ++i) {
+        node.rotations.push_back(glm::normalize(glm::quat(unit(generator), unit(generator), unit(generator), unit(generator))));
+    }
+    return node;
+}
+
+static bool isClose(const glm::vec3 &first, const glm::vec3 &second) {
+    return std::fabs(first.x - second.x) <= EPSILON * (1.0f + std::fabs(second.x)) &&
+           std::fabs(first.y - second.y) <= EPSILON * (1.0f + std::fabs(second.y)) &&
+           std::fabs(first.z - second.z) <= EPSILON * (1.0f + std::fabs(second.z));
+}
+
+static bool isClose(const glm::quat &first, const glm::quat &second) {
+    return std::fabs(first.x - second.x) <= EPSILON && std::fabs(first.y - second.y) <= EPSILON &&
+           std::fabs(first.z - second.z) <= EPSILON && std::fabs(first.w - second.w) <= EPSILON;
+}
+
+static bool checkSample(const AnimationNode &node, float timeInTicks, AnimationNode::Cursor *cursor, const char *caseName) {
+    glm::vec3 position = node.getPositionVector(timeInTicks, cursor);
+    glm::vec3 scale = node.getScalingVector(timeInTicks, cursor);
+    glm::quat rotation = node.getRotationQuat(timeInTicks, cursor);
+    if (!isClose(position, interpolateLinear(node.translates, node.translateTimes, timeInTicks)) ||
+        !isClose(scale, interpolateLinear(node.scales, node.scaleTimes, timeInTicks)) ||
+        !isClose(rotation, interpolateLinear(node.rotations, node.rotationTimes, timeInTicks))) {
+        std::cerr << "Sample for " << caseName << " at time " << timeInTicks << " doesn't match linear search." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool checkNode(const AnimationNode &node, float duration, std::mt19937 &generator) {
+    bool passed = true;
+    //forward playback at different frame steps, looping 3 times so cursors wrap back to the start
+    float steps[] = {0.016f, 0.1f, 0.9f, 3.0f};
+    for (float step : steps) {
+        AnimationNode::Cursor cursor;
+        for (float time = 0; time < duration * 3 && passed; time += step) {
+            passed &= checkSample(node, std::fmod(time, duration), &cursor, "forward playback");
+        }
+    }
+
+    //random seeks, including before the first and after the last key
+    std::uniform_real_distribution<float> seek(-1.0f, duration + 1.0f);
+    AnimationNode::Cursor cursor;
+    for (int i = 0; i < 1000 && passed; ++i) {
+        passed &= checkSample(node, seek(generator), &cursor, "random seek");
+    }
+
+    //exactly on keys
+    for (size_t i = 0; i < node.translateTimes.size() && passed; ++i) {
+        passed &= checkSample(node, node.translateTimes[i], &cursor, "key time");
+    }
+
+    for (int i = 0; i < 1000 && passed; ++i) {
+        passed &= checkSample(node, seek(generator), nullptr, "no cursor");
+    }
+    return passed;
+}
+
+class AnimationNodeTest {
+public:
+    static bool checkShippedAnimation(const std::string &fileName, std::mt19937 &generator) {
+        AnimationCustom *animation = AnimationLoader::loadAnimation(fileName);
+        if (animation == nullptr) {
+            std::cerr << "Shipped animation " << fileName << " can't be loaded." << std::endl;
+            return false;
+        }
+        const AnimationNode &node = *animation->animationNode;
+        bool passed = !node.translateTimes.empty() && !node.scaleTimes.empty() && !node.rotationTimes.empty();
+        if (!passed) {
+            std::cerr << "Shipped animation " << fileName << " has a channel without keys." << std::endl;
+        } else {
+            passed = checkNode(node, animation->getDuration(), generator);
+        }
+        delete animation;
+        return passed;
+    }
+};
+
+int main() {
+    std::mt19937 generator(12);
+    size_t keyCounts[] = {1, 2, 3, 17, 250};
+    const float duration = 40.0f;
+
+    for (size_t keyCount : keyCounts) {
+        AnimationNode node = createNode(generator, keyCount, duration);
+        if (!checkNode(node, duration, generator)) {
+            std::cerr << "Failed for node with " << keyCount << " translate keys." << std::endl;
+            return 1;
+        }
+    }
+
+    const std::string shippedAnimations[] = {"./Data/Animations/rotateCoin.xml", "./Data/Animations/rotateLever.xml",
+                                             "./Data/Animations/moveHiddenDoorDown.xml",
+                                             "./Data/Animations/stairUpMovement.xml"};
+    for (const std::string &fileName : shippedAnimations) {
+        if (!AnimationNodeTest::checkShippedAnimation(fileName, generator)) {
+            std::cerr << "Failed for shipped animation " << fileName << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Cursor sampling matches linear search." << std::endl;
+    return 0;
+}
@@ -0,0 +1,93 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <chrono>
+#include "Assets/Animations/AnimationPose.h"
+
+/**
+ * Times AnimationPose::blend against blendScalar, and AnimationPose::multiply against glm, for skeletons of 67 bones,
+ * the size of a humanoid skeleton. Each iteration blends two poses of a character, then builds its palette by
+ * multiplying each bone with its parent, like ModelAsset::setPalette.
+ *
+ * Results are summed, so the work is not optimized away. Blends must give the same sum, as blend and blendScalar are
+ * bit identical.
+ */
+
+static const size_t BONE_COUNT = 67;
+static const int ITERATION_COUNT = 200000;
+
+typedef void (*BlendFunction)(const AnimationPose &, const AnimationPose &, float, AnimationPose &);
+
+static double timeBlend(BlendFunction blendFunction, const AnimationPose &from, const AnimationPose &to, double &checksum) {
+    AnimationPose result;
+    checksum = 0;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATION_COUNT; ++i) {
+        blendFunction(from, to, (i % 100) / 100.0f, result);
+        checksum += result.getMatrix(i % BONE_COUNT)[3][0];
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count() / ITERATION_COUNT;
+}
+
+static double timeMultiply(bool isGLM, const std::vector<glm::mat4> &localTransforms, const std::vector<size_t> &parents,
+                           double &checksum) {
+    std::vector<glm::mat4> nodeTransforms(localTransforms.size());
+    checksum = 0;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATION_COUNT; ++i) {
+        nodeTransforms[0] = localTransforms[0];
+        for (size_t bone = 1; bone < localTransforms.size(); ++bone) {
+            if (isGLM) {
+                nodeTransforms[bone] = nodeTransforms[parents[bone]] * localTransforms[bone];
+            } else {
+                AnimationPose::multiply(nodeTransforms[parents[bone]], localTransforms[bone], nodeTransforms[bone]);
+            }
+        }
+        checksum += nodeTransforms[i % BONE_COUNT][3][0];
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count() / ITERATION_COUNT;
+}
+
+int main() {
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    AnimationPose from, to;
+    from.resize(BONE_COUNT);
+    to.resize(BONE_COUNT);
+    for (size_t i = 0; i < BONE_COUNT; ++i) {
+        from.set(i, glm::vec3(value(generator), value(generator), value(generator)), glm::vec3(1.0f),
+                 glm::quat(value(generator), value(generator), value(generator), value(generator)));
+        to.set(i, glm::vec3(value(generator), value(generator), value(generator)), glm::vec3(1.0f),
+               glm::quat(value(generator), value(generator), value(generator), value(generator)));
+    }
+
+    //a chain with branches, each bone is attached to one of the previous 4
+    std::vector<glm::mat4> localTransforms;
+    std::vector<size_t> parents;
+    for (size_t i = 0; i < BONE_COUNT; ++i) {
+        localTransforms.push_back(from.getMatrix(i));
+        parents.push_back(i < 4 ? 0 : i - 1 - (i % 4));
+    }
+
+    double scalarChecksum, sseChecksum, glmChecksum, multiplyChecksum;
+    double scalarTime = timeBlend(&AnimationPose::blendScalar, from, to, scalarChecksum);
+    double sseTime = timeBlend(&AnimationPose::blend, from, to, sseChecksum);
+    double glmTime = timeMultiply(true, localTransforms, parents, glmChecksum);
+    double multiplyTime = timeMultiply(false, localTransforms, parents, multiplyChecksum);
+
+    std::cout << BONE_COUNT << " bones, " << ITERATION_COUNT << " iterations" << std::endl;
+    std::cout << "blendScalar:             " << scalarTime << " us per pose" << std::endl;
+    std::cout << "blend:                   " << sseTime << " us per pose" << std::endl;
+    std::cout << "glm multiply:            " << glmTime << " us per palette" << std::endl;
+    std::cout << "AnimationPose::multiply: " << multiplyTime << " us per palette" << std::endl;
+    if (scalarChecksum != sseChecksum) {
+        std::cerr << "blend and blendScalar results are different, " << scalarChecksum << " and " << sseChecksum << std::endl;
+        return 1;
+    }
+    std::cout << "multiply checksums: glm " << glmChecksum << ", AnimationPose " << multiplyChecksum << std::endl;
+    return 0;
+}
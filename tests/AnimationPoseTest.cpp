@@ -0,0 +1,107 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <random>
+#include <cstring>
+#include <cmath>
+#include "Assets/Animations/AnimationPose.h"
+
+/**
+ * Checks AnimationPose::blend gives bit identical poses to blendScalar, for bone counts that are not multiples of 4,
+ * and multiply gives the same matrix as glm, also when the result is one of the parameters.
+ */
+
+static void createRandomPoses(size_t boneCount, std::mt19937 &generator, AnimationPose &from, AnimationPose &to) {
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    from.resize(boneCount);
+    to.resize(boneCount);
+    for (size_t i = 0; i < boneCount; ++i) {
+        from.set(i, glm::vec3(value(generator), value(generator), value(generator)),
+                 glm::vec3(value(generator), value(generator), value(generator)),
+                 glm::quat(value(generator), value(generator), value(generator), value(generator)));
+        to.set(i, glm::vec3(value(generator), value(generator), value(generator)),
+               glm::vec3(value(generator), value(generator), value(generator)),
+               glm::quat(value(generator), value(generator), value(generator), value(generator)));
+    }
+}
+
+static bool checkBlend(size_t boneCount, std::mt19937 &generator) {
+    AnimationPose from, to, scalarResult, result;
+    createRandomPoses(boneCount, generator, from, to);
+    float factors[] = {0.0f, 0.37f, 0.5f, 1.0f};
+    for (float factor : factors) {
+        AnimationPose::blendScalar(from, to, factor, scalarResult);
+        AnimationPose::blend(from, to, factor, result);
+        if (result.getBoneCount() != boneCount || scalarResult.getBoneCount() != boneCount) {
+            std::cerr << "Blending " << boneCount << " bones resulted " << result.getBoneCount() << " and "
+                      << scalarResult.getBoneCount() << " bones." << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < boneCount; ++i) {
+            glm::mat4 scalarMatrix = scalarResult.getMatrix(i);
+            glm::mat4 matrix = result.getMatrix(i);
+            if (memcmp(&scalarMatrix, &matrix, sizeof(matrix)) != 0) {
+                std::cerr << "Bone " << i << " of " << boneCount << " is different between blend and blendScalar "
+                          << "for factor " << factor << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool isClose(const glm::mat4 &first, const glm::mat4 &second) {
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            if (std::fabs(first[i][j] - second[i][j]) > 0.00001f) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool checkMultiply(std::mt19937 &generator) {
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        glm::mat4 first, second;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                first[i][j] = value(generator);
+                second[i][j] = value(generator);
+            }
+        }
+        glm::mat4 expected = first * second;
+        glm::mat4 result;
+        AnimationPose::multiply(first, second, result);
+        if (!isClose(expected, result)) {
+            std::cerr << "multiply is different from glm." << std::endl;
+            return false;
+        }
+        glm::mat4 firstCopy = first;
+        AnimationPose::multiply(firstCopy, second, firstCopy);
+        AnimationPose::multiply(first, second, second);
+        if (!isClose(expected, firstCopy) || !isClose(expected, second)) {
+            std::cerr << "multiply is wrong when result is one of the parameters." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::mt19937 generator(14);
+    bool passed = true;
+    size_t boneCounts[] = {1, 3, 4, 5, 67, 128};
+    for (size_t boneCount : boneCounts) {
+        passed &= checkBlend(boneCount, generator);
+    }
+    passed &= checkMultiply(generator);
+    if (!passed) {
+        return 1;
+    }
+    std::cout << "AnimationPose blend matches blendScalar, multiply matches glm." << std::endl;
+    return 0;
+}
@@ -0,0 +1,127 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <map>
+#include <chrono>
+#include "CullingTree.h"
+#include "PhysicalRenderable.h"
+#include "GLHelper.h"
+
+/**
+ * 20000 objects culled against 4 perspective frusta, comparing the full scan over the object map World used before,
+ * with CullingTree queries followed by the exact test of each candidate. 1% of the objects move every frame, the tree
+ * refit is included in its time. Both give the same visible counts, the benchmark fails if they don't.
+ *
+ * Objects have no rigid body and no GL buffers, they are not deleted, since Renderable destructor frees GL buffers.
+ */
+
+class BenchmarkObject : public PhysicalRenderable {
+public:
+    BenchmarkObject(const glm::vec3 &center, const glm::vec3 &halfExtent) : PhysicalRenderable(nullptr, 0, true) {
+        moveTo(center, halfExtent);
+    }
+
+    void moveTo(const glm::vec3 &center, const glm::vec3 &halfExtent) {
+        transformation.setTransformationsNotPropagate(center);
+        aabbMin = center - halfExtent;
+        aabbMax = center + halfExtent;
+        if (cullingTree != nullptr) {
+            cullingTree->markMoved(this);
+        }
+    }
+
+    void render() override {}
+    void setupForTime(long time __attribute((unused))) override {}
+    void renderWithProgram(GLSLProgram &program __attribute((unused))) override {}
+    void fillObjects(tinyxml2::XMLDocument &document __attribute((unused)),
+                     tinyxml2::XMLElement *objectsNode __attribute((unused))) const override {}
+};
+
+int main() {
+    const uint32_t objectCount = 20000;
+    const uint32_t movingObjectCount = objectCount / 100;
+    const int frameCount = 200;
+
+    std::mt19937 generator(21);
+    std::uniform_real_distribution<float> horizontal(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> vertical(0.0f, 50.0f);
+    std::uniform_real_distribution<float> extent(0.5f, 5.0f);
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+
+    CullingTree cullingTree;
+    std::map<uint32_t, PhysicalRenderable *> objects;
+    std::vector<BenchmarkObject *> objectList;
+    std::vector<glm::vec3> centers, halfExtents;
+    for (uint32_t i = 0; i < objectCount; ++i) {
+        centers.push_back(glm::vec3(horizontal(generator), vertical(generator), horizontal(generator)));
+        halfExtents.push_back(glm::vec3(extent(generator), extent(generator), extent(generator)));
+        BenchmarkObject *object = new BenchmarkObject(centers[i], halfExtents[i]);
+        objects[i] = object;
+        objectList.push_back(object);
+        cullingTree.insert(object);
+    }
+
+    //camera and 3 light frusta, looking at different parts of the world
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+    glm::vec3 eyes[4] = {glm::vec3(0, 20, 0), glm::vec3(200, 40, 200), glm::vec3(-300, 30, 100), glm::vec3(0, 80, -400)};
+    glm::vec3 targets[4] = {glm::vec3(0, 0, -100), glm::vec3(300, 0, 300), glm::vec3(-100, 0, 100), glm::vec3(0, 0, -200)};
+    std::vector<std::vector<glm::vec4>> frusta(4, std::vector<glm::vec4>(6));
+    for (int i = 0; i < 4; ++i) {
+        GLHelper::calculateFrustumPlanes(glm::lookAt(eyes[i], targets[i], glm::vec3(0, 1, 0)), projection, frusta[i]);
+    }
+
+    std::vector<PhysicalRenderable *> movedObjects;
+    cullingTree.refit(movedObjects);
+
+    size_t scanVisibleCount = 0, treeVisibleCount = 0;
+    std::chrono::steady_clock::duration scanTime(0), treeTime(0);
+    std::vector<PhysicalRenderable *> candidates;
+    for (int frame = 0; frame < frameCount; ++frame) {
+        for (uint32_t i = 0; i < movingObjectCount; ++i) {
+            uint32_t index = (frame * movingObjectCount + i) % objectCount;
+            centers[index] += glm::vec3(step(generator), 0, step(generator));
+            objectList[index]->moveTo(centers[index], halfExtents[index]);
+        }
+
+        std::chrono::steady_clock::time_point scanStart = std::chrono::steady_clock::now();
+        for (size_t frustum = 0; frustum < frusta.size(); ++frustum) {
+            for (auto iterator = objects.begin(); iterator != objects.end(); ++iterator) {
+                if (GLHelper::isInFrustum(iterator->second->getAabbMin(), iterator->second->getAabbMax(), frusta[frustum])) {
+                    scanVisibleCount++;
+                }
+            }
+        }
+        std::chrono::steady_clock::time_point treeStart = std::chrono::steady_clock::now();
+        movedObjects.clear();
+        cullingTree.refit(movedObjects);
+        for (size_t frustum = 0; frustum < frusta.size(); ++frustum) {
+            candidates.clear();
+            cullingTree.queryFrustum(frusta[frustum], candidates);
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                if (GLHelper::isInFrustum(candidates[i]->getAabbMin(), candidates[i]->getAabbMax(), frusta[frustum])) {
+                    treeVisibleCount++;
+                }
+            }
+        }
+        std::chrono::steady_clock::time_point treeEnd = std::chrono::steady_clock::now();
+        scanTime += treeStart - scanStart;
+        treeTime += treeEnd - treeStart;
+    }
+
+    if (scanVisibleCount != treeVisibleCount) {
+        std::cerr << "Full scan found " << scanVisibleCount << " visible objects, tree found " << treeVisibleCount
+                  << std::endl;
+        return 1;
+    }
+    std::cout << objectCount << " objects, " << frusta.size() << " frusta, " << movingObjectCount
+              << " objects moving per frame, " << scanVisibleCount / frameCount << " visible per frame" << std::endl;
+    std::cout << "Full scan:    " << std::chrono::duration<double, std::milli>(scanTime).count() / frameCount
+              << " ms per frame" << std::endl;
+    std::cout << "CullingTree:  " << std::chrono::duration<double, std::milli>(treeTime).count() / frameCount
+              << " ms per frame, including refit" << std::endl;
+    return 0;
+}
@@ -0,0 +1,335 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <map>
+#include <queue>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <iterator>
+#include "AI/AIMovementNode.h"
+#include "AI/AINavigationSnapshot.h"
+
+/**
+ * Route queries comparing AINavigationSnapshot with the A* AIMovementGrid used before the snapshot. That A* is copied
+ * here as baselineAStarPath, working on the same grid built as AIMovementNodes. Both start from a known node, like
+ * requests of an actor that was found before.
+ *
+ * Usage: NavigationBenchmark [grid.aiwalkbin]. Grid is loaded from the file if one is passed, like the one
+ * AIGridBenchmark saves, otherwise a 300x300 grid with walls is built.
+ *
+ * First set of routes are at most NAVIGATION_FLAT_SEARCH_DEPTH cells apart, so the snapshot searches them on the grid
+ * too. Then route length and query time are reported for longer distances, where the snapshot plans over clusters and
+ * its routes can be longer than the grid A* routes. Route ends are picked so they are connected.
+ */
+
+static const int GRID_SIZE = 300;
+
+static bool isBlocked(int x, int z) {
+    return (x == GRID_SIZE / 2 && z < GRID_SIZE - 3) || (z == 100 && x > 20 && x < GRID_SIZE / 2) ||
+           (x == 37 && z > 3 && z < 100) || (z == 20 && x > 40 && x < 60);
+}
+
+static uint32_t getNodeIndex(int x, int z) {
+    return (uint32_t)(1 + x * GRID_SIZE + z);
+}
+
+struct AINodeWithPriority {
+    const AIMovementNode *node;
+    float priority;
+
+    AINodeWithPriority(const AIMovementNode *node, float priority) : node(node), priority(priority) {}
+
+    bool operator>(const AINodeWithPriority &aiRight) const {
+        return priority > aiRight.priority;
+    }
+};
+
+static const AIMovementNode *baselineAStarPath(const AIMovementNode *start, const glm::vec3 &destination,
+                                               std::vector<glm::vec3> *route) {
+    std::priority_queue<AINodeWithPriority, std::vector<AINodeWithPriority>, std::greater<AINodeWithPriority>> frontier;
+    frontier.push(AINodeWithPriority(start, 0));
+
+    std::map<const AIMovementNode *, const AIMovementNode *> from;
+    std::map<const AIMovementNode *, float> totalCost;
+    std::map<const AIMovementNode *, uint32_t> totalNodes;
+    const AIMovementNode *finalNode = nullptr;
+    from[start] = nullptr;
+    totalCost[start] = 0;
+    totalNodes[start] = 0;
+    while (!frontier.empty()) {
+        AINodeWithPriority nodeWithPriority = frontier.top();
+        frontier.pop();
+        if (glm::length2(destination - nodeWithPriority.node->getPosition()) < GRID_SNAP_DISTANCE) {
+            finalNode = nodeWithPriority.node;
+            break;
+        }
+        for (int i = 0; i < 9; ++i) {
+            AIMovementNode *currentNode = nodeWithPriority.node->getNeighbour(i);
+            if (currentNode == nullptr || !currentNode->isIsMovable()) {
+                continue;
+            }
+            float movementCost = glm::length(currentNode->getPosition() - nodeWithPriority.node->getPosition());
+            float heuristic = glm::length(destination - currentNode->getPosition());
+            float currentCost = totalCost[nodeWithPriority.node] + movementCost + heuristic;
+            uint32_t currentNodeCount = totalNodes[nodeWithPriority.node] + 1;
+            if (!totalCost.count(currentNode) || currentCost < totalCost[currentNode]) {
+                frontier.push(AINodeWithPriority(currentNode, currentCost));
+                from[currentNode] = nodeWithPriority.node;
+                totalCost[currentNode] = currentCost;
+                totalNodes[currentNode] = currentNodeCount;
+            }
+        }
+    }
+    if (finalNode == nullptr || finalNode == start) {
+        return finalNode;
+    }
+    route->clear();
+    route->push_back(finalNode->getPosition());
+    const AIMovementNode *fromNode = from[finalNode];
+    while (start != fromNode) {
+        route->push_back(fromNode->getPosition());
+        fromNode = from[fromNode];
+    }
+    return finalNode;
+}
+
+static float getRouteLength(const glm::vec3 &start, const std::vector<glm::vec3> &route) {
+    float length = 0;
+    glm::vec3 previous = start;
+    for (size_t i = 0; i < route.size(); ++i) {
+        length += glm::length(route[i] - previous);
+        previous = route[i];
+    }
+    return length;
+}
+
+static bool benchmarkRoutes(const std::vector<std::pair<uint32_t, uint32_t>> &queries,
+                            const std::vector<AIMovementNode *> &nodes, const AINavigationSnapshot &snapshot) {
+    double baselineLength = 0, snapshotLength = 0;
+    std::chrono::steady_clock::duration baselineTime(0), snapshotTime(0);
+    std::vector<glm::vec3> baselineRoute;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const AIMovementNode *fromNode = nodes[queries[i].first];
+        const AIMovementNode *toNode = nodes[queries[i].second];
+
+        std::chrono::steady_clock::time_point baselineStart = std::chrono::steady_clock::now();
+        const AIMovementNode *finalNode = baselineAStarPath(fromNode, toNode->getPosition(), &baselineRoute);
+        std::chrono::steady_clock::time_point snapshotStart = std::chrono::steady_clock::now();
+        AINavigationSnapshot::RouteRequest request;
+        request.from = fromNode->getPosition();
+        request.to = toNode->getPosition();
+        request.startNodeHint = queries[i].first;
+        AINavigationSnapshot::RouteResult result = snapshot.coursePath(request);
+        std::chrono::steady_clock::time_point snapshotEnd = std::chrono::steady_clock::now();
+
+        if (finalNode == nullptr || !result.found) {
+            std::cerr << "Route from " << queries[i].first << " to " << queries[i].second << " is not found." << std::endl;
+            return false;
+        }
+        //baseline route is from the destination back to start
+        std::reverse(baselineRoute.begin(), baselineRoute.end());
+        baselineLength += getRouteLength(fromNode->getPosition(), baselineRoute);
+        snapshotLength += getRouteLength(fromNode->getPosition(), result.route);
+        baselineTime += snapshotStart - baselineStart;
+        snapshotTime += snapshotEnd - snapshotStart;
+    }
+
+    double baselineMicroseconds = std::chrono::duration<double, std::micro>(baselineTime).count() / queries.size();
+    double snapshotMicroseconds = std::chrono::duration<double, std::micro>(snapshotTime).count() / queries.size();
+    std::cout << "AIMovementGrid A*:    " << baselineMicroseconds << " us per route, average length "
+              << baselineLength / queries.size() << std::endl;
+    std::cout << "AINavigationSnapshot: " << snapshotMicroseconds << " us per route, average length "
+              << snapshotLength / queries.size() << std::endl;
+    std::cout << "Speedup: " << baselineMicroseconds / snapshotMicroseconds << "x" << std::endl;
+    return true;
+}
+
+static int getCellDistance(const AIMovementNode *from, const AIMovementNode *to) {
+    return (int)std::lround(std::max(std::fabs(to->getPosition().x - from->getPosition().x),
+                                     std::fabs(to->getPosition().z - from->getPosition().z)));
+}
+
+/**
+ * Random pairs of connected movable nodes, that are between minimumDistance and maximumDistance cells apart on x or z.
+ * Node IDs must be their indexes.
+ */
+static std::vector<std::pair<uint32_t, uint32_t>> createQueries(size_t count, int minimumDistance, int maximumDistance,
+                                                                const std::vector<AIMovementNode *> &nodes,
+                                                                std::mt19937 &generator) {
+    std::vector<uint32_t> movableNodes;
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        if (nodes[i] != nullptr && nodes[i]->isIsMovable()) {
+            movableNodes.push_back((uint32_t)i);
+        }
+    }
+    std::uniform_int_distribution<size_t> movableNode(0, movableNodes.size() - 1);
+    std::vector<uint32_t> visitedQuery(nodes.size(), 0);
+    std::vector<std::pair<uint32_t, uint32_t>> queries;
+    std::vector<uint32_t> frontier, candidates;
+    for (uint32_t attempt = 1; queries.size() < count && attempt < count * 100; ++attempt) {
+        //walk movable nodes around start, only inside the maximum distance
+        const AIMovementNode *start = nodes[movableNodes[movableNode(generator)]];
+        frontier.assign(1, start->getID());
+        visitedQuery[start->getID()] = attempt;
+        candidates.clear();
+        for (size_t i = 0; i < frontier.size(); ++i) {
+            const AIMovementNode *current = nodes[frontier[i]];
+            if (getCellDistance(start, current) >= minimumDistance) {
+                candidates.push_back(current->getID());
+            }
+            for (int j = 0; j < 9; ++j) {
+                const AIMovementNode *neighbour = current->getNeighbour(j);
+                if (neighbour == nullptr || !neighbour->isIsMovable() || visitedQuery[neighbour->getID()] == attempt ||
+                    getCellDistance(start, neighbour) > maximumDistance) {
+                    continue;
+                }
+                visitedQuery[neighbour->getID()] = attempt;
+                frontier.push_back(neighbour->getID());
+            }
+        }
+        if (candidates.empty()) {
+            continue;
+        }
+        std::uniform_int_distribution<size_t> candidate(0, candidates.size() - 1);
+        queries.push_back(std::make_pair(start->getID(), candidates[candidate(generator)]));
+    }
+    return queries;
+}
+
+static void createGrid(std::vector<AIMovementNode *> &nodes, std::shared_ptr<const AINavigationSnapshot> &snapshot) {
+    AINavigationSnapshot::NodeArrays nodeArrays;
+    nodeArrays.resize(1 + GRID_SIZE * GRID_SIZE);
+    nodes.assign(1 + GRID_SIZE * GRID_SIZE, nullptr);
+    for (int x = 0; x < GRID_SIZE; ++x) {
+        for (int z = 0; z < GRID_SIZE; ++z) {
+            uint32_t node = getNodeIndex(x, z);
+            nodeArrays.positions[node] = glm::vec3(x, 2, z);
+            nodeArrays.setMovable(node, !isBlocked(x, z));
+            nodes[node] = new AIMovementNode(node, glm::vec3(x, 2, z));
+            nodes[node]->setIsMovable(!isBlocked(x, z));
+        }
+    }
+    for (int x = 0; x < GRID_SIZE; ++x) {
+        for (int z = 0; z < GRID_SIZE; ++z) {
+            //AIMovementNode neighbour index is (x offset + 1) * 3 + (z offset + 1), 4 is the node itself
+            for (int i = 0; i < 9; ++i) {
+                int neighbourX = x + i / 3 - 1;
+                int neighbourZ = z + i % 3 - 1;
+                if (i == 4 || neighbourX < 0 || neighbourZ < 0 || neighbourX >= GRID_SIZE || neighbourZ >= GRID_SIZE) {
+                    continue;
+                }
+                uint32_t neighbour = getNodeIndex(neighbourX, neighbourZ);
+                nodeArrays.neighbours[getNodeIndex(x, z) * AINavigationSnapshot::NEIGHBOUR_COUNT +
+                                      AINavigationSnapshot::getNeighbourSlot(i)] = neighbour;
+                nodes[getNodeIndex(x, z)]->setNeighbour(i, nodes[neighbour]);
+            }
+        }
+    }
+    snapshot = std::make_shared<const AINavigationSnapshot>(std::move(nodeArrays), getNodeIndex(7, 7));
+}
+
+/**
+ * Snapshot is loaded the way World loads it. AIMovementNodes are built from the same file, it starts with magic,
+ * version, node count and root node, then positions, movable bits and neighbours of each node.
+ */
+static bool loadGrid(const std::string &fileName, std::vector<AIMovementNode *> &nodes,
+                     std::shared_ptr<const AINavigationSnapshot> &snapshot) {
+    snapshot = AINavigationSnapshot::deserialize(fileName);
+    if (snapshot == nullptr) {
+        std::cerr << "AI walk grid can't be loaded from " << fileName << std::endl;
+        return false;
+    }
+    std::ifstream inputFile(fileName, std::ios::in | std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+    uint32_t nodeCount;
+    memcpy(&nodeCount, bytes.data() + 8, sizeof(uint32_t));
+    const char *positionData = bytes.data() + 16;
+    const char *movableData = positionData + (size_t)nodeCount * 3 * sizeof(float);
+    const char *neighbourData = movableData + ((nodeCount + 31) / 32) * sizeof(uint32_t);
+
+    nodes.assign(nodeCount, nullptr);
+    for (uint32_t node = 1; node < nodeCount; ++node) {
+        float position[3];
+        memcpy(position, positionData + (size_t)node * 3 * sizeof(float), sizeof(position));
+        uint32_t movableWord;
+        memcpy(&movableWord, movableData + (node / 32) * sizeof(uint32_t), sizeof(uint32_t));
+        nodes[node] = new AIMovementNode(node, glm::vec3(position[0], position[1], position[2]));
+        nodes[node]->setIsMovable(((movableWord >> (node % 32)) & 1u) != 0);
+    }
+    for (uint32_t node = 1; node < nodeCount; ++node) {
+        for (int i = 0; i < 9; ++i) {
+            if (i == 4) {
+                continue;
+            }
+            uint32_t neighbour;
+            memcpy(&neighbour, neighbourData + ((size_t)node * AINavigationSnapshot::NEIGHBOUR_COUNT +
+                                                AINavigationSnapshot::getNeighbourSlot(i)) * sizeof(uint32_t),
+                   sizeof(uint32_t));
+            if (neighbour != AINavigationSnapshot::NO_NODE) {
+                nodes[node]->setNeighbour(i, nodes[neighbour]);
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<AIMovementNode *> nodes;
+    std::shared_ptr<const AINavigationSnapshot> snapshot;
+    std::string gridName;
+    if (argc > 1) {
+        if (!loadGrid(argv[1], nodes, snapshot)) {
+            return 1;
+        }
+        gridName = argv[1];
+    } else {
+        createGrid(nodes, snapshot);
+        gridName = std::to_string(GRID_SIZE) + "x" + std::to_string(GRID_SIZE) + " grid with walls";
+    }
+    std::cout << gridName << ", " << snapshot->getNodeCount() << " nodes" << std::endl;
+
+    std::mt19937 generator(9);
+    bool passed;
+    std::vector<std::pair<uint32_t, uint32_t>> queries = createQueries(200, 4, NAVIGATION_FLAT_SEARCH_DEPTH, nodes, generator);
+    if (queries.empty()) {
+        std::cerr << "Grid has no connected nodes 4 to " << NAVIGATION_FLAT_SEARCH_DEPTH << " cells apart." << std::endl;
+        passed = false;
+    } else {
+        std::cout << queries.size() << " routes up to " << NAVIGATION_FLAT_SEARCH_DEPTH << " cells" << std::endl;
+        passed = benchmarkRoutes(queries, nodes, *snapshot);
+    }
+
+    //route length against query time, as the distance grows past the flat search depth
+    int distances[] = {64, 128, 256};
+    int previousDistance = NAVIGATION_FLAT_SEARCH_DEPTH;
+    for (int distance : distances) {
+        if (!passed) {
+            break;
+        }
+        queries = createQueries(20, previousDistance + 1, distance, nodes, generator);
+        if (queries.empty()) {
+            std::cout << std::endl << "Grid has no connected nodes " << previousDistance + 1 << " to " << distance
+                      << " cells apart" << std::endl;
+            break;
+        }
+        std::cout << std::endl << queries.size() << " routes of " << previousDistance + 1 << " to " << distance
+                  << " cells" << std::endl;
+        passed = benchmarkRoutes(queries, nodes, *snapshot);
+        previousDistance = distance;
+    }
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        delete nodes[i];
+    }
+    return passed ? 0 : 1;
+}
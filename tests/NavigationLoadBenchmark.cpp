@@ -0,0 +1,65 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <chrono>
+#include "AI/AIMovementGrid.h"
+#include "AI/AINavigationSnapshot.h"
+#include "Utils/MappedFile.h"
+
+/**
+ * Loads the same AI walk grid from xml and from binary, the two ways World::createGridFrom can load it, and reports
+ * both times. Xml load includes building the snapshot from the parsed grid, since World uses the snapshot.
+ *
+ * Usage: NavigationLoadBenchmark [grid.aiwalk]. Binary is expected next to it, with .aiwalkbin extension, and is
+ * written from the xml if it is missing or older. Default is the grid AIGridBenchmark saves.
+ */
+
+static const int LOAD_COUNT = 5;
+
+int main(int argc, char *argv[]) {
+    std::string xmlFileName = argc > 1 ? argv[1] : "AIGridBenchmark.aiwalk";
+    std::string binaryFileName = xmlFileName.substr(0, xmlFileName.find_last_of(".")) + ".aiwalkbin";
+
+    double xmlTime = 0, binaryTime = 0;
+    size_t xmlNodeCount = 0, binaryNodeCount = 0;
+    for (int i = 0; i < LOAD_COUNT; ++i) {
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        AIMovementGrid *grid = AIMovementGrid::deserialize(xmlFileName);
+        if (grid == nullptr) {
+            std::cerr << "AI walk grid can't be loaded from " << xmlFileName << ", run AIGridBenchmark first or pass a grid file." << std::endl;
+            return 1;
+        }
+        std::shared_ptr<const AINavigationSnapshot> snapshot = grid->createNavigationSnapshot();
+        delete grid;
+        xmlTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        xmlNodeCount = snapshot->getNodeCount();
+        if (i == 0 && MappedFile::isOutdated(binaryFileName, xmlFileName) && !snapshot->serialize(binaryFileName)) {
+            std::cerr << "Binary AI walk grid can't be written to " << binaryFileName << std::endl;
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < LOAD_COUNT; ++i) {
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        std::shared_ptr<const AINavigationSnapshot> snapshot = AINavigationSnapshot::deserialize(binaryFileName);
+        if (snapshot == nullptr) {
+            std::cerr << "Binary AI walk grid can't be loaded from " << binaryFileName << std::endl;
+            return 1;
+        }
+        binaryTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        binaryNodeCount = snapshot->getNodeCount();
+    }
+
+    std::cout << xmlFileName << ", " << xmlNodeCount << " nodes, average of " << LOAD_COUNT << " loads" << std::endl;
+    std::cout << "Xml:    " << xmlTime / LOAD_COUNT << " ms" << std::endl;
+    std::cout << "Binary: " << binaryTime / LOAD_COUNT << " ms" << std::endl;
+    if (xmlNodeCount != binaryNodeCount) {
+        std::cerr << "Xml has " << xmlNodeCount << " nodes, binary has " << binaryNodeCount << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <map>
+#include <set>
+#include <cstdlib>
+#include <new>
+#include "Options.h"
+#include "SDL2Helper.h"
+#include "GLHelper.h"
+#include "InstancedRenderList.h"
+#include "Assets/AssetManager.h"
+#include "GameObjects/Model.h"
+
+/**
+ * Counts heap allocations per frame of the render lists World keeps for one camera and one light, with 800 static
+ * models of 4 assets. Every frame 2% of the models change visibility, then the 4 render passes read the lists:
+ * directional and point shadow from the light list, depth pre-pass and coloring from the camera list.
+ *
+ * The std::map<uint32_t, std::set<Model*>> layout World used before is compared with InstancedRenderList. Old passes
+ * copied the set of each asset, and filled a reserved index buffer from it. After warm up InstancedRenderList should
+ * not allocate, the benchmark fails if it does, or if the two layouts render different number of models.
+ *
+ * Models need a GL context, so a window is created. Run from a directory that has Engine and Data, like the engine.
+ */
+
+//only main thread is counted, driver threads can allocate any time
+static thread_local bool isCountingAllocations = false;
+static uint64_t allocationCount = 0;
+
+void *operator new(size_t size) {
+    if (isCountingAllocations) {
+        allocationCount++;
+    }
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t size __attribute((unused))) noexcept {
+    std::free(memory);
+}
+
+typedef std::map<uint32_t, std::set<Model *>> ModelSetMap;
+
+static uint64_t renderPassesWithSets(const ModelSetMap &lightModels, const ModelSetMap &cameraModels,
+                                     std::vector<uint32_t> &modelIndicesBuffer) {
+    uint64_t renderedCount = 0;
+    const ModelSetMap *passLists[4] = {&lightModels, &lightModels, &cameraModels, &cameraModels};
+    for (int pass = 0; pass < 4; ++pass) {
+        for (auto modelIterator = passLists[pass]->begin(); modelIterator != passLists[pass]->end(); ++modelIterator) {
+            std::set<Model *> modelSet = modelIterator->second;
+            modelIndicesBuffer.clear();
+            for (auto model = modelSet.begin(); model != modelSet.end(); ++model) {
+                modelIndicesBuffer.push_back((*model)->getWorldObjectID());
+            }
+            renderedCount += modelIndicesBuffer.size();
+        }
+    }
+    return renderedCount;
+}
+
+static uint64_t renderPassesWithLists(const InstancedRenderList &lightModels, const InstancedRenderList &cameraModels) {
+    uint64_t renderedCount = 0;
+    const InstancedRenderList *passLists[4] = {&lightModels, &lightModels, &cameraModels, &cameraModels};
+    for (int pass = 0; pass < 4; ++pass) {
+        for (auto batchIterator = passLists[pass]->getBatches().begin(); batchIterator != passLists[pass]->getBatches().end(); ++batchIterator) {
+            renderedCount += batchIterator->second.modelIndices.size();
+        }
+    }
+    return renderedCount;
+}
+
+int main() {
+    const uint32_t modelCountPerAsset = 200;
+    const uint32_t frameCount = 600;
+    const uint32_t warmUpFrameCount = 60;
+    const std::vector<std::string> modelFiles = {"./Data/Models/Box/Box.obj", "./Data/Models/BulletHole/BulletHole.obj",
+                                                 "./Data/Models/Muzzle/Muzzle.obj", "./Data/Models/PirateCoin/Coin.obj"};
+
+    Options options;
+    if (!options.loadOptions("./Engine/Options.xml")) {
+        std::cerr << "Options can't be loaded, render list benchmark should run where Engine directory is." << std::endl;
+        return 1;
+    }
+    SDL2Helper sdlHelper("Limon Render List Benchmark", &options);
+    GLHelper glHelper(&options);
+    AssetManager assetManager(&glHelper, nullptr);
+
+    std::vector<Model *> models;
+    for (size_t asset = 0; asset < modelFiles.size(); ++asset) {
+        for (uint32_t i = 0; i < modelCountPerAsset; ++i) {
+            models.push_back(new Model((uint32_t) models.size() + 1, &assetManager, modelFiles[asset]));
+        }
+    }
+
+    //both layouts start with everything visible, like a world that was just loaded
+    ModelSetMap lightModelSets, cameraModelSets;
+    InstancedRenderList lightModelList, cameraModelList;
+    std::vector<bool> isInLight(models.size(), true), isInCamera(models.size(), true);
+    for (size_t i = 0; i < models.size(); ++i) {
+        lightModelSets[models[i]->getAssetID()].insert(models[i]);
+        cameraModelSets[models[i]->getAssetID()].insert(models[i]);
+        lightModelList.insert(models[i]);
+        cameraModelList.insert(models[i]);
+    }
+    std::vector<uint32_t> modelIndicesBuffer;
+    modelIndicesBuffer.reserve(models.size());
+
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<size_t> modelIndex(0, models.size() - 1);
+    uint64_t setAllocationCount = 0, listAllocationCount = 0;
+    uint64_t setRenderedCount = 0, listRenderedCount = 0;
+    for (uint32_t frame = 0; frame < frameCount; ++frame) {
+        bool isCounted = frame >= warmUpFrameCount;
+        //97 and model count are co-prime, so a model changes at most once per frame
+        std::vector<size_t> changedModels;
+        size_t firstChangedModel = modelIndex(generator);
+        for (size_t i = 0; i < models.size() / 50; ++i) {
+            changedModels.push_back((firstChangedModel + i * 97) % models.size());
+        }
+
+        allocationCount = 0;
+        isCountingAllocations = isCounted;
+        for (size_t i = 0; i < changedModels.size(); ++i) {
+            Model *model = models[changedModels[i]];
+            std::vector<bool>::reference isVisible = (i % 2 == 0) ? isInLight[changedModels[i]] : isInCamera[changedModels[i]];
+            ModelSetMap &modelSets = (i % 2 == 0) ? lightModelSets : cameraModelSets;
+            if (isVisible) {
+                modelSets[model->getAssetID()].erase(model);
+            } else {
+                modelSets[model->getAssetID()].insert(model);
+            }
+        }
+        setRenderedCount += renderPassesWithSets(lightModelSets, cameraModelSets, modelIndicesBuffer);
+        isCountingAllocations = false;
+        setAllocationCount += allocationCount;
+
+        allocationCount = 0;
+        isCountingAllocations = isCounted;
+        for (size_t i = 0; i < changedModels.size(); ++i) {
+            Model *model = models[changedModels[i]];
+            std::vector<bool>::reference isVisible = (i % 2 == 0) ? isInLight[changedModels[i]] : isInCamera[changedModels[i]];
+            InstancedRenderList &modelList = (i % 2 == 0) ? lightModelList : cameraModelList;
+            if (isVisible) {
+                modelList.erase(model);
+            } else {
+                modelList.insert(model);
+            }
+            isVisible = !isVisible;
+        }
+        listRenderedCount += renderPassesWithLists(lightModelList, cameraModelList);
+        isCountingAllocations = false;
+        listAllocationCount += allocationCount;
+    }
+
+    uint32_t countedFrameCount = frameCount - warmUpFrameCount;
+    std::cout << models.size() << " models of " << modelFiles.size() << " assets, " << models.size() / 50
+              << " visibility changes per frame, " << countedFrameCount << " frames counted" << std::endl;
+    std::cout << "std::map of std::set:  " << (double) setAllocationCount / countedFrameCount << " allocations per frame"
+              << std::endl;
+    std::cout << "InstancedRenderList:   " << (double) listAllocationCount / countedFrameCount << " allocations per frame"
+              << std::endl;
+
+    for (size_t i = 0; i < models.size(); ++i) {
+        delete models[i];
+    }
+    if (setRenderedCount != listRenderedCount) {
+        std::cerr << "Sets rendered " << setRenderedCount << " models, lists rendered " << listRenderedCount << std::endl;
+        return 1;
+    }
+    if (listAllocationCount != 0) {
+        std::cerr << "InstancedRenderList allocated after warm up." << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "Options.h"
+#include "SDL2Helper.h"
+#include "GLHelper.h"
+#include "Assets/AssetManager.h"
+#include "Assets/ModelAsset.h"
+
+/**
+ * Evaluates the skeleton of 500 characters playing the same animation at different times, for 600 frames, and reports
+ * bones evaluated per second. Pose cache is disabled, so every character is evaluated.
+ *
+ * Model assets need a GL context, so a window is created. Run from a directory that has Engine and Data, like the
+ * engine itself. Model file can be passed as the first argument, default is the Swat model.
+ */
+int main(int argc, char *argv[]) {
+    const uint32_t characterCount = 500;
+    const uint32_t frameCount = 600;
+    const long frameTime = 1000 / 60;
+    std::string modelFile = "./Data/Models/Swat/Swat.fbx";
+    if (argc > 1) {
+        modelFile = argv[1];
+    }
+
+    Options options;
+    if (!options.loadOptions("./Engine/Options.xml")) {
+        std::cerr << "Options can't be loaded, skeleton benchmark should run where Engine directory is." << std::endl;
+        return 1;
+    }
+    options.setAnimationPoseCacheQuantization(0);
+    SDL2Helper sdlHelper("Limon Skeleton Benchmark", &options);
+    GLHelper glHelper(&options);
+    //sounds are not loaded, so no audio device is opened
+    AssetManager assetManager(&glHelper, nullptr);
+
+    ModelAsset *modelAsset = assetManager.loadAsset<ModelAsset>({modelFile});
+    if (!modelAsset->isAnimated() || modelAsset->getAnimations().empty()) {
+        std::cerr << modelFile << " has no animations, skeleton benchmark needs an animated model." << std::endl;
+        return 1;
+    }
+    const std::string &animationName = modelAsset->getAnimations().begin()->first;
+
+    std::vector<std::vector<glm::mat4>> transforms(characterCount);
+    std::vector<std::vector<AnimationNode::Cursor>> cursors(characterCount);
+    uint64_t evaluatedBoneCount = 0;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < frameCount; ++frame) {
+        for (uint32_t character = 0; character < characterCount; ++character) {
+            //each character is offset, so they don't sample the same keys
+            long time = frame * frameTime + character * 37;
+            modelAsset->getTransform(time, true, animationName, transforms[character], &cursors[character]);
+            evaluatedBoneCount += transforms[character].size();
+        }
+    }
+    std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+
+    std::cout << characterCount << " characters of " << modelFile << ", " << transforms[0].size() << " bones, "
+              << frameCount << " frames" << std::endl;
+    std::cout << elapsedTime.count() * 1000.0 / frameCount << " ms per frame, "
+              << evaluatedBoneCount / elapsedTime.count() << " bones per second" << std::endl;
+    return 0;
+}
@@ -0,0 +1,129 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include "Transformation.h"
+
+/**
+ * 10000 transformations in 2000 chains of depth 5, like weapons on bones on players. Every frame roots move, then world
+ * transform of every transformation is read.
+ *
+ * Transformation caches the parent chain transform of each level, so a query computes only the dirty part of its own
+ * chain. It is compared with the world transform generation Transformation had before the cache, which walked the whole
+ * parent chain and rebuilt each level on every query.
+ *
+ * Both runs read the same values, so their checksums should match.
+ */
+
+static const int CHAIN_COUNT = 2000;
+static const int CHAIN_DEPTH = 5;
+static const int FRAME_COUNT = 100;
+
+/**
+ * World transform generation Transformation had before the cache. Only generation is replaced, dirty flags and update
+ * callbacks are the same.
+ */
+class ParentWalkTransformation : public Transformation {
+    glm::mat4 generateWorldTransformWithParentWalk() {
+        const ParentWalkTransformation *parent = static_cast<const ParentWalkTransformation *>(this->getParentTransform());
+        glm::mat4 rawTotalTransform = this->generateWorldTransformDefault();
+        glm::mat4 totalTransform = this->generateWorldTransformSingle();
+        while (parent != nullptr) {
+            glm::mat4 parentTransformTemp = parent->generateWorldTransformDefault();
+            rawTotalTransform = parentTransformTemp * rawTotalTransform;
+            totalTransform = parentTransformTemp * totalTransform;
+            parent = static_cast<const ParentWalkTransformation *>(parent->getParentTransform());
+        }
+
+        glm::vec3 temp1;//these are not used
+        glm::vec4 temp2;
+
+        glm::decompose(rawTotalTransform, scale, orientation, translate, temp1, temp2);//update the current of these
+        return totalTransform;
+    }
+
+public:
+    void setParentWalkParent(ParentWalkTransformation *parent) {
+        setParentTransform(parent);
+        generateWorldTransform = std::bind(&ParentWalkTransformation::generateWorldTransformWithParentWalk, this);
+        getWorldTransform();
+    }
+};
+
+static void attach(Transformation *transformation, Transformation *parent) {
+    transformation->setParentTransform(parent);
+}
+
+static void attach(ParentWalkTransformation *transformation, ParentWalkTransformation *parent) {
+    transformation->setParentWalkParent(parent);
+}
+
+template<class TransformationType>
+static void createChains(std::vector<Transformation *> &transformations, std::vector<Transformation *> &roots) {
+    for (int chain = 0; chain < CHAIN_COUNT; ++chain) {
+        TransformationType *parent = nullptr;
+        for (int depth = 0; depth < CHAIN_DEPTH; ++depth) {
+            TransformationType *transformation = new TransformationType();
+            transformation->setUpdateCallback([]() {});//like models, children are refreshed through update callbacks
+            transformation->setTranslate(glm::vec3(chain * 0.1f, depth, 1));
+            transformation->setOrientation(glm::quat(1, 0.01f * depth, 0.02f, 0));
+            transformation->setScale(glm::vec3(1.0f + 0.01f * depth));
+            if (parent != nullptr) {
+                attach(transformation, parent);
+            } else {
+                roots.push_back(transformation);
+            }
+            transformations.push_back(transformation);
+            parent = transformation;
+        }
+    }
+}
+
+static double runFrames(const std::vector<Transformation *> &transformations, const std::vector<Transformation *> &roots,
+                        double &checksum) {
+    checksum = 0;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+        for (size_t i = 0; i < roots.size(); ++i) {
+            roots[i]->setTranslate(glm::vec3(i * 0.1f, frame * 0.01f, 1));
+        }
+        for (size_t i = 0; i < transformations.size(); ++i) {
+            const glm::mat4 &worldTransform = transformations[i]->getWorldTransform();
+            checksum += worldTransform[3][0] + worldTransform[3][1] + worldTransform[3][2] + worldTransform[0][0];
+            checksum += transformations[i]->getTranslate().y;
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() / FRAME_COUNT;
+}
+
+int main() {
+    std::vector<Transformation *> parentWalkTransformations, parentWalkRoots;
+    createChains<ParentWalkTransformation>(parentWalkTransformations, parentWalkRoots);
+    double parentWalkChecksum;
+    double parentWalkTime = runFrames(parentWalkTransformations, parentWalkRoots, parentWalkChecksum);
+
+    std::vector<Transformation *> cachedTransformations, cachedRoots;
+    createChains<Transformation>(cachedTransformations, cachedRoots);
+    double cachedChecksum;
+    double cachedTime = runFrames(cachedTransformations, cachedRoots, cachedChecksum);
+
+    std::cout << cachedTransformations.size() << " transformations in " << CHAIN_COUNT << " chains of depth "
+              << CHAIN_DEPTH << std::endl;
+    std::cout << "Parent walk per query: " << parentWalkTime << " ms per frame" << std::endl;
+    std::cout << "Cached parent chain:   " << cachedTime << " ms per frame" << std::endl;
+
+    for (size_t i = 0; i < cachedTransformations.size(); ++i) {
+        delete parentWalkTransformations[i];
+        delete cachedTransformations[i];
+    }
+    //matrices are multiplied in a different order, so last bits can differ
+    if (std::fabs(parentWalkChecksum - cachedChecksum) > 1e-6 * std::fabs(parentWalkChecksum)) {
+        std::cerr << "Checksums are different, " << parentWalkChecksum << " and " << cachedChecksum << std::endl;
+        return 1;
+    }
+    return 0;
+}
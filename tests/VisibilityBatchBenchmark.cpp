@@ -0,0 +1,102 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <chrono>
+#include "VisibilityBatch.h"
+#include "GLHelper.h"
+
+/**
+ * 20000 objects culled against a camera frustum, 3 light frusta and 3 point light ranges, comparing
+ * VisibilityBatch::cullScalar with the SSE cull. Like World, the batch is filled again every frame, 1% of the objects
+ * moving. Only culling is timed, both batches are filled the same way. Masks must be the same, the benchmark fails if
+ * they are not.
+ */
+
+int main() {
+    const uint32_t objectCount = 20000;
+    const uint32_t movingObjectCount = objectCount / 100;
+    const int frameCount = 200;
+
+    std::mt19937 generator(22);
+    std::uniform_real_distribution<float> horizontal(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> vertical(0.0f, 50.0f);
+    std::uniform_real_distribution<float> extent(0.5f, 5.0f);
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+
+    std::vector<glm::vec3> centers, halfExtents;
+    for (uint32_t i = 0; i < objectCount; ++i) {
+        centers.push_back(glm::vec3(horizontal(generator), vertical(generator), horizontal(generator)));
+        halfExtents.push_back(glm::vec3(extent(generator), extent(generator), extent(generator)));
+    }
+
+    //camera and 3 light frusta, looking at different parts of the world, and 3 point lights near the camera
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+    glm::vec3 eyes[4] = {glm::vec3(0, 20, 0), glm::vec3(200, 40, 200), glm::vec3(-300, 30, 100), glm::vec3(0, 80, -400)};
+    glm::vec3 targets[4] = {glm::vec3(0, 0, -100), glm::vec3(300, 0, 300), glm::vec3(-100, 0, 100), glm::vec3(0, 0, -200)};
+    std::vector<std::vector<glm::vec4>> frusta(4, std::vector<glm::vec4>(6));
+    for (int i = 0; i < 4; ++i) {
+        GLHelper::calculateFrustumPlanes(glm::lookAt(eyes[i], targets[i], glm::vec3(0, 1, 0)), projection, frusta[i]);
+    }
+    glm::vec3 lightPositions[3] = {glm::vec3(10, 5, -20), glm::vec3(-40, 5, -60), glm::vec3(30, 10, -120)};
+    float lightRanges[3] = {30.0f, 50.0f, 80.0f};
+
+    VisibilityBatch scalarBatch, sseBatch;
+    VisibilityBatch *batches[2] = {&scalarBatch, &sseBatch};
+    std::chrono::steady_clock::duration scalarTime(0), sseTime(0);
+    size_t visibleCount = 0;
+    for (int frame = 0; frame < frameCount; ++frame) {
+        for (uint32_t i = 0; i < movingObjectCount; ++i) {
+            uint32_t index = (frame * movingObjectCount + i) % objectCount;
+            centers[index] += glm::vec3(step(generator), 0, step(generator));
+        }
+        for (VisibilityBatch *batch : batches) {
+            batch->clear();
+            batch->reserve(objectCount);
+            for (uint32_t i = 0; i < objectCount; ++i) {
+                batch->addObject(centers[i] - halfExtents[i], centers[i] + halfExtents[i], centers[i]);
+            }
+            for (size_t i = 0; i < frusta.size(); ++i) {
+                batch->addFrustum(frusta[i]);
+            }
+            for (int i = 0; i < 3; ++i) {
+                batch->addRange(lightPositions[i], lightRanges[i]);
+            }
+        }
+
+        std::chrono::steady_clock::time_point scalarStart = std::chrono::steady_clock::now();
+        scalarBatch.cullScalar();
+        std::chrono::steady_clock::time_point sseStart = std::chrono::steady_clock::now();
+        sseBatch.cull();
+        std::chrono::steady_clock::time_point sseEnd = std::chrono::steady_clock::now();
+        scalarTime += sseStart - scalarStart;
+        sseTime += sseEnd - sseStart;
+
+        for (uint32_t i = 0; i < objectCount; ++i) {
+            if (scalarBatch.getMask(i) != sseBatch.getMask(i)) {
+                std::cerr << "Masks of object " << i << " are different, scalar " << scalarBatch.getMask(i)
+                          << " and SSE " << sseBatch.getMask(i) << std::endl;
+                return 1;
+            }
+            for (uint32_t volume = 0; volume < sseBatch.getVolumeCount(); ++volume) {
+                if (sseBatch.isVisible(i, volume)) {
+                    visibleCount++;
+                }
+            }
+        }
+    }
+
+    double scalarMilliseconds = std::chrono::duration<double, std::milli>(scalarTime).count() / frameCount;
+    double sseMilliseconds = std::chrono::duration<double, std::milli>(sseTime).count() / frameCount;
+    size_t volumeCount = scalarBatch.getVolumeCount();
+    std::cout << objectCount << " objects, " << volumeCount << " volumes, " << movingObjectCount
+              << " objects moving per frame, " << visibleCount / frameCount << " visible per frame" << std::endl;
+    std::cout << "cullScalar: " << scalarMilliseconds << " ms per frame, "
+              << objectCount * volumeCount / scalarMilliseconds / 1000.0 << " million tests per second" << std::endl;
+    std::cout << "cull:       " << sseMilliseconds << " ms per frame, "
+              << objectCount * volumeCount / sseMilliseconds / 1000.0 << " million tests per second" << std::endl;
+    return 0;
+}
@@ -0,0 +1,121 @@
+//
+// Created by engin on 16.10.2026.
+//
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include "VisibilityBatch.h"
+#include "GLHelper.h"
+
+/**
+ * Checks VisibilityBatch::cull and cullScalar give the same masks as testing each object with GLHelper::isInFrustum
+ * and the point light range check. Object counts that are not multiples of 4 are used to cover the padding.
+ */
+
+static std::vector<glm::vec4> createRandomFrustum(std::mt19937 &generator) {
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> offset(20.0f, 80.0f);
+    std::vector<glm::vec4> planes;
+    for (int i = 0; i < 6; ++i) {
+        glm::vec3 normal(direction(generator), direction(generator), direction(generator));
+        normal = glm::normalize(normal + glm::vec3(0.001f));
+        planes.push_back(glm::vec4(normal, offset(generator)));
+    }
+    return planes;
+}
+
+static std::vector<glm::vec4> createBoxFrustum(float halfSize) {
+    std::vector<glm::vec4> planes;
+    planes.push_back(glm::vec4( 1, 0, 0, halfSize));
+    planes.push_back(glm::vec4(-1, 0, 0, halfSize));
+    planes.push_back(glm::vec4( 0, 1, 0, halfSize));
+    planes.push_back(glm::vec4( 0,-1, 0, halfSize));
+    planes.push_back(glm::vec4( 0, 0, 1, halfSize));
+    planes.push_back(glm::vec4( 0, 0,-1, halfSize));
+    return planes;
+}
+
+static bool runCase(size_t objectCount, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> extent(0.1f, 5.0f);
+
+    std::vector<glm::vec3> aabbMins, aabbMaxs, positions;
+    for (size_t i = 0; i < objectCount; ++i) {
+        glm::vec3 center(coordinate(generator), coordinate(generator), coordinate(generator));
+        if (i % 7 == 0) {
+            //put some objects exactly on the box frustum planes
+            center.x = 25.0f;
+        }
+        glm::vec3 halfExtent(extent(generator), extent(generator), extent(generator));
+        aabbMins.push_back(center - halfExtent);
+        aabbMaxs.push_back(center + halfExtent);
+        positions.push_back(center);
+    }
+
+    std::vector<std::vector<glm::vec4>> frusta;
+    for (int i = 0; i < 4; ++i) {
+        frusta.push_back(createRandomFrustum(generator));
+    }
+    frusta.push_back(createBoxFrustum(25.0f));
+    glm::vec3 rangeCenter(10.0f, 5.0f, -3.0f);
+    float rangeDistance = 30.0f;
+
+    VisibilityBatch batch, scalarBatch;
+    VisibilityBatch *batches[2] = {&batch, &scalarBatch};
+    for (VisibilityBatch *currentBatch : batches) {
+        currentBatch->reserve(objectCount);
+        for (size_t i = 0; i < objectCount; ++i) {
+            currentBatch->addObject(aabbMins[i], aabbMaxs[i], positions[i]);
+        }
+        for (size_t i = 0; i < frusta.size(); ++i) {
+            currentBatch->addFrustum(frusta[i]);
+        }
+        currentBatch->addRange(rangeCenter, rangeDistance);
+    }
+    batch.cull();
+    scalarBatch.cullScalar();
+
+    size_t mismatchCount = 0;
+    for (size_t i = 0; i < objectCount; ++i) {
+        uint32_t expectedMask = 0;
+        for (size_t j = 0; j < frusta.size(); ++j) {
+            if (GLHelper::isInFrustum(aabbMins[i], aabbMaxs[i], frusta[j])) {
+                expectedMask |= 1u << j;
+            }
+        }
+        glm::vec3 difference = rangeCenter - positions[i];
+        if (difference.x * difference.x + difference.y * difference.y + difference.z * difference.z <
+            rangeDistance * rangeDistance) {
+            expectedMask |= 1u << frusta.size();
+        }
+        if (batch.getMask(i) != expectedMask || scalarBatch.getMask(i) != expectedMask) {
+            if (mismatchCount == 0) {
+                std::cerr << "Object " << i << " of " << objectCount << " expected mask " << expectedMask
+                          << ", cull gave " << batch.getMask(i) << ", cullScalar gave " << scalarBatch.getMask(i)
+                          << std::endl;
+            }
+            mismatchCount++;
+        }
+    }
+    if (mismatchCount != 0) {
+        std::cerr << mismatchCount << " of " << objectCount << " objects have wrong visibility masks." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    bool passed = true;
+    size_t objectCounts[] = {0, 1, 3, 4, 5, 1023, 20001};
+    for (size_t i = 0; i < sizeof(objectCounts) / sizeof(objectCounts[0]); ++i) {
+        passed &= runCase(objectCounts[i], (uint32_t)i + 1);
+    }
+    if (!passed) {
+        return 1;
+    }
+    std::cout << "VisibilityBatch masks match GLHelper::isInFrustum." << std::endl;
+    return 0;
+}